@@ -11,4 +11,11 @@
 /* 电脑落子（AI 下棋）；内部会调用以下函数： */
 void ai_move(GameState *game, int difficulty);
 
+/* 最近一次 ai_move 看过多少个局面（估值一个空位、试下一步各算一个；性能面板算“节点/秒”用） */
+long ai_last_nodes(void);
+
+/* 给每个空位打分（和中级难度选点用的是同一个估值，按当前落子方算），有子的点和已结束的棋局都是 0。
+ * 热力图用；不算进 ai_last_nodes */
+void ai_score_board(const GameState *game, int scores[BOARD_SIZE][BOARD_SIZE]);
+
 #endif /* AI_H */
\ No newline at end of file
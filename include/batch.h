@@ -0,0 +1,54 @@
+/*
+ * batch.h
+ * 批量提交绘制：把同一层要画的东西先攒起来，最后一次调用交给渲染器。
+ *   - QuadBatch：一批四边形（贴同一张纹理，或者不贴图、每个四边形自带颜色），
+ *                攒满或 flush 时用一次 SDL_RenderGeometry 画完；
+ *   - RectBatch：一批同色的实心矩形（七段数码管的段），flush 时一次 SDL_RenderFillRects。
+ * 以前满盘棋子是几百次 RenderCopy，计时器一个数字就是七次 FillRect、七次设颜色，
+ * 每次调用都有一份驱动开销。
+ *
+ * 批次放在调用者的栈上，只在绘制线程里用。
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <SDL2/SDL.h>
+
+/* 一批最多攒多少个四边形：够一种颜色的棋子下满半个棋盘，超了自动先画掉一批 */
+#define BATCH_QUADS 256
+
+/* 一批最多攒多少个矩形 */
+#define BATCH_RECTS 128
+
+typedef struct {
+    SDL_Texture *tex;                    // NULL = 纯色四边形
+    SDL_Vertex   v[BATCH_QUADS * 4];
+    int          quads;
+} QuadBatch;
+
+typedef struct {
+    SDL_Color color;
+    SDL_Rect  rects[BATCH_RECTS];
+    int       count;
+} RectBatch;
+
+/* 开始一批贴 tex 的四边形（tex 为 NULL 就是纯色） */
+void quad_batch_begin(QuadBatch *b, SDL_Texture *tex);
+
+/* 加一个四边形：整张纹理贴到 dst 上，color 是顶点颜色（贴图时一般给白色，不改颜色） */
+void quad_batch_add(SDL_Renderer *ren, QuadBatch *b, const SDL_Rect *dst, SDL_Color color);
+
+/* 把攒下的四边形画掉。用的是 SDL 当前的混合模式（纯色时）或纹理的混合模式 */
+void quad_batch_flush(SDL_Renderer *ren, QuadBatch *b);
+
+/* 开始一批颜色为 color 的矩形 */
+void rect_batch_begin(RectBatch *b, SDL_Color color);
+
+/* 加一个矩形（宽或高 <= 0 的直接忽略） */
+void rect_batch_add(SDL_Renderer *ren, RectBatch *b, const SDL_Rect *r);
+
+/* 把攒下的矩形画掉 */
+void rect_batch_flush(SDL_Renderer *ren, RectBatch *b);
+
+#endif /* BATCH_H */
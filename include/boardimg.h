@@ -0,0 +1,35 @@
+/*
+ * boardimg.h
+ * 离屏画棋盘：把一个局面画成图片（BMP / PNG），不开窗口、不要显卡。
+ *
+ * 用 SDL 的软件渲染器直接画在一张内存里的 SDL_Surface 上（SDL_CreateSoftwareRenderer），
+ * 不初始化视频子系统，所以在没有显示器、没有 GPU 的 Linux 服务器上也能跑。
+ * 画法和界面里一样：木色底、网格线、带抗锯齿和高光的棋子（sprite_rasterize）、最后一手的红点。
+ *
+ * 每次调用自己建一个渲染器、用完就销毁，不碰任何全局状态，
+ * 多个线程可以同时画（recordtool render 就是每个线程一个渲染器并行导出）。
+ *
+ * PNG 编码是自带的（按行选过滤器 + 固定 Huffman 的 deflate），不依赖 SDL_image 或 zlib。
+ */
+
+#ifndef BOARDIMG_H
+#define BOARDIMG_H
+
+#include <SDL2/SDL.h>
+#include "game.h"
+
+/* 图片边长的上下限（像素） */
+#define BOARDIMG_MIN_SIZE 64
+#define BOARDIMG_MAX_SIZE 4096
+
+/* 把 game 当前的局面画成 size×size 的图（ARGB8888）。
+ * 返回新建的 surface，用完调用者 SDL_FreeSurface；失败返回 NULL */
+SDL_Surface *boardimg_render(const GameState *game, int size);
+
+/* 存成 PNG（RGB，不带透明通道）。成功返回 1，失败返回 0（不会留下半个文件） */
+int boardimg_save_png(SDL_Surface *img, const char *path);
+
+/* 按扩展名存：.bmp 用 SDL_SaveBMP，其余都存 PNG。成功返回 1，失败返回 0 */
+int boardimg_save(SDL_Surface *img, const char *path);
+
+#endif /* BOARDIMG_H */
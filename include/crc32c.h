@@ -0,0 +1,19 @@
+/*
+ * crc32c.h
+ * CRC32C（Castagnoli 多项式）校验，用于给每条对局记录加校验码。
+ * CPU 支持 SSE4.2 时用硬件 crc32 指令，否则用查表（一次处理 8 字节）。
+ */
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 在 crc 的基础上继续累加 data[0..n)。第一次调用传 0；分多次调用和一次算完结果相同。 */
+uint32_t crc32c(uint32_t crc, const void *data, size_t n);
+
+/* 当前是否在用硬件指令（打印速度时顺便显示） */
+int crc32c_hw_available(void);
+
+#endif /* CRC32C_H */
@@ -0,0 +1,49 @@
+/*
+ * dedup.h
+ * 对局去重：按“规范化的落子序列”算 64 位哈希，存档里同一盘棋只存一行，
+ * 重复保存只给它的引用计数 +1。
+ *
+ * 哈希集合持久化在 liu/data/hashes.bin，是一个只追加的日志，每项 12 字节：
+ *     uint64 哈希 | int32 引用计数的增量（都是小端）
+ * 新存一盘 +1，重复保存再 +1，删除记录时减掉它全部的引用。
+ * 内存里是一张开放寻址哈希表；每次操作前只把日志里新增的部分读进来
+ * （别的进程可能也在写），不用重读整个文件。
+ *
+ * 这些函数只在 store.c 的锁里调用（多进程、多线程的互斥都由 store 负责）。
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 把日志里新增的项读进内存表。日志文件不存在时返回 0（调用者可以据此重建） */
+int dedup_sync(void);
+
+/* 某个哈希当前的引用计数（0 = 存档里没有这盘棋） */
+int dedup_refs(uint64_t h);
+
+/* 给某个哈希的引用计数加 delta（写日志 + 更新内存表）。成功返回 1 */
+int dedup_add(uint64_t h, int delta);
+
+/* 清空：删掉日志、清空内存表；create 为 1 时留下一个空日志（表示“已经是最新的”） */
+void dedup_reset(int create);
+
+/* 去重表里的一项（dedup_export 拷出来的） */
+typedef struct {
+    uint64_t hash;
+    int      refs;
+} DedupRef;
+
+/* 把内存表里引用计数大于 0 的项拷一份，按哈希升序；*out 是 malloc 的数组（调用者 free）。
+ * 返回项数，失败返回 -1。拷出来以后就不用锁了，可以慢慢查（dedup_find） */
+int dedup_export(DedupRef **out);
+
+/* 在 dedup_export 拷出来的数组里二分查找，找不到返回 NULL */
+DedupRef *dedup_find(DedupRef *refs, int n, uint64_t h);
+
+/* 从一行记录末尾的 "h" 字段取出哈希；没有这个字段（老记录）返回 0 */
+uint64_t dedup_line_hash(const char *line, size_t len);
+
+#endif /* DEDUP_H */
@@ -1,17 +1,21 @@
 /*
  * fileio.h
- * 对局记录：保存/读取（每局一行 JSON，文件在 liu/data/records.json）。
+ * 对局记录：保存/读取（每局一行 JSON，按段存放在 liu/data/seg_*.json，见 store.h）。
  */
 
 #ifndef FILEIO_H
 #define FILEIO_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "game.h"
 
-/* 保存棋局到记录文件；内部使用以下文件操作函数： */
-int save_record(const GameState *game);
+/* 保存棋局到记录文件；同一盘棋（落子序列完全相同）已经存过时只把它的引用计数 +1，不再新增一行。
+ * mode 是对局模式（1 双人，2/3/4 人机简单/中级/困难），elapsed_seconds 是本局用时，
+ * 都写进记录，同时累加到统计文件（见 stats.h） */
+int save_record(const GameState *game, int mode, int elapsed_seconds);
 
-/* 读取指定索引的记录（加载历史对局）；内部使用以下文件操作函数： */
+/* 读取指定索引的记录（加载历史对局）；记录损坏时返回 0（只报告，存档不动，隔离交给 recordtool verify -q） */
 int load_record(int index, GameState *game);
 
 /* 返回记录文件中包含的对局数量；内部使用以下文件操作函数： */
@@ -19,13 +23,42 @@ int record_count(void);
 
 /* 删除一条对局记录（按编号，从 0 开始）。
  * 成功返回 1，失败返回 0。
- * 说明：records.json 是“每行一条 JSON”的格式，这里通过过滤行来实现删除。
+ * 说明：段文件是“每行一条 JSON”的格式，这里只过滤记录所在的那一个段。
  */
 int delete_record(int index);
 
-/* 清空所有对局记录（把 records.json 清空）。成功返回 1，失败返回 0。 */
+/* 清空所有对局记录（删掉全部段文件和 manifest）。成功返回 1，失败返回 0。 */
 int clear_records(void);
 
+/* ======= 记录格式：一行 JSON <-> 对局（导入导出工具也用） ======= */
+
+/* 一条对局记录：时间戳 + 模式/用时 + 对局内容 */
+typedef struct {
+    char time[20];      // "YYYY-mm-dd HH:MM:SS"
+    int  mode;          // 对局模式，0 = 未知（老记录）
+    int  dur;           // 用时（秒），0 = 未知
+    GameState game;     // 棋盘、步骤、胜者、悔棋次数
+} GameRecord;
+
+/* 落子序列的 64 位哈希（只看每一手的落子方和位置），存档去重用 */
+uint64_t record_hash(const GameState *game);
+
+/* 把对局序列化成一行 JSON（带换行），返回 malloc 的缓冲区，长度写到 *out_len */
+char *record_to_json(const GameState *game, const char *timestr, int mode, int dur, size_t *out_len);
+
+/* 解析一行 JSON 记录（会先校验 CRC）。成功返回 1，坏行返回 0 */
+int record_from_json(const char *line, GameRecord *rec);
+
+/* 校验一行记录末尾的 "crc" 字段（CRC32C，覆盖它前面的所有字节） */
+#define RECORD_CORRUPT  0   // 校验失败或格式不对
+#define RECORD_OK       1   // 校验通过
+#define RECORD_NO_CRC   2   // 老记录，没有校验字段（照常读取）
+int record_check(const char *line, size_t len);
+
+/* 把一行坏记录原样追加到 liu/data/quarantine.json（隔离区）；只在把它从存档里删掉的同时调用，
+ * 这样每条坏记录只会进隔离区一次 */
+void quarantine_record(const char *line);
+
 /* ======= 断点续玩：中途退出时存一份“当前这盘”的状态 ======= */
 int has_resume_game(void);
 int clear_resume_game(void);
@@ -8,6 +8,8 @@
 
 #include <SDL2/SDL.h>
 #include "game.h"
+#include "playlist.h"
+#include "perf.h"
 
 /* ========== 窗口尺寸配置 ========== */
 
@@ -23,15 +25,24 @@
 
 /* ========== 函数声明 ========== */
 
-/* 初始化 SDL 窗口和渲染器；内部使用 SDL 库函数： */
+/* 初始化 SDL 窗口和渲染器；整个程序只在 main 里调用一次，所有界面共用这一个窗口 */
 int gui_init(SDL_Window **win, SDL_Renderer **ren);
 
-/* 关闭并释放 SDL 和字体相关资源；内部使用以下函数： */
+/* 关闭窗口和渲染器（字体、图片由 resource.h 管，整个进程只加载一次）。 */
 void gui_quit(SDL_Window *win, SDL_Renderer *ren);
 
 /* 根据当前棋局绘制棋盘和棋子；内部使用 SDL 库函数： */
 void draw_game(SDL_Renderer *ren, const GameState *game);
 
+/* 落子动画（新子淡入、最后一手的红点跳两下，不到一秒）。
+ * 有动画没播完时返回下一帧该画的时刻（SDL_GetTicks 的毫秒），到点重画一次 draw_game；
+ * 没有动画返回 0，这时不用重画。 */
+Uint32 gui_anim_next_frame(void);
+
+/* 不播了：之后（包括紧接着的）这一次 draw_game 直接画成最终画面。
+ * 在棋盘上盖结果界面之前用，免得新子还是半透明的 */
+void gui_anim_finish(void);
+
 /* 将屏幕坐标（像素）转换为棋盘行列坐标；无（只使用了基本的数学运算） */
 int pixel_to_cell(int x, int y, int *row, int *col);
 
@@ -47,8 +58,10 @@ void draw_main_menu(SDL_Renderer *ren, int has_resume);
 /* 人机难度选择菜单（从“人机对战”按钮点进去）。 */
 void draw_ai_difficulty_menu(SDL_Renderer *ren);
 
-/* 回放菜单：列出历史对局（第 N 轮）并提供删除按钮 */
-void draw_playback_menu(SDL_Renderer *ren, int page, int total, int per_page);
+/* 回放菜单：列出历史对局（第 N 轮）并提供删除按钮。
+ * rows 是这一页的摘要（可以为 NULL，表示还没取到，只画编号） */
+void draw_playback_menu(SDL_Renderer *ren, int page, int total, int per_page,
+                        const RecordSummary *rows, int row_count);
 
 /* 回放菜单：没有任何记录时的提示界面 */
 void draw_playback_empty(SDL_Renderer *ren);
@@ -65,4 +78,17 @@ void draw_timer(SDL_Renderer *ren, int elapsed_seconds);
 /* 显示悔棋次数（按一次算一次）。一般放在计时器旁边或下面。 */
 void draw_undo_count(SDL_Renderer *ren, int undo_count);
 
+/* F3 性能面板：左上角半透明底 + 七行数字（标签走文字缓存，数字走 HUD 缓存）。
+ * 在 SDL_RenderPresent 之前调用 */
+void draw_perf_overlay(SDL_Renderer *ren, const PerfStats *st);
+
+/* 回放控制条：棋盘下方的进度条 + 左上角的“当前手数-总手数”（暂停时带 P），下面是播放倍速 */
+void draw_playback_bar(SDL_Renderer *ren, int move, int total, int playing, double speed);
+
+/* 点 (x, y) 是否落在进度条上 */
+int playback_bar_hit(int x, int y);
+
+/* 进度条上横坐标 x 对应第几手（拖动时 y 不用管） */
+int playback_bar_move(int x, int total);
+
 #endif /* GUI_H */
\ No newline at end of file
@@ -0,0 +1,37 @@
+/*
+ * heatmap.h
+ * 估值热力图：把电脑对每个空位的打分（ai_score_board）铺成一层半透明的颜色盖在棋盘上，
+ * 越红越值得下，越蓝越没用。对局和回放界面按 H 打开/关闭。
+ *
+ * 整层是一张 BOARD_SIZE×BOARD_SIZE 的流式纹理（SDL_TEXTUREACCESS_STREAMING），
+ * 一个像素对应一个交叉点，线性过滤放大到整个棋盘，一次 RenderCopy 画完；
+ * 不是每个格子画一个矩形（那样一帧就是 361 次绘制调用）。
+ * 打分只在局面变了时重算，重算后只把颜色变了的那一块用 SDL_LockTexture 改掉。
+ *
+ * 纹理属于 renderer，销毁 renderer 之前要调 heatmap_release。只在主线程里用
+ * （heatmap_lost 除外）。
+ */
+
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <SDL2/SDL.h>
+#include "game.h"
+
+/* 打开/关闭热力图 */
+void heatmap_toggle(void);
+
+/* 现在开着没有 */
+int heatmap_enabled(void);
+
+/* 把 game 的热力图画到棋盘上：dst 是整层的像素位置（每个交叉点在对应像素的正中间）。
+ * 没开或者纹理建不出来就什么都不画 */
+void heatmap_draw(SDL_Renderer *ren, const GameState *game, const SDL_Rect *dst);
+
+/* 显卡设备重置、纹理内容丢失了：下一次画的时候整张重传。可以在任何线程里调 */
+void heatmap_lost(void);
+
+/* 销毁纹理（关 renderer 前调用） */
+void heatmap_release(void);
+
+#endif /* HEATMAP_H */
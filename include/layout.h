@@ -0,0 +1,85 @@
+/*
+ * layout.h
+ * 界面布局表：按钮、棋盘、HUD 的位置都从这里算，画的（gui.c）和点的（main.c）用同一份。
+ * 以前按钮坐标在 gui.c 里写一遍、main.c 里判断点击时又抄一遍，抄岔了就会点不中
+ * （结束菜单的两个按钮就是这样）；窗口也固定 640×640。
+ *
+ * 布局按 640×640 的“设计尺寸”写，实际绘制时按渲染输出的像素大小（高 DPI 屏上比窗口大）
+ * 等比放大，设计区域居中，多出来的边只铺背景。字体、棋子、七段数码管都按放大后的像素重新
+ * 光栅化，不是把 640 的画面拉伸，所以 4K 全屏也不糊。
+ *
+ * 只在主线程里用。
+ */
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <SDL2/SDL.h>
+#include "playlist.h"
+
+/* 设计尺寸：所有布局常量都按这个大小写 */
+#define LAYOUT_DESIGN_SIZE 640
+
+/* 有按钮的几个界面 */
+typedef enum {
+    UI_SCREEN_MAIN = 0,      // 主菜单
+    UI_SCREEN_AI,            // 人机难度
+    UI_SCREEN_LIST,          // 回放列表
+    UI_SCREEN_LIST_EMPTY,    // 回放列表（没有记录）
+    UI_SCREEN_END            // 对局结束：再来一局 / 返回主菜单
+} UiScreen;
+
+typedef enum {
+    UI_NONE = 0,
+    UI_MAIN_RESUME, UI_MAIN_PVP, UI_MAIN_AI, UI_MAIN_PLAYBACK, UI_MAIN_QUIT,
+    UI_AI_EASY, UI_AI_MEDIUM, UI_AI_HARD, UI_AI_BACK,
+    UI_LIST_PLAY, UI_LIST_DELETE,            // 这两个带行号
+    UI_LIST_PREV, UI_LIST_NEXT, UI_LIST_BACK,
+    UI_END_AGAIN, UI_END_MENU
+} UiId;
+
+typedef struct {
+    UiId     id;
+    int      row;      // 回放列表里是第几行，其他按钮为 0
+    SDL_Rect rect;     // 像素坐标
+} UiButton;
+
+/* 一个界面最多几个按钮（回放列表：每行两个 + 上一页/下一页/返回） */
+#define LAYOUT_MAX_BUTTONS (PLAYLIST_MAX_ROWS * 2 + 3)
+
+typedef struct {
+    int      w, h;             // 渲染输出大小（像素）
+    float    scale;            // 像素 / 设计尺寸
+    int      ox, oy;           // 设计区域左上角（像素）
+    float    mouse_sx, mouse_sy;   // 窗口坐标（鼠标事件）乘上它就是像素坐标
+    int      board_x, board_y; // 棋盘左上角那个交叉点（像素）
+    int      cell;             // 格距（像素）
+    unsigned generation;       // 每次尺寸变了加一；按尺寸缓存的东西（底图等）看它决定要不要重建
+} Layout;
+
+/* 按 ren 当前的输出大小重算布局；尺寸变了返回 1。每个界面画之前调一次 */
+int layout_sync(SDL_Renderer *ren);
+
+/* 当前布局 */
+const Layout *layout_get(void);
+
+/* 设计尺寸里的长度换成像素 */
+int ui_px(int design);
+
+/* 设计坐标里的矩形换成像素矩形 */
+SDL_Rect ui_rect(int x, int y, int w, int h);
+
+/* 整个输出区域 */
+SDL_Rect ui_full(void);
+
+/* 鼠标事件的窗口坐标换成像素坐标（就地改） */
+void layout_mouse(int *x, int *y);
+
+/* 取某个界面的按钮表。rows 是回放列表这一页显示几行，paged 表示要不要上一页/下一页；
+ * 其他界面这两个参数不用。返回按钮个数 */
+int layout_buttons(UiScreen screen, int rows, int paged, UiButton *out);
+
+/* 点击测试：(x, y) 是鼠标事件里的窗口坐标。点中返回按钮 id（行号写进 *row），没点中返回 UI_NONE */
+UiId layout_hit(UiScreen screen, int rows, int paged, int x, int y, int *row);
+
+#endif /* LAYOUT_H */
@@ -0,0 +1,45 @@
+/*
+ * lzblock.h
+ * 封存段的块压缩归档（冷存储）。
+ *
+ * 压缩算法是自带的 LZ77（LZ4 风格的 token 格式），不依赖任何外部库。
+ * 记录里全是 {"p":1,"r":8,"c":10} 这种重复度极高的片段，用哈希链 + 懒惰匹配
+ * 找长匹配，压缩率比直接存文本高很多。
+ *
+ * 归档文件 seg_xxxxx.lzb 的布局（整数都是小端 uint32）：
+ *     头部       "SIXZ" | 版本 | 块数 B | 记录数 N
+ *     块表       B 项 { 文件偏移, 压缩后字节数, 原始字节数 }
+ *     记录表     N 项 { 块号, 块内偏移 }
+ *     数据区     各个独立压缩的块（每块原始数据不超过 LZB_BLOCK_SIZE）
+ *
+ * 读第 i 条记录：查记录表 -> 查块表 -> 只解压那一个块，和文件多大无关。
+ */
+
+#ifndef LZBLOCK_H
+#define LZBLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* 每个块的原始数据上限（64 KB，同时保证匹配偏移能用 16 位表示） */
+#define LZB_BLOCK_SIZE 65536
+
+/* 压缩结果最坏情况下的大小（全是字面量时） */
+#define LZ_COMPRESS_BOUND(n) ((n) + (n) / 255 + 16)
+
+/* 压缩一块数据（n 不能超过 LZB_BLOCK_SIZE）。返回压缩后的字节数，失败返回 0。 */
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap);
+
+/* 解压一块数据。返回解压出的字节数，数据损坏返回 0。 */
+size_t lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap);
+
+/* 把一个 NDJSON 段文件压成归档。成功返回 1，失败返回 0（不会留下半个归档）。 */
+int lzb_write_segment(const char *json_path, const char *lzb_path);
+
+/* 读归档里的第 local 条记录，返回 malloc 出来的一行（带 '\n'），失败返回 NULL */
+char *lzb_read_record(const char *lzb_path, int local);
+
+/* 把整个归档解压回文本（删除记录、导出时用），返回 malloc 的缓冲区，长度写到 *out_len */
+char *lzb_read_all(const char *lzb_path, size_t *out_len);
+
+#endif /* LZBLOCK_H */
@@ -0,0 +1,61 @@
+/*
+ * perf.h
+ * 性能计数：帧时间、每帧绘制调用数、纹理上传数、事件循环唤醒次数、AI 思考时间、读写耗时。
+ * 对局和回放界面按 F3 打开/关闭左上角的性能面板（gui.c 的 draw_perf_overlay），
+ * 调界面和 AI 的时候不用再瞎猜。
+ *
+ * 计数一直在做（就是几次加法），面板只决定画不画。面板上的数字每 PERF_REFRESH_MS 才更新一次，
+ * 不然每帧都变，既看不清，文字缓存也白搭。只在主线程里用。
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <SDL2/SDL.h>
+
+/* 帧时间取最近多少帧算平均值和 p99 */
+#define PERF_FRAMES 240
+
+/* 面板数字多久刷新一次（毫秒） */
+#define PERF_REFRESH_MS 250
+
+typedef struct {
+    double frame_last_ms;      // 最近一帧：从开始画到 Present 返回
+    double frame_avg_ms;       // 最近 PERF_FRAMES 帧的平均
+    double frame_p99_ms;       // 最近 PERF_FRAMES 帧的 p99
+    int    draws;              // 最近一帧的绘制调用数（按 gui 层的提交点计）
+    int    uploads;            // 最近一帧新建/重画的纹理数（文字、棋子贴图、HUD、底图）
+    double wakeups_per_sec;    // 事件循环每秒醒来几次
+    double ai_ms;              // 最近一次 AI 落子用时
+    double ai_nodes_per_sec;   // 最近一次 AI 落子每秒看的局面数
+    double io_ms;              // 最近一次存盘/读盘用时
+} PerfStats;
+
+/* 高精度计时：perf_now 取一个时间点，perf_ms_since 算从那之后过了多少毫秒 */
+Uint64 perf_now(void);
+double perf_ms_since(Uint64 start);
+
+/* 一帧的开始和结束（结束在 SDL_RenderPresent 之后调用） */
+void perf_frame_begin(void);
+void perf_frame_end(void);
+
+/* 计数：绘制调用 n 次、上传（新建/重画）一张纹理、事件循环醒来一次 */
+void perf_count_draw(int n);
+void perf_count_upload(void);
+void perf_count_wakeup(void);
+
+/* 记录最近一次 AI 落子（用时、看过的局面数）和最近一次读写的用时 */
+void perf_set_ai(double ms, long nodes);
+void perf_set_io(double ms);
+
+/* F3：切换面板显示，返回切换后的状态 */
+int perf_toggle(void);
+int perf_enabled(void);
+
+/* 面板要显示的数字（每 PERF_REFRESH_MS 更新一次） */
+const PerfStats *perf_stats(void);
+
+/* 面板打开时，下一次该刷新数字的时刻（SDL_GetTicks）；面板关着返回 0 */
+Uint32 perf_next_refresh(void);
+
+#endif /* PERF_H */
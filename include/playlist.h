@@ -0,0 +1,75 @@
+/*
+ * playlist.h
+ * 回放列表的分页数据源：按页取记录摘要（时间、胜者、手数），给回放菜单显示用。
+ *
+ * 取数据在后台线程里做：当前页没缓存时先返回 0（界面先画占位），
+ * 同时把当前页和前后两页排进队列；取回来的页放进一个很小的 LRU 缓存。
+ * 翻页时只查缓存，不碰磁盘，跟存档有多大无关。
+ *
+ * 缩略图（终局的小棋盘图）也在这个后台线程里准备：摘要先发出去让界面把文字画上，
+ * 再逐行取缩略图。缩略图按落子序列哈希存在 liu/data/thumbs/ 下，画过一次以后
+ * 再翻到这盘棋只读一个小 bmp，不用重新画；同一盘棋存了几次也只有一张。
+ * 这里只给出 SDL_Surface，建纹理是界面的事（只给当前这一页建）。
+ */
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+
+/* 缓存最多保留多少页 */
+#define PLAYLIST_CACHE_PAGES 8
+
+/* 每页最多几行（回放菜单一页 6 行，留点余量） */
+#define PLAYLIST_MAX_ROWS 16
+
+/* 缩略图边长（像素）。按高 DPI 屏留了余量，画的时候缩到按钮里 */
+#define PLAYLIST_THUMB_SIZE 96
+
+/* 缩略图的磁盘缓存目录 */
+#define PLAYLIST_THUMB_DIR "liu/data/thumbs"
+
+/* 磁盘上最多留多少张缩略图（一张约 36 KB）。每次打开回放列表后由后台线程检查，
+ * 超了就按最近使用时间（文件修改时间，读到时会刷新）删到 3/4 */
+#define PLAYLIST_THUMB_MAX 512
+
+/* 一条记录的摘要 */
+typedef struct {
+    int  index;       // 全局编号（从 0 开始）
+    int  ok;          // 0 = 记录读不出来或已损坏
+    char time[20];    // "YYYY-mm-dd HH:MM:SS"
+    int  winner;      // 0 平局 / 1 黑胜 / 2 白胜
+    int  moves;       // 手数
+    int  undo;        // 悔棋次数
+    uint64_t hash;    // 落子序列哈希（缩略图按它存取），记录读不出来时为 0
+} RecordSummary;
+
+/* 打开数据源并启动预取线程（per_page 是每页行数）。成功返回 1 */
+int playlist_open(int per_page);
+
+/* 停掉预取线程，清空缓存 */
+void playlist_close(void);
+
+/* 记录总条数（打开时和每次取页时顺带刷新，不用每帧读 manifest） */
+int playlist_total(void);
+
+/* 取第 page 页。已缓存时把摘要拷进 rows、条数写进 *count，返回 1；
+ * 还没取到时返回 0（已经排进预取队列，稍后再问）。 */
+int playlist_page(int page, RecordSummary *rows, int *count);
+
+/* 记录被删除/新增后调用：编号都变了，缓存全部作废，总数立即重读 */
+void playlist_invalidate(void);
+
+/* 自上次调用以来后台是否取回了新页（界面据此决定要不要重画） */
+int playlist_take_updates(void);
+
+/* 取某盘棋的缩略图：返回一份拷贝（调用者建完纹理就 SDL_FreeSurface），
+ * 后台还没准备好、或者这盘棋不在缓存的页里时返回 NULL（准备好了会发事件） */
+SDL_Surface *playlist_thumb(uint64_t hash);
+
+/* 后台取回新页（或者一页的缩略图）时会往事件队列里放一个 SDL_USEREVENT（user.code 是这个值），
+ * 在 SDL_WaitEvent 里等着的界面因此会被叫醒，不用轮询 */
+#define PLAYLIST_EVENT_CODE 0x504C   /* 'PL' */
+
+#endif /* PLAYLIST_H */
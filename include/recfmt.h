@@ -0,0 +1,48 @@
+/*
+ * recfmt.h
+ * 对局记录的几种交换格式（导入导出工具用）：
+ *     NDJSON  存档本身的格式，每行一条 JSON
+ *     二进制  紧凑格式，文件头 "SIXB" + 版本，之后每条记录 = 2 字节长度 + 负载
+ *             负载：时间 19 字节 | 胜者 1 字节 | 悔棋次数 2 字节 | 步数 2 字节 | 模式 1 字节 | 用时 4 字节 | 每步 2 字节
+ *             （版本 1 没有模式和用时两项，也能读）
+ *             每步打包成 (player << 10) | (row << 5) | col，整数都是小端
+ *     SGF     通用棋谱格式，一局一棵树：(;FF[4]GM[Connect6]SZ[19]DT[..]RE[B+];B[jj];W[ik]...)
+ *             时分秒、悔棋次数、模式、用时放在私有属性 XT[] / XU[] / XM[] / XD[] 里，其他软件会原样忽略
+ */
+
+#ifndef RECFMT_H
+#define RECFMT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "fileio.h"
+
+typedef enum {
+    FMT_NDJSON = 0,
+    FMT_BINARY = 1,
+    FMT_SGF    = 2
+} RecordFormat;
+
+/* 根据文件扩展名猜格式：.bin -> 二进制，.sgf -> SGF，其余按 NDJSON */
+RecordFormat recfmt_guess(const char *path);
+
+/* 格式名字（打印用） */
+const char *recfmt_name(RecordFormat fmt);
+
+/* 写文件头（只有二进制有），返回写入的字节数 */
+size_t recfmt_write_header(RecordFormat fmt, FILE *fp);
+
+/* 读并校验文件头。成功返回 1，不是这个格式返回 0 */
+int recfmt_read_header(RecordFormat fmt, FILE *fp);
+
+/* 从输入里切出下一个“单元”（NDJSON 的一行 / 二进制的一条负载 / SGF 的一棵树），
+ * 放进 *unit（自动扩容，末尾补 '\0'），长度写到 *len。读完返回 0。 */
+int recfmt_next_unit(RecordFormat fmt, FILE *fp, char **unit, size_t *len, size_t *cap);
+
+/* 解码一个单元。成功返回 1，坏数据返回 0 */
+int recfmt_decode(RecordFormat fmt, const char *unit, size_t len, GameRecord *rec);
+
+/* 把一条记录编码成目标格式，追加到 *buf 末尾（自动扩容）。成功返回 1 */
+int recfmt_encode(RecordFormat fmt, const GameRecord *rec, char **buf, size_t *len, size_t *cap);
+
+#endif /* RECFMT_H */
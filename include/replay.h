@@ -0,0 +1,79 @@
+/*
+ * replay.h
+ * 回放用的关键帧索引：每 REPLAY_KEYFRAME_INTERVAL 手存一份压缩棋盘（每格 2 bit），
+ * 跳到第 n 手时先还原最近的关键帧，再补上不到一个间隔的几手，
+ * 所以快进、后退、拖进度条都是常数时间，和对局长短无关。
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include "game.h"
+
+/* 关键帧间隔（手） */
+#define REPLAY_KEYFRAME_INTERVAL 16
+
+/* 一个关键帧：361 格 × 2 bit = 91 字节 */
+#define REPLAY_PACKED_BYTES ((BOARD_SIZE * BOARD_SIZE * 2 + 7) / 8)
+
+/* 最多需要的关键帧数（第 0 手也算一个） */
+#define REPLAY_MAX_KEYFRAMES (BOARD_SIZE * BOARD_SIZE / REPLAY_KEYFRAME_INTERVAL + 2)
+
+typedef struct {
+    int     total;                                   // 总手数
+    int     winner;                                  // 记录里的胜者
+    int     undo_count;
+    Move    moves[BOARD_SIZE * BOARD_SIZE];          // 逐手增量
+    int     key_count;
+    uint8_t keys[REPLAY_MAX_KEYFRAMES][REPLAY_PACKED_BYTES];  // keys[k] = 下完 k*INTERVAL 手后的棋盘
+} Replay;
+
+/* 根据一局完整记录建立关键帧索引 */
+void replay_build(Replay *rp, const GameState *game);
+
+/* 还原“下完前 n 手”时的局面（n 会被夹到 0..total），写进 *out。
+ * out 里的 moves / moves_count 也同步成前 n 手，最后一步高亮照常能用。 */
+void replay_seek(const Replay *rp, int n, GameState *out);
+
+/* ========== 播放时钟 ==========
+ * 自动播放不再是“睡 300 毫秒走一手”：记下开始播放的时刻和那时的手数，
+ * 任何时候“该显示第几手”都由经过的时间直接算出来（时间由调用者给，用高精度计时器），
+ * 所以 1000 倍速一帧里跳过几十手也不会越播越慢，暂停、单步、改速度也不用等当前这一手走完。 */
+
+/* 1 倍速时每手多少毫秒 */
+#define REPLAY_BASE_INTERVAL_MS 300.0
+
+/* 速度档位：0.1x ~ 1000x */
+#define REPLAY_SPEED_COUNT 14
+#define REPLAY_SPEED_DEFAULT 3      // 1x
+
+typedef struct {
+    int    playing;
+    int    speed;          // 档位，下标见 replay_speed
+    int    origin_move;    // 开始计时的时候是第几手
+    double origin_ms;      // 开始计时的时刻
+} ReplayClock;
+
+/* 档位对应的倍数 */
+double replay_speed(int speed);
+
+/* 初始化：停在第 0 手、1 倍速、暂停 */
+void replay_clock_init(ReplayClock *c);
+
+/* 从第 move 手开始播放（now_ms 是当前时刻） */
+void replay_clock_play(ReplayClock *c, int move, double now_ms);
+
+/* 暂停（停在调用者当前显示的那一手上，不用再传） */
+void replay_clock_pause(ReplayClock *c);
+
+/* 换档（delta 为 +1/-1，夹在档位范围内）。播放中会从当前这一手 move 重新计时，画面不跳 */
+void replay_clock_shift(ReplayClock *c, int delta, int move, double now_ms);
+
+/* 现在该显示第几手（夹到 0..total）；暂停时返回 -1，表示由调用者自己决定 */
+int replay_clock_move(const ReplayClock *c, int total, double now_ms);
+
+/* 显示第 move 手时，下一手该在什么时刻出现（和 now_ms 同一个时间基准） */
+double replay_clock_next(const ReplayClock *c, int move);
+
+#endif /* REPLAY_H */
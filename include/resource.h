@@ -0,0 +1,58 @@
+/*
+ * resource.h
+ * 进程级资源管理：字体和图片在启动时（后台线程里）只加载一次，一直留到程序退出，
+ * 各个界面拿同一份句柄用。以前每个界面退出时 gui_quit 都要关字体、TTF_Quit、删背景纹理，
+ * 下一个界面再重新打开字体文件、重新读 image/menu_bg.bmp。
+ *
+ * 字体和解码后的图片（SDL_Surface）跟 renderer 无关，整个进程只有一份；
+ * 纹理属于 renderer，第一次用到时从内存里的图片现做一份，不再读盘。
+ * 销毁 renderer 之前要调 res_release_textures。
+ */
+
+#ifndef RESOURCE_H
+#define RESOURCE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+typedef enum {
+    RES_FONT_MENU = 0,    // 菜单/结束界面用的宋体
+    RES_FONT_SMALL,       // 同一种宋体的小字号（性能面板的标签）
+    RES_FONT_COUNT
+} ResFont;
+
+typedef enum {
+    RES_IMAGE_MENU_BG = 0,   // 菜单背景图 image/menu_bg.bmp
+    RES_IMAGE_COUNT
+} ResImage;
+
+/* 菜单字体的字号（像素） */
+#define RES_MENU_FONT_SIZE 26
+
+/* 小字号（像素） */
+#define RES_SMALL_FONT_SIZE 14
+
+/* 启动后台加载线程（在 SDL_Init 之后调用一次）。TTF 初始化失败返回 0，程序照样能跑，只是没字 */
+int res_init(void);
+
+/* 程序退出前调用：关字体、释放图片、TTF_Quit */
+void res_shutdown(void);
+
+/* 取字体；后台线程还没加载完就等它加载完。加载失败返回 NULL */
+TTF_Font *res_font(ResFont id);
+
+/* 字体当前的字号（像素）：设计字号 × 界面缩放（见 res_set_font_scale） */
+int res_font_size(ResFont id);
+
+/* 界面缩放变了（窗口大小、高 DPI）：所有字体按 设计字号 × scale 重设字号，
+ * 这样文字是按实际像素光栅化的，不是放大出来的 */
+void res_set_font_scale(float scale);
+
+/* 取图片在 ren 上的纹理；第一次调用时用内存里的图片创建。加载失败返回 NULL。
+ * 返回的纹理归资源管理器所有，调用者不要销毁 */
+SDL_Texture *res_texture(SDL_Renderer *ren, ResImage id);
+
+/* 销毁所有纹理（关 renderer 前调用）；字体和图片本身保留 */
+void res_release_textures(void);
+
+#endif /* RESOURCE_H */
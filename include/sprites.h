@@ -0,0 +1,37 @@
+/*
+ * sprites.h
+ * 预先画好的棋子贴图：每种棋子、每个半径只光栅化一次（带抗锯齿和一点立体感的高光），
+ * 存成纹理，画棋盘时一颗棋子就是一次 SDL_RenderCopy。
+ * 以前每颗棋子每帧都要逐行 sqrt、画 2r 条线，满盘就是上万次绘制调用。
+ *
+ * 纹理属于 renderer，销毁 renderer 之前要调 sprites_release。
+ */
+
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <SDL2/SDL.h>
+
+typedef enum {
+    SPRITE_BLACK = 0,   // 黑子
+    SPRITE_WHITE,       // 白子
+    SPRITE_MARKER,      // 最后一手的红点
+    SPRITE_KIND_COUNT
+} SpriteKind;
+
+/* 取某种棋子在半径 radius 下的贴图（没有就现画一张）。
+ * 贴图是 (2 * radius + 1) 见方，圆心在正中间那个像素上，画的时候用 sprite_draw 即可。
+ * 失败返回 NULL */
+SDL_Texture *sprite_get(SDL_Renderer *ren, SpriteKind kind, int radius);
+
+/* 只算像素、不建纹理：把棋子画进调用者给的 (2 * radius + 1) 见方的 ARGB8888 缓冲区。
+ * 不碰任何全局状态，可以在多个线程里同时调（离屏导出图片用，见 boardimg.h） */
+void sprite_rasterize(SpriteKind kind, int radius, Uint32 *pixels);
+
+/* 以 (cx, cy) 为圆心画一颗棋子；贴图拿不到时退回逐行画实心圆 */
+void sprite_draw(SDL_Renderer *ren, SpriteKind kind, int cx, int cy, int radius);
+
+/* 销毁所有贴图（关 renderer 前调用，窗口大小变了也可以调用来重画） */
+void sprites_release(void);
+
+#endif /* SPRITES_H */
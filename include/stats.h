@@ -0,0 +1,70 @@
+/*
+ * stats.h
+ * 累计战绩统计：按模式、按天记着下了几盘、黑胜/白胜/和棋各几盘、总手数、总用时，
+ * 平均值用的时候现算。每次 save_record 只改几个固定大小的计数，不用扫存档，
+ * 主菜单和 recordtool 打开就能看到历史总战绩（以前的比分每次启动都清零）。
+ *
+ * 文件 liu/data/stats.bin（整数都是小端）：
+ *     文件头 8 字节：  "SIXS" | 版本 1 字节 | 3 字节保留
+ *     STATS_MODES 个累计桶：第 m 个是模式 m 的总计，位置固定
+ *     之后是按天的桶，按日期先后追加
+ * 每个桶 48 字节：日期 yyyymmdd(u32，累计桶为 0) | 模式 | 盘数 | 黑胜 | 白胜 | 和棋
+ *               | 有用时的盘数 | 保留 | 总手数(u64) | 总用时秒数(u64)
+ * 当天的桶一定在文件末尾（最多 STATS_MODES 个），更新时只往回看这几个，所以是 O(1)。
+ *
+ * 写操作都在存档锁里做（store_locked），多个进程同时保存也不会把计数写乱。
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+
+/* 模式编号和 main.c 一致：0 未知（老记录）、1 双人、2/3/4 人机简单/中级/困难 */
+#define STATS_MODES 5
+
+/* 一组统计数字 */
+typedef struct {
+    int games;              // 盘数
+    int black_wins;
+    int white_wins;
+    int draws;              // 没分出胜负的（和棋/中途退出）
+    int timed;              // 记了用时的盘数（老记录没有用时，不算进平均用时）
+    long long total_moves;
+    long long total_seconds;
+} StatTotals;
+
+/* 某一天、某个模式的统计 */
+typedef struct {
+    int day;                // yyyymmdd
+    int mode;
+    StatTotals t;
+} StatDay;
+
+/* 记一盘：mode 见上，timestr 是 "YYYY-mm-dd HH:MM:SS"（取前 10 个字符当日期），
+ * seconds <= 0 表示不知道用时。成功返回 1 */
+int stats_add(int mode, const char *timestr, int winner, int moves, int seconds);
+
+/* 把一批记录（NDJSON，每行一盘，和存档里的格式一样）计进统计。
+ * 调用者已经持有存档锁：给 store_append_batch 的回调用，导入的记录和统计在同一把锁里一起加上。
+ * 成功返回 1 */
+int stats_add_lines_locked(const char *lines, size_t len);
+
+/* 读某个模式的累计统计；mode < 0 表示所有模式加起来。成功返回 1（文件不存在时全是 0，也返回 1） */
+int stats_totals(int mode, StatTotals *out);
+
+/* 读出全部按天的统计，*out 是 malloc 的数组（调用者 free），返回条数，失败返回 -1 */
+int stats_load_days(StatDay **out);
+
+/* 从存档重新统计一遍（统计文件丢了/导入了别的存档之后用），重复保存的棋按引用计数算。
+ * 成功返回统计到的盘数，失败返回 -1 */
+int stats_rebuild(void);
+
+/* 平均手数 / 平均用时（秒）；没有数据时返回 0 */
+double stats_avg_moves(const StatTotals *t);
+double stats_avg_seconds(const StatTotals *t);
+
+/* 模式名（"双人"、"人机-困难" 等） */
+const char *stats_mode_name(int mode);
+
+#endif /* STATS_H */
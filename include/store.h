@@ -0,0 +1,101 @@
+/*
+ * store.h
+ * 分段记录存储：对局记录不再堆在一个 records.json 里，而是拆成多个段文件，
+ * 再配一个很小的 manifest（每段的条数、字节数、时间范围、是否已封存）。
+ *
+ * 目录结构（都在 liu/data/ 下）：
+ *     manifest.json       每行一个段的描述
+ *     seg_00000.json      段文件：和以前的 records.json 一样，每行一条 JSON
+ *     seg_00000.lzb       已封存段的块压缩归档（见 lzblock.h），压缩成功后替代 .json
+ *     seg_00000.idx       压缩失败时退回的行偏移索引（uint32 数组，一条记录一项）
+ *     hashes.bin          去重用的对局哈希日志（见 dedup.h）
+ *     stats.bin           累计战绩统计（见 stats.h）
+ *
+ * 只有最后一个段是“活动段”，新记录只往它后面追加；活动段写满以后封存，
+ * 封存段不再改动（删除记录时除外），压成独立的 64 KB 块并带块索引，
+ * 读某一局只需解压一个块。
+ */
+
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "dedup.h"
+
+/* 单个段最多放多少条记录 / 多少字节，超过任一个就封存并开新段 */
+#define SEGMENT_MAX_RECORDS 512
+#define SEGMENT_MAX_BYTES   (1L << 20)
+
+/* manifest 里一个段的描述 */
+typedef struct {
+    int  id;              // 段编号，对应 seg_<id>.json
+    int  count;           // 段内记录条数
+    long bytes;           // 段的原始（未压缩）字节数
+    int  closed;          // 1 = 已封存（不可变，有索引），0 = 活动段
+    int  compressed;      // 1 = 封存段已压成 .lzb 归档
+    char first_time[20];  // 段内第一条记录的时间（"YYYY-mm-dd HH:MM:SS"）
+    char last_time[20];   // 段内最后一条记录的时间
+} SegmentInfo;
+
+/* 确保 liu/data 目录存在 */
+void store_ensure_dir(void);
+
+/* 安全地整个重写一个小文件：先写 tmp（和 dst 同一个目录），store_sync_file 把它刷到盘上、
+ * 关掉，再 store_replace_file 一步换掉 dst（POSIX 的 rename、Windows 的 MoveFileEx 都是原子的），
+ * 任何时候断电磁盘上都是一份完整的旧文件或新文件。成功返回 1 */
+int store_sync_file(FILE *fp);
+int store_replace_file(const char *tmp, const char *dst);
+
+/* 追加一行记录（line 必须以 '\n' 结尾）。timestr 用于维护段的时间范围。
+ * 成功返回 1，失败返回 0。 */
+int store_append_line(const char *line, size_t len, const char *timestr);
+
+/* 批量追加若干整行（导入工具用）：一次加锁，写满的段照常封存。
+ * 写成功后还在同一把锁里调 then(arg)（可以是 NULL），导入时顺手记统计，
+ * 别的进程不会在“记录进了存档、统计还没加上”的中间插进来。成功返回 1。 */
+int store_append_batch(const char *lines, size_t len, int (*then)(void *), void *arg);
+
+/* 记录总条数：直接把 manifest 里每段的 count 加起来，不扫文件 */
+int store_count(void);
+
+/* 读取第 index 条记录（从 0 开始），返回 malloc 出来的一行，调用者负责 free。
+ * 找不到返回 NULL。 */
+char *store_read_line(int index);
+
+/* 连续读第 first 起的 n 条记录（翻页列表用）：只加一次锁、只读一次 manifest。
+ * out[i] 是 malloc 的一行或 NULL（越界/读失败），调用者负责 free。返回读到的条数。 */
+int store_read_lines(int first, int n, char **out);
+
+/* 拷一份所有棋局的引用计数（每盘棋被保存过几次，按哈希升序，用 dedup_find 查），
+ * *out 是 malloc 的数组（调用者 free），返回项数，失败返回 -1。
+ * 追加记录时会按行尾的 "h" 字段去重：已经存过的棋只加引用计数，不再写新行（见 dedup.h）。
+ * 只加一次锁、读一次 manifest，要查很多盘棋（比如重建统计）时用它 */
+int store_refcount_snapshot(DedupRef **out);
+
+/* 删除第 index 条记录，只重写它所在的那个段。成功返回 1，失败返回 0。 */
+int store_delete(int index);
+
+/* 清空全部记录（删掉所有段文件、索引和 manifest）。成功返回 1。 */
+int store_clear(void);
+
+/* 在存档锁里执行 fn(arg)，返回 fn 的返回值。
+ * 给和存档放在一起、也要多进程互斥的小文件用（比如 stats.bin，见 stats.h）；fn 里不能再调 store_* */
+int store_locked(int (*fn)(void *), void *arg);
+
+/* 段数量（给工具和统计用；要看每段的描述用下面的 store_snapshot 拷一份） */
+int store_segment_count(void);
+
+/* 把第 i 个段整段读成文本（压缩段会解压），返回 malloc 的缓冲区，长度写到 *out_len。
+ * 导出/校验工具按段流式处理，内存占用只和单个段大小有关。 */
+char *store_segment_text(int i, size_t *out_len);
+
+/* 上面这些函数在进程内也互斥（manifest 缓存只有一份），可以从多个线程调用，但会排队。
+ * 需要多线程按段并行处理时：先用 store_snapshot 拷一份 manifest（malloc，调用者 free），
+ * 再在各个线程里用 store_snapshot_text 按拷贝读段文件，它只读文件、不碰全局状态。
+ * store_snapshot 返回段数，失败返回 -1。 */
+int store_snapshot(SegmentInfo **out);
+char *store_snapshot_text(const SegmentInfo *s, size_t *out_len);
+
+#endif /* STORE_H */
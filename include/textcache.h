@@ -0,0 +1,32 @@
+/*
+ * textcache.h
+ * 文字纹理缓存：菜单、回放列表每次重画都要画同样的几十个标签，
+ * 以前每画一次就 TTF_RenderUTF8_Blended 光栅化一遍、再上传成纹理、用完销毁。
+ * 现在按 (字体, 字号, 颜色, 字符串) 缓存渲染好的纹理，稳定状态下一帧不再光栅化也不上传。
+ *
+ * 缓存有两个上限：最多 TEXTCACHE_SLOTS 条，纹理总字节数（宽 × 高 × 4）不超过 TEXTCACHE_BUDGET，
+ * 超了就淘汰最久没用的。纹理属于 renderer，销毁 renderer 之前要先 textcache_clear。
+ */
+
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#define TEXTCACHE_SLOTS  256
+#define TEXTCACHE_BUDGET (4 * 1024 * 1024)
+
+/* 取 utf8 在这个字体/颜色下的纹理，没缓存就现在渲染一份放进去。
+ * size 是字体的字号（同一个 TTF_Font 改过字号时靠它区分）。
+ * 返回的纹理归缓存所有，调用者不要销毁；宽高写到 *w / *h。失败返回 NULL */
+SDL_Texture *textcache_get(SDL_Renderer *ren, TTF_Font *font, int size,
+                           const char *utf8, SDL_Color color, int *w, int *h);
+
+/* 销毁全部缓存的纹理（关 renderer 或关字体之前调用） */
+void textcache_clear(void);
+
+/* 命中/未命中次数和当前占用的字节数（调试、性能面板用，参数可以为 NULL） */
+void textcache_stats(unsigned *hits, unsigned *misses, size_t *bytes);
+
+#endif /* TEXTCACHE_H */
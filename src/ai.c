@@ -9,9 +9,18 @@
 #include <time.h>
 #include <stdio.h>
 
+/* 这一次 ai_move 看过的局面数 */
+static long g_nodes = 0;
+
+long ai_last_nodes(void)
+{
+    return g_nodes;
+}
+
 /* 计算某个位置的评分：越高表示此位置越值得落子；无（只使用了基本的循环和计算） */
 static int evaluate_pos(const GameState *game, int row, int col, int player)
 {
+    g_nodes++;
     int score = 0;
     /* 临时放一个棋子，分别统计四个方向上连续己子和连续对手 */
     int directions[4][2] = {{1,0},{0,1},{1,1},{1,-1}};
@@ -60,6 +69,18 @@ static int evaluate_pos(const GameState *game, int row, int col, int player)
     return score;
 }
 
+void ai_score_board(const GameState *game, int scores[BOARD_SIZE][BOARD_SIZE])
+{
+    long saved = g_nodes;
+    for (int r = 0; r < BOARD_SIZE; r++) {
+        for (int c = 0; c < BOARD_SIZE; c++) {
+            scores[r][c] = (!game->finished && game->cells[r][c] == CELL_EMPTY)
+                         ? evaluate_pos(game, r, c, game->current_player) : 0;
+        }
+    }
+    g_nodes = saved;
+}
+
 /* 随机挑选一个可落子的空位；- rand() : 来自 <stdlib.h>，生成随机整数（返回 0 到 RAND_MAX 之间的随机数） */
 static int random_move(GameState *game)
 {
@@ -72,6 +93,7 @@ static int random_move(GameState *game)
         }
     }
     if (empty_count == 0) return 0;
+    g_nodes++;
     int pick = rand() % empty_count;
     for (int r = 0; r < BOARD_SIZE; r++) {
         for (int c = 0; c < BOARD_SIZE; c++) {
@@ -90,6 +112,7 @@ static int random_move(GameState *game)
 /* AI 落子实现（电脑下棋）；- srand() : 来自 <stdlib.h>，设置随机数生成器的种子 */
 void ai_move(GameState *game, int difficulty)
 {
+    g_nodes = 0;
     if (!game || game->finished) return;
     /* 确保随机数种子只初始化一次 */
     static int seeded = 0;
@@ -144,6 +167,7 @@ void ai_move(GameState *game, int difficulty)
         for (int c = 0; c < BOARD_SIZE; c++) {
             if (game->cells[r][c] != CELL_EMPTY) continue;
             /* 检查是否能直接获胜 */
+            g_nodes += 2;   // 自己试下一步、对手试下一步
             temp = *game;
             place_stone(&temp, r, c);
             if (temp.winner == self) {
@@ -177,6 +201,7 @@ void ai_move(GameState *game, int difficulty)
         for (int c = 0; c < BOARD_SIZE; c++) {
             if (game->cells[r][c] != CELL_EMPTY) continue;
             /* 计算如果对手在该位置落子，形成的最大连续长度 */
+            g_nodes++;
             int max_len = 1;
             int directions[4][2] = {{1,0},{0,1},{1,1},{1,-1}};
             for (int d = 0; d < 4; d++) {
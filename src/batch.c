@@ -0,0 +1,117 @@
+/*
+ * batch.c
+ * 批量提交绘制（见 batch.h）。
+ *
+ * SDL_RenderGeometry / SDL_Vertex 是 SDL 2.0.18 加的。渲染器画不了（返回出错）时
+ * 退回一个四边形一次 RenderCopy / FillRect，画出来一样，只是调用多。
+ */
+
+#include "batch.h"
+#include "perf.h"
+
+/* 每个四边形两个三角形：0-1-2、0-2-3（顶点顺序：左上、右上、右下、左下） */
+static int g_indices[BATCH_QUADS * 6];
+static int g_indices_ready = 0;
+
+static void build_indices(void)
+{
+    for (int q = 0; q < BATCH_QUADS; q++) {
+        int v = q * 4;
+        int *ix = &g_indices[q * 6];
+        ix[0] = v;
+        ix[1] = v + 1;
+        ix[2] = v + 2;
+        ix[3] = v;
+        ix[4] = v + 2;
+        ix[5] = v + 3;
+    }
+    g_indices_ready = 1;
+}
+
+/* 一个四边形一个四边形地画（RenderGeometry 出错时的退路）。
+ * 带贴图的四边形用纹理的颜色/透明度调制代替顶点颜色（淡入的棋子靠它），画完改回原样 */
+static void flush_one_by_one(SDL_Renderer *ren, QuadBatch *b)
+{
+    Uint8 r0 = 255, g0 = 255, b0 = 255, a0 = 255;
+    if (b->tex) {
+        SDL_GetTextureColorMod(b->tex, &r0, &g0, &b0);
+        SDL_GetTextureAlphaMod(b->tex, &a0);
+    }
+    for (int q = 0; q < b->quads; q++) {
+        const SDL_Vertex *v = &b->v[q * 4];
+        SDL_Rect dst;
+        dst.x = (int)v[0].position.x;
+        dst.y = (int)v[0].position.y;
+        dst.w = (int)v[2].position.x - dst.x;
+        dst.h = (int)v[2].position.y - dst.y;
+        if (b->tex) {
+            SDL_SetTextureColorMod(b->tex, v[0].color.r, v[0].color.g, v[0].color.b);
+            SDL_SetTextureAlphaMod(b->tex, v[0].color.a);
+            SDL_RenderCopy(ren, b->tex, NULL, &dst);
+        } else {
+            SDL_SetRenderDrawColor(ren, v[0].color.r, v[0].color.g, v[0].color.b, v[0].color.a);
+            SDL_RenderFillRect(ren, &dst);
+        }
+    }
+    if (b->tex) {
+        SDL_SetTextureColorMod(b->tex, r0, g0, b0);
+        SDL_SetTextureAlphaMod(b->tex, a0);
+    }
+}
+
+void quad_batch_begin(QuadBatch *b, SDL_Texture *tex)
+{
+    b->tex = tex;
+    b->quads = 0;
+}
+
+void quad_batch_add(SDL_Renderer *ren, QuadBatch *b, const SDL_Rect *dst, SDL_Color color)
+{
+    if (!dst || dst->w <= 0 || dst->h <= 0) return;
+    if (b->quads == BATCH_QUADS) quad_batch_flush(ren, b);
+
+    float x0 = (float)dst->x, y0 = (float)dst->y;
+    float x1 = (float)(dst->x + dst->w), y1 = (float)(dst->y + dst->h);
+    SDL_Vertex *v = &b->v[b->quads * 4];
+    v[0].position.x = x0; v[0].position.y = y0; v[0].tex_coord.x = 0.0f; v[0].tex_coord.y = 0.0f;
+    v[1].position.x = x1; v[1].position.y = y0; v[1].tex_coord.x = 1.0f; v[1].tex_coord.y = 0.0f;
+    v[2].position.x = x1; v[2].position.y = y1; v[2].tex_coord.x = 1.0f; v[2].tex_coord.y = 1.0f;
+    v[3].position.x = x0; v[3].position.y = y1; v[3].tex_coord.x = 0.0f; v[3].tex_coord.y = 1.0f;
+    for (int i = 0; i < 4; i++) v[i].color = color;
+    b->quads++;
+}
+
+void quad_batch_flush(SDL_Renderer *ren, QuadBatch *b)
+{
+    if (!ren || b->quads == 0) return;
+    if (!g_indices_ready) build_indices();
+    if (SDL_RenderGeometry(ren, b->tex, b->v, b->quads * 4, g_indices, b->quads * 6) != 0) {
+        flush_one_by_one(ren, b);
+        perf_count_draw(b->quads);
+    } else {
+        perf_count_draw(1);
+    }
+    b->quads = 0;
+}
+
+void rect_batch_begin(RectBatch *b, SDL_Color color)
+{
+    b->color = color;
+    b->count = 0;
+}
+
+void rect_batch_add(SDL_Renderer *ren, RectBatch *b, const SDL_Rect *r)
+{
+    if (!r || r->w <= 0 || r->h <= 0) return;
+    if (b->count == BATCH_RECTS) rect_batch_flush(ren, b);
+    b->rects[b->count++] = *r;
+}
+
+void rect_batch_flush(SDL_Renderer *ren, RectBatch *b)
+{
+    if (!ren || b->count == 0) return;
+    SDL_SetRenderDrawColor(ren, b->color.r, b->color.g, b->color.b, b->color.a);
+    SDL_RenderFillRects(ren, b->rects, b->count);
+    perf_count_draw(1);
+    b->count = 0;
+}
@@ -0,0 +1,427 @@
+/*
+ * boardimg.c
+ * 离屏画棋盘 + 存图（见 boardimg.h）。
+ *
+ * PNG：每行在 None/Sub/Up/Average/Paeth 五种过滤器里挑绝对值和最小的一种
+ * （棋盘大片同色，过滤后几乎全是 0），再用 LZ77 + 固定 Huffman 的 deflate 压缩。
+ * 不算动态 Huffman 表，压缩率比 zlib 差一点，但对这种图已经足够小。
+ */
+
+#include "boardimg.h"
+#include "sprites.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* 四周留白占边长的比例（界面里是 640 里留 40） */
+#define MARGIN_DIV 16
+
+/* ========== 画图 ========== */
+
+/* 在 ren 上建一张棋子贴图（每张图只建一次，画完就销毁） */
+static SDL_Texture *stone_texture(SDL_Renderer *ren, SpriteKind kind, int radius)
+{
+    int size = 2 * radius + 1;
+    Uint32 *pixels = (Uint32 *)malloc((size_t)size * (size_t)size * sizeof(Uint32));
+    if (!pixels) return NULL;
+    sprite_rasterize(kind, radius, pixels);
+    SDL_Texture *tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+    if (tex) {
+        SDL_UpdateTexture(tex, NULL, pixels, size * (int)sizeof(Uint32));
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    }
+    free(pixels);
+    return tex;
+}
+
+SDL_Surface *boardimg_render(const GameState *game, int size)
+{
+    if (!game || size < BOARDIMG_MIN_SIZE || size > BOARDIMG_MAX_SIZE) return NULL;
+
+    SDL_Surface *img = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!img) return NULL;
+    SDL_Renderer *ren = SDL_CreateSoftwareRenderer(img);
+    if (!ren) {
+        SDL_FreeSurface(img);
+        return NULL;
+    }
+
+    int margin = size / MARGIN_DIV;
+    int cell = (size - 2 * margin) / (BOARD_SIZE - 1);
+    int x0 = (size - cell * (BOARD_SIZE - 1)) / 2;
+    int y0 = x0;
+    int x1 = x0 + cell * (BOARD_SIZE - 1);
+    int y1 = y0 + cell * (BOARD_SIZE - 1);
+
+    /* 底色和网格线：和界面里的颜色一样 */
+    SDL_SetRenderDrawColor(ren, 240, 217, 181, 255);
+    SDL_RenderClear(ren);
+    SDL_SetRenderDrawColor(ren, 80, 60, 40, 255);
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        SDL_RenderDrawLine(ren, x0, y0 + i * cell, x1, y0 + i * cell);
+        SDL_RenderDrawLine(ren, x0 + i * cell, y0, x0 + i * cell, y1);
+    }
+
+    /* 棋子：半径的留缝也按比例（界面里 640 留 2） */
+    int radius = cell / 2 - size / 320;
+    if (radius < 1) radius = 1;
+    int marker_r = radius / 4 > 0 ? radius / 4 : 1;
+    SDL_Texture *black = stone_texture(ren, SPRITE_BLACK, radius);
+    SDL_Texture *white = stone_texture(ren, SPRITE_WHITE, radius);
+    SDL_Texture *marker = stone_texture(ren, SPRITE_MARKER, marker_r);
+    int ok = (black && white && marker);
+
+    for (int r = 0; ok && r < BOARD_SIZE; r++) {
+        for (int c = 0; c < BOARD_SIZE; c++) {
+            if (game->cells[r][c] == CELL_EMPTY) continue;
+            SDL_Rect dst = {x0 + c * cell - radius, y0 + r * cell - radius, 2 * radius + 1, 2 * radius + 1};
+            SDL_RenderCopy(ren, game->cells[r][c] == CELL_BLACK ? black : white, NULL, &dst);
+        }
+    }
+    if (ok && game->moves_count > 0) {
+        Move last = game->moves[game->moves_count - 1];
+        SDL_Rect dst = {x0 + last.col * cell - marker_r, y0 + last.row * cell - marker_r,
+                        2 * marker_r + 1, 2 * marker_r + 1};
+        SDL_RenderCopy(ren, marker, NULL, &dst);
+    }
+    /* 渲染命令是攒着的，销毁纹理之前先让它真正画到 surface 上 */
+    SDL_RenderFlush(ren);
+
+    if (black) SDL_DestroyTexture(black);
+    if (white) SDL_DestroyTexture(white);
+    if (marker) SDL_DestroyTexture(marker);
+    SDL_DestroyRenderer(ren);
+
+    if (!ok) {
+        SDL_FreeSurface(img);
+        return NULL;
+    }
+    return img;
+}
+
+/* ========== PNG 编码 ========== */
+
+static void put_u32be(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/* PNG 块用的 CRC-32（不是记录用的 CRC32C）。半字节查表：表只有 16 项，没有初始化的线程问题 */
+static uint32_t crc32_png(uint32_t crc, const uint8_t *p, size_t n)
+{
+    static const uint32_t T[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ T[crc & 15];
+        crc = (crc >> 4) ^ T[crc & 15];
+    }
+    return ~crc;
+}
+
+static uint32_t adler32(const uint8_t *p, size_t n)
+{
+    uint32_t a = 1, b = 0;
+    while (n > 0) {
+        size_t k = n < 5552 ? n : 5552;   // 5552 字节以内累加不会溢出
+        n -= k;
+        while (k--) {
+            a += *p++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+/* deflate 的位流：低位先出 */
+typedef struct {
+    uint8_t *out;
+    size_t   len;
+    uint32_t bits;
+    int      nbits;
+} BitWriter;
+
+static void put_bits(BitWriter *bw, uint32_t v, int n)
+{
+    bw->bits |= v << bw->nbits;
+    bw->nbits += n;
+    while (bw->nbits >= 8) {
+        bw->out[bw->len++] = (uint8_t)bw->bits;
+        bw->bits >>= 8;
+        bw->nbits -= 8;
+    }
+}
+
+/* Huffman 码是高位先出的，要倒过来写 */
+static void put_huff(BitWriter *bw, uint32_t code, int n)
+{
+    uint32_t rev = 0;
+    for (int i = 0; i < n; i++) rev |= ((code >> i) & 1u) << (n - 1 - i);
+    put_bits(bw, rev, n);
+}
+
+/* 固定 Huffman 表里的字面量/长度符号 */
+static void put_litlen(BitWriter *bw, int sym)
+{
+    if (sym < 144)      put_huff(bw, 0x30 + (uint32_t)sym, 8);
+    else if (sym < 256) put_huff(bw, 0x190 + (uint32_t)(sym - 144), 9);
+    else if (sym < 280) put_huff(bw, (uint32_t)(sym - 256), 7);
+    else                put_huff(bw, 0xC0 + (uint32_t)(sym - 280), 8);
+}
+
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+static void put_match(BitWriter *bw, int len, int dist)
+{
+    int li = 28;
+    while (LEN_BASE[li] > len) li--;
+    put_litlen(bw, 257 + li);
+    put_bits(bw, (uint32_t)(len - LEN_BASE[li]), LEN_EXTRA[li]);
+
+    int di = 29;
+    while (DIST_BASE[di] > dist) di--;
+    put_huff(bw, (uint32_t)di, 5);
+    put_bits(bw, (uint32_t)(dist - DIST_BASE[di]), DIST_EXTRA[di]);
+}
+
+#define WINDOW    32768
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define HASH_BITS 15
+
+static uint32_t hash3(const uint8_t *p)
+{
+    uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/* 整块数据压成一个 zlib 流（一个固定 Huffman 的 deflate 块）。返回字节数，失败返回 0 */
+static size_t zlib_compress(const uint8_t *src, size_t n, uint8_t *dst)
+{
+    int32_t *head = (int32_t *)malloc(sizeof(int32_t) << HASH_BITS);
+    if (!head) return 0;
+    for (int i = 0; i < (1 << HASH_BITS); i++) head[i] = -1;
+
+    BitWriter bw = {dst, 0, 0, 0};
+    dst[bw.len++] = 0x78;   // zlib 头：deflate，32K 窗口
+    dst[bw.len++] = 0x01;
+    put_bits(&bw, 1, 1);    // BFINAL
+    put_bits(&bw, 1, 2);    // BTYPE = 01 固定 Huffman
+
+    size_t i = 0;
+    while (i < n) {
+        int best = 0;
+        size_t dist = 0;
+        if (i + MIN_MATCH <= n) {
+            uint32_t h = hash3(src + i);
+            int32_t cand = head[h];
+            head[h] = (int32_t)i;
+            if (cand >= 0 && i - (size_t)cand <= WINDOW) {
+                size_t max = n - i < MAX_MATCH ? n - i : MAX_MATCH;
+                size_t k = 0;
+                while (k < max && src[cand + k] == src[i + k]) k++;
+                if (k >= MIN_MATCH) {
+                    best = (int)k;
+                    dist = i - (size_t)cand;
+                }
+            }
+        }
+        if (best) {
+            put_match(&bw, best, (int)dist);
+            /* 匹配里面的位置也进哈希表，后面才找得到它们 */
+            for (size_t k = 1; k < (size_t)best && i + k + MIN_MATCH <= n; k++) {
+                head[hash3(src + i + k)] = (int32_t)(i + k);
+            }
+            i += (size_t)best;
+        } else {
+            put_litlen(&bw, src[i]);
+            i++;
+        }
+    }
+    put_litlen(&bw, 256);   // 块结束
+    if (bw.nbits > 0) put_bits(&bw, 0, 8 - bw.nbits);
+
+    put_u32be(dst + bw.len, adler32(src, n));
+    free(head);
+    return bw.len + 4;
+}
+
+static int paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+/* 用过滤器 f 过滤一行（bpp = 3）。prev 是上一行的原始像素，第一行传全 0 */
+static void filter_row(int f, const uint8_t *cur, const uint8_t *prev, size_t n, uint8_t *out)
+{
+    for (size_t i = 0; i < n; i++) {
+        int a = i >= 3 ? cur[i - 3] : 0;
+        int b = prev[i];
+        int c = i >= 3 ? prev[i - 3] : 0;
+        int v = cur[i];
+        switch (f) {
+        case 1: v -= a; break;
+        case 2: v -= b; break;
+        case 3: v -= (a + b) / 2; break;
+        case 4: v -= paeth(a, b, c); break;
+        default: break;
+        }
+        out[i] = (uint8_t)v;
+    }
+}
+
+/* 写一个 PNG 块：长度 | 类型 | 数据 | CRC(类型 + 数据) */
+static int write_chunk(FILE *fp, const char *type, const uint8_t *data, size_t n)
+{
+    uint8_t hdr[8], tail[4];
+    put_u32be(hdr, (uint32_t)n);
+    memcpy(hdr + 4, type, 4);
+    uint32_t crc = crc32_png(0, hdr + 4, 4);
+    crc = crc32_png(crc, data, n);
+    put_u32be(tail, crc);
+    return fwrite(hdr, 1, 8, fp) == 8 &&
+           (n == 0 || fwrite(data, 1, n, fp) == n) &&
+           fwrite(tail, 1, 4, fp) == 4;
+}
+
+int boardimg_save_png(SDL_Surface *img, const char *path)
+{
+    if (!img || !path) return 0;
+
+    /* 统一成 ARGB8888 再取像素 */
+    SDL_Surface *src = img;
+    if (img->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        src = SDL_ConvertSurfaceFormat(img, SDL_PIXELFORMAT_ARGB8888, 0);
+        if (!src) return 0;
+    }
+    int w = src->w, h = src->h;
+    size_t row = (size_t)w * 3;
+    size_t raw_len = (size_t)h * (row + 1);
+
+    uint8_t *raw = (uint8_t *)malloc(raw_len);
+    uint8_t *lines = (uint8_t *)calloc(2, row);         // 上一行 / 这一行的原始 RGB
+    uint8_t *trial = (uint8_t *)malloc(row);
+    /* 全是字面量时每字节最多 9 位，再加 zlib 头尾 */
+    size_t z_cap = raw_len + raw_len / 8 + 64;
+    uint8_t *z = (uint8_t *)malloc(z_cap);
+    int ok = (raw && lines && trial && z);
+
+    if (ok && SDL_MUSTLOCK(src)) ok = (SDL_LockSurface(src) == 0);
+    if (ok) {
+        uint8_t *prev = lines, *cur = lines + row;
+        for (int y = 0; y < h; y++) {
+            const Uint32 *px = (const Uint32 *)((const uint8_t *)src->pixels + (size_t)y * (size_t)src->pitch);
+            for (int x = 0; x < w; x++) {
+                cur[x * 3]     = (uint8_t)(px[x] >> 16);
+                cur[x * 3 + 1] = (uint8_t)(px[x] >> 8);
+                cur[x * 3 + 2] = (uint8_t)px[x];
+            }
+            /* 挑一个让这一行“最接近 0”的过滤器 */
+            uint8_t *dst = raw + (size_t)y * (row + 1);
+            long best_score = -1;
+            for (int f = 0; f < 5; f++) {
+                filter_row(f, cur, prev, row, trial);
+                long score = 0;
+                for (size_t i = 0; i < row; i++) score += abs((int)(int8_t)trial[i]);
+                if (best_score < 0 || score < best_score) {
+                    best_score = score;
+                    dst[0] = (uint8_t)f;
+                    memcpy(dst + 1, trial, row);
+                }
+            }
+            uint8_t *t = prev;
+            prev = cur;
+            cur = t;
+        }
+        if (SDL_MUSTLOCK(src)) SDL_UnlockSurface(src);
+    }
+
+    size_t z_len = ok ? zlib_compress(raw, raw_len, z) : 0;
+    ok = ok && z_len > 0;
+
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *fp = ok ? fopen(tmp, "wb") : NULL;
+    if (ok && fp) {
+        static const uint8_t SIG[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        uint8_t ihdr[13];
+        put_u32be(ihdr, (uint32_t)w);
+        put_u32be(ihdr + 4, (uint32_t)h);
+        ihdr[8] = 8;     // 每通道 8 位
+        ihdr[9] = 2;     // RGB
+        ihdr[10] = 0;    // deflate
+        ihdr[11] = 0;    // 按行过滤
+        ihdr[12] = 0;    // 不隔行
+        ok = fwrite(SIG, 1, 8, fp) == 8 &&
+             write_chunk(fp, "IHDR", ihdr, sizeof(ihdr)) &&
+             write_chunk(fp, "IDAT", z, z_len) &&
+             write_chunk(fp, "IEND", NULL, 0);
+        if (fclose(fp) != 0) ok = 0;
+    } else {
+        ok = 0;
+    }
+
+    free(raw);
+    free(lines);
+    free(trial);
+    free(z);
+    if (src != img) SDL_FreeSurface(src);
+
+    if (!ok) {
+        remove(tmp);
+        return 0;
+    }
+    remove(path);
+    if (rename(tmp, path) != 0) {
+        remove(tmp);
+        return 0;
+    }
+    return 1;
+}
+
+/* 扩展名（不区分大小写）是不是 ext */
+static int has_ext(const char *path, const char *ext)
+{
+    size_t n = strlen(path), m = strlen(ext);
+    if (n < m) return 0;
+    for (size_t i = 0; i < m; i++) {
+        char c = path[n - m + i];
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if (c != ext[i]) return 0;
+    }
+    return 1;
+}
+
+int boardimg_save(SDL_Surface *img, const char *path)
+{
+    if (!img || !path) return 0;
+    if (has_ext(path, ".bmp")) return SDL_SaveBMP(img, path) == 0;
+    return boardimg_save_png(img, path);
+}
@@ -0,0 +1,135 @@
+/*
+ * crc32c.c
+ * CRC32C：硬件指令 + 查表两种实现，结果完全一致。
+ */
+
+#include "crc32c.h"
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/* 反射形式的 Castagnoli 多项式 */
+#define CRC32C_POLY 0x82F63B78u
+
+/* 查表法用的 8 张表：g_table[k][b] = 字节 b 后面再跟 k 个 0 字节的 CRC。
+ * 第一次用到时才建；recordtool verify 会在很多线程里同时算 CRC，
+ * 所以用系统的“只执行一次”原语来建（同时进来的线程会等它建完，建好的表对它们都可见） */
+static uint32_t g_table[8][256];
+#ifdef _WIN32
+static INIT_ONCE g_table_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t g_table_once = PTHREAD_ONCE_INIT;
+#endif
+
+static void build_table(void)
+{
+    for (int b = 0; b < 256; b++) {
+        uint32_t c = (uint32_t)b;
+        for (int k = 0; k < 8; k++) c = (c >> 1) ^ ((c & 1) ? CRC32C_POLY : 0);
+        g_table[0][b] = c;
+    }
+    for (int b = 0; b < 256; b++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t c = g_table[k - 1][b];
+            g_table[k][b] = (c >> 8) ^ g_table[0][c & 0xFF];
+        }
+    }
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK build_table_once(PINIT_ONCE once, PVOID param, PVOID *ctx)
+{
+    (void)once; (void)param; (void)ctx;
+    build_table();
+    return TRUE;
+}
+#endif
+
+static void ensure_table(void)
+{
+#ifdef _WIN32
+    InitOnceExecuteOnce(&g_table_once, build_table_once, NULL, NULL);
+#else
+    pthread_once(&g_table_once, build_table);
+#endif
+}
+
+static uint32_t crc32c_sw(uint32_t crc, const uint8_t *p, size_t n)
+{
+    ensure_table();
+    while (n >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;   // 小端机器（x86 / ARM 都是）
+        crc = g_table[7][lo & 0xFF] ^ g_table[6][(lo >> 8) & 0xFF] ^
+              g_table[5][(lo >> 16) & 0xFF] ^ g_table[4][lo >> 24] ^
+              g_table[3][hi & 0xFF] ^ g_table[2][(hi >> 8) & 0xFF] ^
+              g_table[1][(hi >> 16) & 0xFF] ^ g_table[0][hi >> 24];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = (crc >> 8) ^ g_table[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_HAVE_HW 1
+#include <nmmintrin.h>
+
+/* 只给这一个函数开 SSE4.2，其余代码照常编译，老 CPU 上不会碰到这些指令 */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, size_t n)
+{
+#if defined(__x86_64__)
+    uint64_t c = crc;
+    while (n >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+        p += 8;
+        n -= 8;
+    }
+    crc = (uint32_t)c;
+#endif
+    while (n >= 4) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        n -= 4;
+    }
+    while (n--) crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+/* -1 = 还没检测，之后是 0 / 1 */
+static int g_hw = -1;
+
+int crc32c_hw_available(void)
+{
+    if (g_hw < 0) {
+        __builtin_cpu_init();
+        g_hw = __builtin_cpu_supports("sse4.2") ? 1 : 0;
+    }
+    return g_hw;
+}
+#else
+int crc32c_hw_available(void)
+{
+    return 0;
+}
+#endif
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t n)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+#ifdef CRC32C_HAVE_HW
+    if (crc32c_hw_available()) return ~crc32c_hw(crc, p, n);
+#endif
+    return ~crc32c_sw(crc, p, n);
+}
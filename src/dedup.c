@@ -0,0 +1,214 @@
+/*
+ * dedup.c
+ * 对局哈希集合：只追加的日志 + 内存里的开放寻址哈希表。
+ */
+
+#include "dedup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+static const char *HASH_LOG = "liu/data/hashes.bin";
+
+/* 日志里一项的字节数 */
+#define ENTRY_SIZE 12
+
+/* 哈希表：key = 0 表示空位（真实哈希为 0 时会被换成 1，见 fileio.c 的 record_hash） */
+typedef struct {
+    uint64_t key;
+    int      refs;
+} Slot;
+
+static Slot  *g_slots = NULL;
+static size_t g_cap = 0;        // 2 的幂
+static size_t g_used = 0;
+static long   g_log_off = 0;    // 日志已经读到哪里
+
+static Slot *lookup(uint64_t h)
+{
+    if (!g_slots) return NULL;
+    size_t mask = g_cap - 1;
+    size_t i = (size_t)(h ^ (h >> 29)) & mask;
+    while (g_slots[i].key != 0) {
+        if (g_slots[i].key == h) return &g_slots[i];
+        i = (i + 1) & mask;
+    }
+    return &g_slots[i];   // 空位：调用者决定要不要占用
+}
+
+static int grow(void)
+{
+    size_t ncap = g_cap ? g_cap * 2 : 1024;
+    Slot *old = g_slots;
+    size_t old_cap = g_cap;
+    g_slots = (Slot *)calloc(ncap, sizeof(Slot));
+    if (!g_slots) {
+        g_slots = old;
+        return 0;
+    }
+    g_cap = ncap;
+    g_used = 0;
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old[i].key == 0) continue;
+        Slot *s = lookup(old[i].key);
+        *s = old[i];
+        g_used++;
+    }
+    free(old);
+    return 1;
+}
+
+/* 只改内存表 */
+static void apply(uint64_t h, int delta)
+{
+    if (h == 0) return;
+    if ((g_used + 1) * 10 >= g_cap * 7 && !grow()) return;   // 装载率超过 70% 就扩容
+    Slot *s = lookup(h);
+    if (s->key == 0) {
+        s->key = h;
+        s->refs = 0;
+        g_used++;
+    }
+    s->refs += delta;
+    if (s->refs < 0) s->refs = 0;
+}
+
+static void clear_table(void)
+{
+    if (g_slots) memset(g_slots, 0, g_cap * sizeof(Slot));
+    g_used = 0;
+    g_log_off = 0;
+}
+
+int dedup_sync(void)
+{
+    struct stat st;
+    if (stat(HASH_LOG, &st) != 0) {
+        clear_table();
+        return 0;
+    }
+    /* 文件变短了：被别的进程清空过，从头再读 */
+    if ((long)st.st_size < g_log_off) clear_table();
+    if ((long)st.st_size == g_log_off) return 1;
+
+    FILE *fp = fopen(HASH_LOG, "rb");
+    if (!fp) return 1;
+    if (fseek(fp, g_log_off, SEEK_SET) != 0) {
+        fclose(fp);
+        return 1;
+    }
+    uint8_t buf[ENTRY_SIZE * 256];
+    size_t got;
+    while ((got = fread(buf, 1, sizeof(buf), fp)) >= ENTRY_SIZE) {
+        size_t whole = got - got % ENTRY_SIZE;
+        for (size_t i = 0; i < whole; i += ENTRY_SIZE) {
+            uint64_t h = 0;
+            uint32_t d = 0;
+            for (int k = 7; k >= 0; k--) h = (h << 8) | buf[i + k];
+            for (int k = 3; k >= 0; k--) d = (d << 8) | buf[i + 8 + k];
+            apply(h, (int32_t)d);
+        }
+        g_log_off += (long)whole;
+        /* 末尾半项（别的进程写到一半？单次 write 不会，但防一手）：下次再读 */
+        if (whole != got) break;
+    }
+    fclose(fp);
+    return 1;
+}
+
+int dedup_refs(uint64_t h)
+{
+    Slot *s = (h != 0) ? lookup(h) : NULL;
+    return (s && s->key == h) ? s->refs : 0;
+}
+
+int dedup_add(uint64_t h, int delta)
+{
+    if (h == 0 || delta == 0) return 1;
+    uint8_t e[ENTRY_SIZE];
+    for (int k = 0; k < 8; k++) e[k] = (uint8_t)(h >> (8 * k));
+    for (int k = 0; k < 4; k++) e[8 + k] = (uint8_t)((uint32_t)delta >> (8 * k));
+
+    int fd = open(HASH_LOG, O_WRONLY | O_CREAT | O_APPEND | O_BINARY, 0644);
+    if (fd < 0) return 0;
+    int ok = write(fd, e, ENTRY_SIZE) == ENTRY_SIZE;
+    close(fd);
+    if (!ok) return 0;
+
+    /* 锁在 store 手里，这期间没人能往日志里插别的项，直接把读位置往后挪 */
+    apply(h, delta);
+    g_log_off += ENTRY_SIZE;
+    return 1;
+}
+
+void dedup_reset(int create)
+{
+    remove(HASH_LOG);
+    clear_table();
+    if (create) {
+        FILE *fp = fopen(HASH_LOG, "wb");
+        if (fp) fclose(fp);
+    }
+}
+
+static int cmp_ref(const void *a, const void *b)
+{
+    uint64_t x = ((const DedupRef *)a)->hash, y = ((const DedupRef *)b)->hash;
+    return (x > y) - (x < y);
+}
+
+int dedup_export(DedupRef **out)
+{
+    *out = NULL;
+    DedupRef *refs = (DedupRef *)malloc((g_used ? g_used : 1) * sizeof(DedupRef));
+    if (!refs) return -1;
+    int n = 0;
+    for (size_t i = 0; i < g_cap; i++) {
+        if (g_slots[i].key == 0 || g_slots[i].refs <= 0) continue;
+        refs[n].hash = g_slots[i].key;
+        refs[n].refs = g_slots[i].refs;
+        n++;
+    }
+    qsort(refs, (size_t)n, sizeof(DedupRef), cmp_ref);
+    *out = refs;
+    return n;
+}
+
+DedupRef *dedup_find(DedupRef *refs, int n, uint64_t h)
+{
+    DedupRef key;
+    key.hash = h;
+    key.refs = 0;
+    return (refs && n > 0) ? (DedupRef *)bsearch(&key, refs, (size_t)n, sizeof(DedupRef), cmp_ref) : NULL;
+}
+
+uint64_t dedup_line_hash(const char *line, size_t len)
+{
+    /* 行尾固定是 ,"h":"<16 位十六进制>","crc":"<8 位>"}，直接从末尾按偏移找 */
+    static const char TAIL_H[] = ",\"h\":\"";
+    const size_t TAIL_LEN = 6 + 16 + 1 + 8 + 8 + 2;
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) len--;
+    if (len < TAIL_LEN) return 0;
+    const char *p = line + len - TAIL_LEN;
+    if (memcmp(p, TAIL_H, 6) != 0) return 0;
+    p += 6;
+    uint64_t h = 0;
+    for (int i = 0; i < 16; i++) {
+        char ch = p[i];
+        int v = (ch >= '0' && ch <= '9') ? ch - '0' : (ch >= 'a' && ch <= 'f') ? ch - 'a' + 10 : -1;
+        if (v < 0) return 0;
+        h = (h << 4) | (uint64_t)v;
+    }
+    return h;
+}
@@ -3,52 +3,103 @@
  *
  * 提供简单的记录保存与读取功能。
  * 数据格式为 NDJSON，每行一个 JSON 对象，包含时间、胜者、以及每一步的行列与落子方。
+ * 记录具体存在哪个段文件里由 store.c 负责，这里只管一行 JSON 的读写。
  */
 
 #include "fileio.h"
+#include "store.h"
+#include "crc32c.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <sys/stat.h>
 
-/* 记录文件路径 */
-static const char *RECORD_FILE = "liu/data/records.json";
+/* 规范化落子序列的哈希（FNV-1a 64）：每手按 (落子方, 行, 列) 三个字节依次喂进去，
+ * 和时间、悔棋次数无关，同一盘棋不管什么时候存的哈希都一样。0 留给“没有哈希” */
+uint64_t record_hash(const GameState *game)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (int i = 0; i < game->moves_count; i++) {
+        const Move *m = &game->moves[i];
+        uint8_t b[3] = {(uint8_t)m->player, (uint8_t)m->row, (uint8_t)m->col};
+        for (int k = 0; k < 3; k++) {
+            h ^= b[k];
+            h *= 1099511628211ULL;
+        }
+    }
+    return h ? h : 1;
+}
 
-/* 确保 data 目录存在（如果不存在则创建）；- stat() : 来自 <sys/stat.h>，检查文件或目录是否存在 */
-static void ensure_data_dir(void)
+/* 把一局对局序列化成一行 JSON（带换行），返回 malloc 的缓冲区，长度写到 *out_len */
+char *record_to_json(const GameState *game, const char *timestr, int mode, int dur, size_t *out_len)
 {
-    struct stat st;
-    // 先检查并创建 liu 目录
-    if (stat("liu", &st) != 0) {
-        #ifdef _WIN32
-        mkdir("liu");
-        #else
-        mkdir("liu", 0755);
-        #endif
+    /* 每步最多 {"p":1,"r":18,"c":18}, 共 22 字节，头部和尾部的 h/crc 字段给 192 字节足够 */
+    size_t cap = 192 + (size_t)game->moves_count * 24;
+    char *buf = (char *)malloc(cap);
+    if (!buf) return NULL;
+
+    /* 写入 JSON 对象（每局一行，方便追加/删除）
+     * 说明：undo / mode / dur 字段是后来加的，旧记录里可能没有；读的时候要能兼容。
+     */
+    size_t n = (size_t)snprintf(buf, cap, "{\"time\":\"%s\",\"winner\":%d,\"undo\":%d,\"mode\":%d,\"dur\":%d,\"moves\":[",
+                                timestr, game->winner, game->undo_count, mode, dur);
+    for (int i = 0; i < game->moves_count; i++) {
+        const Move *m = &game->moves[i];
+        n += (size_t)snprintf(buf + n, cap - n, "{\"p\":%d,\"r\":%d,\"c\":%d}%s",
+                              m->player, m->row, m->col,
+                              (i != game->moves_count - 1) ? "," : "");
     }
-    // 再检查并创建 liu/data 目录
-    if (stat("liu/data", &st) != 0) {
-        #ifdef _WIN32
-        mkdir("liu\\data");  // Windows 使用反斜杠，但也可以使用正斜杠
-        #else
-        mkdir("liu/data", 0755);
-        #endif
+    /* 落子序列的哈希：存档靠它去重（见 dedup.h），固定 16 位十六进制 */
+    uint64_t h = record_hash(game);
+    n += (size_t)snprintf(buf + n, cap - n, "],\"h\":\"%08x%08x\"",
+                          (unsigned)(h >> 32), (unsigned)(h & 0xFFFFFFFFu));
+    /* 最后一个字段是前面所有字节的 CRC32C，固定 8 位十六进制，读的时候从行尾直接定位 */
+    n += (size_t)snprintf(buf + n, cap - n, ",\"crc\":\"%08x\"}\n", (unsigned)crc32c(0, buf, n));
+    *out_len = n;
+    return buf;
+}
+
+/* 行尾校验字段 ,"crc":"xxxxxxxx" 的长度（不含最后的 '}'） */
+#define CRC_FIELD_LEN 17
+
+int record_check(const char *line, size_t len)
+{
+    if (!line) return RECORD_CORRUPT;
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) len--;
+    if (len == 0 || line[len - 1] != '}') return RECORD_CORRUPT;
+    if (len < CRC_FIELD_LEN + 1 || memcmp(line + len - 1 - CRC_FIELD_LEN, ",\"crc\":\"", 8) != 0) {
+        return RECORD_NO_CRC;   // 加校验之前存下的老记录
     }
+
+    const char *hex = line + len - 1 - CRC_FIELD_LEN + 8;
+    uint32_t want = 0;
+    for (int i = 0; i < 8; i++) {
+        char ch = hex[i];
+        int v = (ch >= '0' && ch <= '9') ? ch - '0' : (ch >= 'a' && ch <= 'f') ? ch - 'a' + 10 : -1;
+        if (v < 0) return RECORD_CORRUPT;
+        want = (want << 4) | (uint32_t)v;
+    }
+    if (hex[8] != '"') return RECORD_CORRUPT;
+    return crc32c(0, line, len - 1 - CRC_FIELD_LEN) == want ? RECORD_OK : RECORD_CORRUPT;
+}
+
+/* 坏记录原样追加到 liu/data/quarantine.json，留着人工查看；调用者随后把它从存档里删掉（recordtool verify -q） */
+void quarantine_record(const char *line)
+{
+    FILE *fp = fopen("liu/data/quarantine.json", "a");
+    if (!fp) return;
+    size_t n = strlen(line);
+    fwrite(line, 1, n, fp);
+    if (n == 0 || line[n - 1] != '\n') fputc('\n', fp);
+    fclose(fp);
 }
 
-/* 保存游戏记录到文件；- fopen()  : 打开文件（"a" 模式表示追加写入，在文件末尾添加内容） */
-int save_record(const GameState *game)
+/* 保存游戏记录：序列化成一行，交给 store 追加到活动段；顺手把这一局计进统计 */
+int save_record(const GameState *game, int mode, int elapsed_seconds)
 {
     if (!game) return 0;
-    ensure_data_dir();
-    FILE *fp = fopen(RECORD_FILE, "a");
-    if (!fp) {
-        // 输出错误信息到控制台，方便调试
-        fprintf(stderr, "错误：无法打开文件 %s 进行写入\n", RECORD_FILE);
-        perror("fopen records.json");
-        return 0;
-    }
     /* 时间戳字符串 */
     char timestr[32];
     time_t now = time(NULL);
@@ -58,77 +109,85 @@ int save_record(const GameState *game)
     } else {
         strcpy(timestr, "unknown");
     }
-    /* 写入 JSON 对象（每局一行，方便追加/删除）
-     * 说明：undo 字段是后来加的，旧记录里可能没有；读的时候要能兼容。
-     */
-    fprintf(fp, "{\"time\":\"%s\",\"winner\":%d,\"undo\":%d,\"moves\":[",
-            timestr, game->winner, game->undo_count);
-    for (int i = 0; i < game->moves_count; i++) {
-        const Move *m = &game->moves[i];
-        fprintf(fp, "{\"p\":%d,\"r\":%d,\"c\":%d}", m->player, m->row, m->col);
-        if (i != game->moves_count - 1) {
-            fputc(',', fp);
-        }
-    }
-    fprintf(fp, "]}\n");
-    fclose(fp);
-    return 1;
+    if (elapsed_seconds < 0) elapsed_seconds = 0;
+
+    size_t len = 0;
+    char *line = record_to_json(game, timestr, mode, elapsed_seconds, &len);
+    if (!line) return 0;
+    int ok = store_append_line(line, len, timestr);
+    free(line);
+    /* 统计按“下了多少盘”算，重复的棋局（去重后不新增行）也照样计一盘 */
+    if (ok) stats_add(mode, timestr, game->winner, game->moves_count, elapsed_seconds);
+    return ok;
 }
 
-/* 计算记录条数（统计文件中有多少条对局记录）；- fopen() : 打开文件（"r" 模式表示只读） */
+/* 计算记录条数：各段条数都记在 manifest 里，不用再逐字节数换行 */
 int record_count(void)
 {
-    FILE *fp = fopen(RECORD_FILE, "r");
-    if (!fp) return 0;
-
-    int count = 0;
-    int ch;
-    int saw_any = 0;
-
-    while ((ch = fgetc(fp)) != EOF) {
-        saw_any = 1;
-        if (ch == '\n') {
-            count++;
-        }
-    }
+    return store_count();
+}
 
-    /* 保险：文件有内容但末尾没换行 */
-    if (saw_any && count == 0) {
-        count = 1;
+/* 读一个十进制整数（允许前导空白和负号），读完把 *pp 移到数字后面；没有数字返回 0 */
+static int scan_int(const char **pp, int *out)
+{
+    const char *p = *pp;
+    while (*p == ' ' || *p == '\t') p++;
+    int neg = 0;
+    if (*p == '-') {
+        neg = 1;
+        p++;
     }
+    if (*p < '0' || *p > '9') return 0;
+    int v = 0;
+    while (*p >= '0' && *p <= '9' && v < 100000000) v = v * 10 + (*p++ - '0');
+    *out = neg ? -v : v;
+    *pp = p;
+    return 1;
+}
 
-    fclose(fp);
-    return count;
+/* 按 {"p":%d,"r":%d,"c":%d} 读一步。以前用 sscanf，一步就要几百纳秒，
+ * 回放校验、统计重建这种整存档扫描时它是大头，所以手写 */
+static int scan_move(const char **pp, int *player, int *row, int *col)
+{
+    const char *p = *pp;
+    if (strncmp(p, "{\"p\":", 5) != 0) return 0;
+    p += 5;
+    if (!scan_int(&p, player)) return 0;
+    if (strncmp(p, ",\"r\":", 5) != 0) return 0;
+    p += 5;
+    if (!scan_int(&p, row)) return 0;
+    if (strncmp(p, ",\"c\":", 5) != 0) return 0;
+    p += 5;
+    if (!scan_int(&p, col)) return 0;
+    if (*p != '}') return 0;
+    *pp = p + 1;
+    return 1;
 }
 
 /* 解析一行 JSON 中的 moves 数组并填充游戏状态；- strstr() : 来自 <string.h>，在字符串中查找子串（如查找 "\"moves\":["） */
-static void parse_moves(const char *line, GameState *game)
+static int parse_moves(const char *line, GameState *game)
 {
     const char *p = strstr(line, "\"moves\":[");
-    if (!p) return;
+    if (!p) return 0;
     p = strchr(p, '[');
-    if (!p) return;
+    if (!p) return 0;
     p++; /* skip '[' */
     init_game(game);
     /* 读取数组中的对象 */
     while (*p && *p != ']') {
         int player = 0, row = 0, col = 0;
         /* 找到数字 */
-        if (sscanf(p, "{\"p\":%d,\"r\":%d,\"c\":%d}", &player, &row, &col) == 3) {
-            if (within_board(row, col)) {
-                game->cells[row][col] = (player == 1 ? CELL_BLACK : CELL_WHITE);
-                if (game->moves_count < BOARD_SIZE * BOARD_SIZE) {
-                    Move *m = &game->moves[game->moves_count];
-                    game->moves_count++;
-                    m->player = player;
-                    m->row = row;
-                    m->col = col;
-                }
+        if (scan_move(&p, &player, &row, &col)) {
+            /* 落子方只能是 1/2、坐标必须在棋盘内；以前 p 是别的值会被悄悄当成白棋 */
+            if ((player != 1 && player != 2) || !within_board(row, col)) return 0;
+            game->cells[row][col] = (player == 1 ? CELL_BLACK : CELL_WHITE);
+            if (game->moves_count < BOARD_SIZE * BOARD_SIZE) {
+                Move *m = &game->moves[game->moves_count];
+                game->moves_count++;
+                m->player = player;
+                m->row = row;
+                m->col = col;
             }
-            /* 移动到下一个 } */
-            p = strchr(p, '}');
-            if (!p) break;
-            p++;
             /* 跳过逗号 */
             if (*p == ',') p++;
         } else {
@@ -157,95 +216,56 @@ static void parse_moves(const char *line, GameState *game)
     } else {
         game->current_player = 2;
     }
+    return 1;
+}
+
+/* 解析一整行记录：对局内容 + 时间戳。没有 moves 数组的行当作坏行，返回 0 */
+int record_from_json(const char *line, GameRecord *rec)
+{
+    if (!line || !rec) return 0;
+    if (record_check(line, strlen(line)) == RECORD_CORRUPT) return 0;
+    if (!parse_moves(line, &rec->game)) return 0;
+
+    rec->time[0] = '\0';
+    const char *t = strstr(line, "\"time\":\"");
+    if (t) sscanf(t + 8, "%19[^\"]", rec->time);
+    /* 老记录没有 mode / dur，按 0（未知）处理 */
+    rec->mode = 0;
+    rec->dur = 0;
+    const char *m = strstr(line, "\"mode\":");
+    if (m) sscanf(m + 7, "%d", &rec->mode);
+    const char *d = strstr(line, "\"dur\":");
+    if (d) sscanf(d + 6, "%d", &rec->dur);
+    return 1;
 }
 
-/* 按索引读取历史记录到游戏状态；- fopen()  : 打开文件（"r" 模式表示只读） */
+/* 按索引读取历史记录到游戏状态；store 先用 manifest 定位到段，再只读那一段 */
 int load_record(int index, GameState *game)
 {
     if (!game) return 0;
-    FILE *fp = fopen(RECORD_FILE, "r");
-    if (!fp) return 0;
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t read;
-    int current = 0;
-    int found = 0;
-    while ((read = getline(&line, &len, fp)) != -1) {
-        if (current == index) {
-            /* 解析这一行 */
-            parse_moves(line, game);
-            found = 1;
-            break;
-        }
-        current++;
+    char *line = store_read_line(index);
+    if (!line) return 0;
+    /* 读到时才校验（懒校验）：校验失败或内容非法的记录不返回给调用者。
+     * 这里只报告、不动存档（点几次就会复制几份）；移进隔离区由 recordtool verify -q 一次做完 */
+    int ok = record_check(line, strlen(line)) != RECORD_CORRUPT && parse_moves(line, game);
+    if (!ok) {
+        fprintf(stderr, "警告：第 %d 条记录已损坏，跳过（recordtool verify -q 可以把它移到 quarantine.json）\n", index + 1);
     }
-    if (line) free(line);
-    fclose(fp);
-    return found;
+    free(line);
+    return ok;
 }
 
-/* 删除指定编号的一条记录（0 开始）。
- * 做法：把 records.json 逐行读出来，除了 index 这行，其他写到临时文件；
- * 最后用临时文件替换原文件。
- */
+/* 删除指定编号的一条记录（0 开始）：只重写它所在的那个段 */
 int delete_record(int index)
 {
     if (index < 0) return 0;
-
-    FILE *in = fopen(RECORD_FILE, "r");
-    if (!in) return 0;
-
-    /* 临时文件放在同目录，避免跨盘 rename 的坑 */
-    const char *tmp = "liu/data/records.tmp";
-    FILE *out = fopen(tmp, "w");
-    if (!out) {
-        fclose(in);
-        return 0;
-    }
-
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t read;
-    int cur = 0;
-    int removed = 0;
-
-    while ((read = getline(&line, &len, in)) != -1) {
-        if (cur == index) {
-            removed = 1;
-        } else {
-            fputs(line, out);
-        }
-        cur++;
-    }
-
-    if (line) free(line);
-    fclose(in);
-    fclose(out);
-
-    if (!removed) {
-        /* 没找到这条，临时文件删掉就行 */
-        remove(tmp);
-        return 0;
-    }
-
-    /* 替换原文件 */
-    remove(RECORD_FILE);
-    if (rename(tmp, RECORD_FILE) != 0) {
-        /* 失败就尽量恢复（别把用户的数据整没了） */
-        return 0;
-    }
-
-    return 1;
+    return store_delete(index);
 }
 
-/* 清空所有记录：直接把 records.json 截断为 0 字节 */
+/* 清空所有记录：段文件、索引、manifest 一起删掉 */
 int clear_records(void)
 {
-    ensure_data_dir();
-    FILE *fp = fopen(RECORD_FILE, "w");
-    if (!fp) return 0;
-    fclose(fp);
-    return 1;
+    return store_clear();
 }
 
 /* ======= 断点续玩：中途退出时存一份“当前这盘”的状态 ======= */
@@ -272,7 +292,7 @@ int clear_resume_game(void)
 int save_resume_game(const GameState *game, int mode, int elapsed_seconds)
 {
     if (!game) return 0;
-    ensure_data_dir();
+    store_ensure_dir();
 
     FILE *fp = fopen(RESUME_FILE, "w");
     if (!fp) {
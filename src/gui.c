@@ -11,45 +11,45 @@
 #include <ctype.h>          // 为 toupper 函数补的头文件
 #include <string.h>
 #include <SDL2/SDL_ttf.h>   // 为 TTF_* 函数补的头文件
-
-/* 菜单/结束界面用的宋体字体，全局只维护这一份 */
+#include "textcache.h"
+#include "resource.h"
+#include "sprites.h"
+#include "batch.h"
+#include "perf.h"
+#include "layout.h"
+#include "heatmap.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* 菜单/结束界面用的宋体字体：由 resource.c 在启动时加载，这里只是借用句柄 */
 static TTF_Font *g_font_menu = NULL;
 
+/* 每个界面画之前调一次：窗口大小 / DPI 变了就重算布局（layout.c），字体按新的缩放重设字号 */
+static void sync_layout(SDL_Renderer *ren)
+{
+    if (layout_sync(ren)) res_set_font_scale(layout_get()->scale);
+}
+
 /* ========== 菜单背景图 ========== */
 /*
- * SDL2 自带的图片加载接口 SDL_LoadBMP() 只支持 BMP。
- * 你提供的是 image/yinghua.jpg，所以我额外生成了一份 bmp：
- *     image/menu_bg.bmp
- *
- * 这里用“懒加载”：第一次画菜单时才读文件并创建纹理，后续直接复用。
+ * 背景图由 resource.c 在启动时读进内存，纹理第一次画菜单时创建，之后一直复用。
  */
 static SDL_Texture *g_menu_bg_tex = NULL;
-static const char *MENU_BG_PATH = "image/menu_bg.bmp";
 
-/* 确保菜单背景纹理已加载好。加载失败时返回 0（菜单会退回纯色背景）。 */
+/* 确保菜单背景纹理已准备好。加载失败时返回 0（菜单会退回纯色背景）。 */
 static int ensure_menu_background(SDL_Renderer *ren)
 {
     if (!ren) return 0;
-    if (g_menu_bg_tex) return 1;
-
-    SDL_Surface *surf = SDL_LoadBMP(MENU_BG_PATH);
-    if (!surf) {
-        /* 这一步失败不致命：只是没背景图而已 */
-        fprintf(stderr, "SDL_LoadBMP(%s) error: %s\n", MENU_BG_PATH, SDL_GetError());
-        return 0;
-    }
-
-    g_menu_bg_tex = SDL_CreateTextureFromSurface(ren, surf);
-    SDL_FreeSurface(surf);
-    if (!g_menu_bg_tex) {
-        fprintf(stderr, "SDL_CreateTextureFromSurface error: %s\n", SDL_GetError());
-        return 0;
+    SDL_Texture *tex = res_texture(ren, RES_IMAGE_MENU_BG);
+    if (!tex) return 0;
+    if (tex != g_menu_bg_tex) {
+        /* 背景图别太“抢戏”：略微调透明，让按钮和文字更舒服 */
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureAlphaMod(tex, 220);
+        g_menu_bg_tex = tex;
     }
-
-    /* 背景图别太“抢戏”：略微调透明，让按钮和文字更舒服 */
-    SDL_SetTextureBlendMode(g_menu_bg_tex, SDL_BLENDMODE_BLEND);
-    SDL_SetTextureAlphaMod(g_menu_bg_tex, 220);
-
     return 1;
 }
 
@@ -58,7 +58,7 @@ static void draw_menu_background(SDL_Renderer *ren)
 {
     if (!ensure_menu_background(ren)) return;
 
-    SDL_Rect dst = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_Rect dst = ui_full();
     SDL_RenderCopy(ren, g_menu_bg_tex, NULL, &dst);
 }
 
@@ -66,7 +66,7 @@ static void draw_menu_background(SDL_Renderer *ren)
 static void draw_menu_fog(SDL_Renderer *ren, Uint8 alpha)
 {
     if (!ren) return;
-    SDL_Rect full = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_Rect full = ui_full();
     SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
     SDL_SetRenderDrawColor(ren, 255, 255, 255, alpha);
     SDL_RenderFillRect(ren, &full);
@@ -75,27 +75,15 @@ static void draw_menu_fog(SDL_Renderer *ren, Uint8 alpha)
 
 
 
-/* 保证字体已经初始化并加载；- TTF_WasInit() : SDL_ttf 库函数，检查 TTF 子系统是否已初始化 */
+/* 取菜单字体（进程里只打开一次，见 resource.h） */
 static int ensure_menu_font(void)
 {
-    if (!TTF_WasInit()) {
-        if (TTF_Init() != 0) {
-            fprintf(stderr, "TTF_Init error: %s\n", TTF_GetError());
-            return 0;
-        }
-    }
-    if (!g_font_menu) {
-        const char *path = "C:\\\\Windows\\\\Fonts\\\\simsun.ttc"; /* 注意双反斜杠 */
-        g_font_menu = TTF_OpenFont(path, 26);   /* 26 像素大小，你可以自己调 */
-        if (!g_font_menu) {
-            fprintf(stderr, "TTF_OpenFont error: %s\n", TTF_GetError());
-            return 0;
-        }
-    }
-    return 1;
+    if (!g_font_menu) g_font_menu = res_font(RES_FONT_MENU);
+    return g_font_menu != NULL;
 }
 
-/* 在给定矩形中居中绘制一行 UTF-8 文字；- TTF_RenderUTF8_Blended() : SDL_ttf 库函数，将 UTF-8 字符串渲染成带透明度的图像（Surface） */
+/* 在给定矩形中居中绘制一行 UTF-8 文字。
+ * 纹理从 textcache 取：同一个标签只在第一次画的时候光栅化、上传，之后每帧直接贴 */
 static void draw_menu_text_center(SDL_Renderer *ren,
                                   const SDL_Rect *rect,
                                   const char *utf8,
@@ -103,18 +91,9 @@ static void draw_menu_text_center(SDL_Renderer *ren,
 {
     if (!ensure_menu_font()) return;
 
-    SDL_Surface *surf = TTF_RenderUTF8_Blended(g_font_menu, utf8, color);
-    if (!surf) {
-        fprintf(stderr, "TTF_RenderUTF8_Blended error: %s\n", TTF_GetError());
-        return;
-    }
-    SDL_Texture *tex = SDL_CreateTextureFromSurface(ren, surf);
-    if (!tex) {
-        SDL_FreeSurface(surf);
-        return;
-    }
     int tw, th;
-    SDL_QueryTexture(tex, NULL, NULL, &tw, &th);
+    SDL_Texture *tex = textcache_get(ren, g_font_menu, res_font_size(RES_FONT_MENU), utf8, color, &tw, &th);
+    if (!tex) return;
 
     SDL_Rect dst;
     dst.w = tw;
@@ -123,21 +102,144 @@ static void draw_menu_text_center(SDL_Renderer *ren,
     dst.y = rect->y + (rect->h - th) / 2;
 
     SDL_RenderCopy(ren, tex, NULL, &dst);
-    SDL_DestroyTexture(tex);
-    SDL_FreeSurface(surf);
+    perf_count_draw(1);
+}
+
+/* 按钮的边框色：所有菜单统一用这一种淡紫 */
+static const SDL_Color BUTTON_BORDER = {90, 60, 80, 140};
+
+/* 画一组按钮的底色和边框：底色攒成一批纯色四边形，一次 RenderGeometry；边框同色，一次 DrawRects。
+ * 按钮互不重叠，所以先画完全部底色、再画边框、最后调用者再写字，和一个一个画出来一样。
+ * 半透明混合在这里打开、画完关掉 */
+static void draw_button_rects(SDL_Renderer *ren, const SDL_Rect *rects, const SDL_Color *fills, int n)
+{
+    static QuadBatch batch;   // 只在绘制线程里用；放栈上太大
+    if (!ren || n <= 0) return;
+
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
+    quad_batch_begin(&batch, NULL);
+    for (int i = 0; i < n; i++) quad_batch_add(ren, &batch, &rects[i], fills[i]);
+    quad_batch_flush(ren, &batch);
+
+    SDL_SetRenderDrawColor(ren, BUTTON_BORDER.r, BUTTON_BORDER.g, BUTTON_BORDER.b, BUTTON_BORDER.a);
+    SDL_RenderDrawRects(ren, rects, n);
+    perf_count_draw(1);
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+}
+
+
+
+/* 棋盘的位置和格距都在 layout.c 里按窗口大小算（见 layout.h 的 board_x / board_y / cell） */
+
+/* ========== 棋盘底图 ==========
+ * 背景色和网格线从来不变，画一次存进一张渲染目标纹理，之后每帧只贴这一张。
+ * 渲染目标的内容在某些情况下会丢（比如 Direct3D 设备重置、窗口大小变了），
+ * 收到 SDL_RENDER_TARGETS_RESET / SDL_RENDER_DEVICE_RESET 时标记一下，下一帧重画。
+ * 窗口大小变了（布局的 generation 变了）就按新尺寸重建一张。 */
+static SDL_Texture  *g_board_layer = NULL;
+static SDL_Renderer *g_board_layer_ren = NULL;
+static unsigned      g_board_layer_gen = 0;
+static SDL_atomic_t  g_board_layer_dirty;
+static SDL_atomic_t  g_hud_dirty;          // HUD 缓存（见下面“HUD 缓存”）也是渲染目标，一起标记
+static void hud_release(void);             // 定义在下面“HUD 缓存”里，gui_quit 要用
+static void thumbs_release(void);          // 定义在下面“回放菜单”里，gui_quit 要用
+
+/* 事件监视：可能在别的线程里调用，只设个标记 */
+static int board_layer_watch(void *userdata, SDL_Event *e)
+{
+    (void)userdata;
+    if (e->type == SDL_RENDER_TARGETS_RESET || e->type == SDL_RENDER_DEVICE_RESET) {
+        SDL_AtomicSet(&g_board_layer_dirty, 1);
+        SDL_AtomicSet(&g_hud_dirty, 1);
+        heatmap_lost();
+    }
+    return 1;
 }
 
+/* 直接往当前渲染目标上画背景和网格线 */
+static void draw_board_background(SDL_Renderer *ren)
+{
+    const Layout *l = layout_get();
+    int csize = l->cell;
+    /* 背景色：略带木纹色调 */
+    SDL_SetRenderDrawColor(ren, 240, 217, 181, 255);
+    SDL_RenderClear(ren);
 
+    /* 绘制网格线 */
+    SDL_SetRenderDrawColor(ren, 80, 60, 40, 255);
+    int x0 = l->board_x, y0 = l->board_y;
+    int x1 = x0 + csize * (BOARD_SIZE - 1);
+    int y1 = y0 + csize * (BOARD_SIZE - 1);
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        /* 横线 */
+        SDL_RenderDrawLine(ren, x0, y0 + i * csize, x1, y0 + i * csize);
+        /* 竖线 */
+        SDL_RenderDrawLine(ren, x0 + i * csize, y0, x0 + i * csize, y1);
+    }
+}
 
-/* 一些可调节的常量。
- * 窗口宽度和高度由 gui.h 定义的宏 WINDOW_WIDTH/WINDOW_HEIGHT 提供，
- * 这里不再定义独立的静态常量，以免与宏值不一致。BOARD_MARGIN 控制棋盘边缘留白。 */
-static const int BOARD_MARGIN = 40;
+static void release_board_layer(void)
+{
+    if (g_board_layer) SDL_DestroyTexture(g_board_layer);
+    g_board_layer = NULL;
+    g_board_layer_ren = NULL;
+}
 
-/* 计算每个格子的间距（像素）；无（只使用了基本的数学运算） */
-static int cell_size()
+/* 确保底图是好的（需要时重画）；不支持渲染目标时返回 0，调用者直接画 */
+static int ensure_board_layer(SDL_Renderer *ren)
 {
-    return (WINDOW_WIDTH - 2 * BOARD_MARGIN) / (BOARD_SIZE - 1);
+    const Layout *l = layout_get();
+    if (ren != g_board_layer_ren || l->generation != g_board_layer_gen) release_board_layer();
+    if (!g_board_layer) {
+        if (!SDL_RenderTargetSupported(ren)) return 0;
+        g_board_layer = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+                                          l->w, l->h);
+        if (!g_board_layer) return 0;
+        g_board_layer_ren = ren;
+        g_board_layer_gen = l->generation;
+        SDL_AtomicSet(&g_board_layer_dirty, 1);
+    }
+    if (SDL_AtomicSet(&g_board_layer_dirty, 0)) {
+        SDL_Texture *old = SDL_GetRenderTarget(ren);
+        if (SDL_SetRenderTarget(ren, g_board_layer) != 0) {
+            release_board_layer();
+            return 0;
+        }
+        draw_board_background(ren);
+        SDL_SetRenderTarget(ren, old);
+        perf_count_upload();
+    }
+    return 1;
+}
+
+/* ========== 落子动画 ==========
+ * 新落的一颗子淡入（顺带从略小放到正常大小），最后一手的红点跳两下。
+ * 只在“比上次画的时候正好多一手”时开始（悔棋、换局、回放拖进度条都不算），
+ * 播完最后一帧就停；动画期间由调用者按 gui_anim_next_frame 的时刻一帧一帧地重画，
+ * 平时棋盘不动就一帧都不画。 */
+#define ANIM_FADE_MS   160
+#define ANIM_PULSE_MS  700
+#define ANIM_FRAME_MS  16     // 没有垂直同步时自己限到约 60 帧
+
+static int    g_anim_count = -1;   // 上次画的时候棋盘上有几手
+static int    g_anim_active = 0;   // 有动画没播完（最后那一帧画完才清掉）
+static Uint32 g_anim_start = 0;    // 最新一手落下的时刻
+static Uint32 g_anim_frame = 0;    // 上一帧动画画出来的时刻
+static int    g_anim_skip = 0;     // 下一次 draw_game 直接画最终画面（gui_anim_finish）
+static int    g_vsync = 0;         // 渲染器是不是垂直同步的（Present 自己就会等）
+
+Uint32 gui_anim_next_frame(void)
+{
+    if (!g_anim_active) return 0;
+    /* 垂直同步时马上画，Present 会把节奏卡在刷新率上；否则自己隔一帧的时间 */
+    Uint32 t = g_vsync ? SDL_GetTicks() : g_anim_frame + ANIM_FRAME_MS;
+    return t ? t : 1;   // 0 表示“没有”
+}
+
+void gui_anim_finish(void)
+{
+    g_anim_active = 0;
+    g_anim_skip = 1;
 }
 
 /* SDL 窗口和渲染器初始化；- SDL_CreateWindow() : SDL 库函数，创建窗口 */
@@ -150,45 +252,55 @@ int gui_init(SDL_Window **win, SDL_Renderer **ren)
      * 调用者必须确保在调用此函数之前已经通过 SDL_Init 初始化了视频子系统。
      */
     if (!win || !ren) return 1;
+    /* 窗口可以拉大缩小、全屏；高 DPI 屏上按实际像素画（布局见 layout.h） */
     *win = SDL_CreateWindow("六子棋", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                             WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
+                             WINDOW_WIDTH, WINDOW_HEIGHT,
+                             SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
     if (!*win) {
         fprintf(stderr, "SDL_CreateWindow error: %s\n", SDL_GetError());
         return 1;
     }
-    *ren = SDL_CreateRenderer(*win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    SDL_SetWindowMinimumSize(*win, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2);
+    *ren = SDL_CreateRenderer(*win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
+    if (!*ren) {
+        /* 有的驱动不支持渲染目标：退一步，棋盘底图就每帧直接画 */
+        *ren = SDL_CreateRenderer(*win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    }
     if (!*ren) {
         fprintf(stderr, "SDL_CreateRenderer error: %s\n", SDL_GetError());
         SDL_DestroyWindow(*win);
         return 1;
     }
+    /* 落子动画的节奏：垂直同步的渲染器 Present 自己会等，不用再限帧 */
+    SDL_RendererInfo info;
+    g_vsync = (SDL_GetRendererInfo(*ren, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC));
+    /* 渲染目标内容丢失时让棋盘底图重画 */
+    SDL_AddEventWatch(board_layer_watch, NULL);
+    sync_layout(*ren);
     return 0;
 }
 
-/* 释放 SDL 和字体资源；- TTF_CloseFont() : SDL_ttf 库函数，关闭字体对象（释放字体资源） */
+/* 释放窗口和渲染器。字体和图片是整个进程共用的（resource.c），这里不关，
+ * 只把属于这个 renderer 的纹理清掉 */
 void gui_quit(SDL_Window *win, SDL_Renderer *ren)
 {
-    /* 先释放字体，再关 TTF 子系统 */
-    if (g_font_menu) {
-        TTF_CloseFont(g_font_menu);
-        g_font_menu = NULL;
-    }
-
-    /* 菜单背景图纹理也要手动释放（纹理属于 renderer 的资源） */
-    if (g_menu_bg_tex) {
-        SDL_DestroyTexture(g_menu_bg_tex);
-        g_menu_bg_tex = NULL;
-    }
-    if (TTF_WasInit()) {
-        TTF_Quit();
-    }
+    /* 缓存的文字纹理、背景纹理、棋子贴图、HUD 图集都属于 renderer，要在它之前销毁 */
+    textcache_clear();
+    res_release_textures();
+    sprites_release();
+    release_board_layer();
+    hud_release();
+    thumbs_release();
+    heatmap_release();
+    SDL_DelEventWatch(board_layer_watch, NULL);
+    g_menu_bg_tex = NULL;
 
     if (ren) SDL_DestroyRenderer(ren);
     if (win) SDL_DestroyWindow(win);
 }
 
 
-/* 绘制填充圆（实心圆）；- sqrt() : 来自 <math.h>，计算平方根（用于计算圆的半径） */
+/* 绘制填充圆（实心圆）；只剩计分板上两个小图标在用，棋子用的是 sprites.c 的贴图 */
 static void draw_filled_circle(SDL_Renderer *ren, int cx, int cy, int r, SDL_Color color)
 {
     SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, color.a);
@@ -196,68 +308,139 @@ static void draw_filled_circle(SDL_Renderer *ren, int cx, int cy, int r, SDL_Col
         int dx_max = (int)sqrt((double)r * r - dy * dy);
         SDL_RenderDrawLine(ren, cx - dx_max, cy + dy, cx + dx_max, cy + dy);
     }
+    perf_count_draw(2 * r + 1);
 }
 
 /* 绘制棋盘和棋子；- SDL_SetRenderDrawColor() : SDL 库函数，设置绘制颜色 */
 void draw_game(SDL_Renderer *ren, const GameState *game)
 {
     if (!ren || !game) return;
-    int csize = cell_size();
-    /* 背景色：略带木纹色调 */
-    SDL_SetRenderDrawColor(ren, 240, 217, 181, 255);
-    SDL_RenderClear(ren);
+    sync_layout(ren);
+    const Layout *l = layout_get();
+    int csize = l->cell;
+
+    /* 背景和网格线：贴缓存好的底图，一次 RenderCopy */
+    if (ensure_board_layer(ren)) {
+        SDL_RenderCopy(ren, g_board_layer, NULL, NULL);
+        perf_count_draw(1);
+    } else {
+        draw_board_background(ren);
+        perf_count_draw(1 + 2 * BOARD_SIZE);
+    }
 
-    /* 绘制网格线 */
-    SDL_SetRenderDrawColor(ren, 80, 60, 40, 255);
-    int start = BOARD_MARGIN;
-    int end   = BOARD_MARGIN + csize * (BOARD_SIZE - 1);
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        int pos = start + i * csize;
-        /* 横线 */
-        SDL_RenderDrawLine(ren, start, pos, end, pos);
-        /* 竖线 */
-        SDL_RenderDrawLine(ren, pos, start, pos, end);
+    /* 估值热力图（按 H 开关）：一张 BOARD_SIZE 见方的纹理，一个像素对应一个交叉点，
+     * 放大到整个棋盘一次贴上去，压在棋子下面 */
+    if (heatmap_enabled()) {
+        SDL_Rect heat = {l->board_x - csize / 2, l->board_y - csize / 2,
+                         BOARD_SIZE * csize, BOARD_SIZE * csize};
+        heatmap_draw(ren, game, &heat);
     }
 
-    /* 绘制棋子 */
-    int radius = csize / 2 - 2;
+    /* 动画进度：age 是最新一手落下以后过了多久（毫秒），没有动画时当作早就播完了 */
+    Uint32 now = SDL_GetTicks();
+    if (game->moves_count != g_anim_count) {
+        g_anim_active = (game->moves_count == g_anim_count + 1 && !g_anim_skip);
+        g_anim_start = now;
+        g_anim_count = game->moves_count;
+    }
+    g_anim_skip = 0;
+    Uint32 age = g_anim_active ? now - g_anim_start : ANIM_PULSE_MS;
+    if (age >= ANIM_PULSE_MS) g_anim_active = 0;   // 这一帧就是最终画面
+    g_anim_frame = now;
+    int fading = (age < ANIM_FADE_MS && game->moves_count > 0);
+    Move newest = {0, 0, 0};
+    if (fading) newest = game->moves[game->moves_count - 1];
+
+    /* 绘制棋子：贴图只在第一次用到时光栅化（带抗锯齿）。
+     * 黑子、白子各攒成一批四边形，整盘棋子两次 RenderGeometry 画完（棋子互不重叠，先黑后白没关系） */
+    int radius = csize / 2 - ui_px(2);
+    if (radius < 1) radius = 1;
+    SDL_Texture *stone_tex[2] = {
+        sprite_get(ren, SPRITE_BLACK, radius),
+        sprite_get(ren, SPRITE_WHITE, radius),
+    };
+    static QuadBatch stones[2];   // 只在绘制线程里用；放栈上太大
+    quad_batch_begin(&stones[0], stone_tex[0]);
+    quad_batch_begin(&stones[1], stone_tex[1]);
+    SDL_Color opaque = {255, 255, 255, 255};
     for (int r = 0; r < BOARD_SIZE; r++) {
         for (int c = 0; c < BOARD_SIZE; c++) {
             if (game->cells[r][c] != CELL_EMPTY) {
-                int cx = start + c * csize;
-                int cy = start + r * csize;
-                SDL_Color col;
-                if (game->cells[r][c] == CELL_BLACK) {
-                    col.r = 20; col.g = 20; col.b = 20; col.a = 255;
+                if (fading && r == newest.row && c == newest.col) continue;   // 淡入的那颗最后单独画
+                int cx = l->board_x + c * csize;
+                int cy = l->board_y + r * csize;
+                int k = (game->cells[r][c] == CELL_BLACK) ? 0 : 1;
+                if (stone_tex[k]) {
+                    SDL_Rect dst = {cx - radius, cy - radius, 2 * radius + 1, 2 * radius + 1};
+                    quad_batch_add(ren, &stones[k], &dst, opaque);
                 } else {
-                    col.r = 230; col.g = 230; col.b = 230; col.a = 255;
+                    sprite_draw(ren, k == 0 ? SPRITE_BLACK : SPRITE_WHITE, cx, cy, radius);
                 }
-                draw_filled_circle(ren, cx, cy, radius, col);
             }
         }
     }
+    quad_batch_flush(ren, &stones[0]);
+    quad_batch_flush(ren, &stones[1]);
+
+    /* 新落的子：透明度 0 -> 255，半径 80% -> 100%（同一张贴图缩放着画，不多光栅化） */
+    if (fading && within_board(newest.row, newest.col) &&
+        game->cells[newest.row][newest.col] != CELL_EMPTY) {
+        float t = (float)age / ANIM_FADE_MS;
+        int k = (game->cells[newest.row][newest.col] == CELL_BLACK) ? 0 : 1;
+        int r = (int)(radius * (0.8f + 0.2f * t) + 0.5f);
+        int cx = l->board_x + newest.col * csize;
+        int cy = l->board_y + newest.row * csize;
+        SDL_Rect dst = {cx - r, cy - r, 2 * r + 1, 2 * r + 1};
+        SDL_Color fade = {255, 255, 255, (Uint8)(255.0f * t)};
+        static QuadBatch fresh;
+        if (stone_tex[k]) {
+            quad_batch_begin(&fresh, stone_tex[k]);
+            quad_batch_add(ren, &fresh, &dst, fade);
+            quad_batch_flush(ren, &fresh);
+        } else {
+            sprite_draw(ren, k == 0 ? SPRITE_BLACK : SPRITE_WHITE, cx, cy, r);
+        }
+    }
 
-    /* 高亮最后一步落子 */
+    /* 高亮最后一步落子：动画期间红点放大再缩回，跳两下，幅度越来越小 */
     if (game->moves_count > 0) {
         Move last = game->moves[game->moves_count - 1];
-        int lx = start + last.col * csize;
-        int ly = start + last.row * csize;
-        SDL_Color red = {200, 30, 30, 255};
-        draw_filled_circle(ren, lx, ly, radius / 4, red);
+        int lx = l->board_x + last.col * csize;
+        int ly = l->board_y + last.row * csize;
+        int base = radius / 4;
+        if (age < ANIM_PULSE_MS && base > 0) {
+            /* 贴图按最大的那个半径只光栅化一张，每帧缩放着贴 */
+            int max_r = base * 8 / 5;
+            float p = (float)age / ANIM_PULSE_MS;
+            float bump = (float)fabs(sin(p * 2.0 * M_PI)) * (1.0f - p);
+            int r = base + (int)((max_r - base) * bump + 0.5f);
+            SDL_Texture *tex = sprite_get(ren, SPRITE_MARKER, max_r);
+            if (tex) {
+                SDL_Rect dst = {lx - r, ly - r, 2 * r + 1, 2 * r + 1};
+                SDL_RenderCopy(ren, tex, NULL, &dst);
+                perf_count_draw(1);
+            } else {
+                sprite_draw(ren, SPRITE_MARKER, lx, ly, r);
+            }
+        } else {
+            sprite_draw(ren, SPRITE_MARKER, lx, ly, base);
+        }
     }
 
     /* SDL_RenderPresent 将由调用者负责，以便在绘制棋盘之后再绘制计分板或其他元素 */
 }
 
-/* 坐标转换：将屏幕坐标（像素）映射到棋盘行列；无（只使用了基本的数学运算） */
+/* 坐标转换：将鼠标事件的窗口坐标映射到棋盘行列（先换成像素，再按布局里的棋盘位置算） */
 int pixel_to_cell(int x, int y, int *row, int *col)
 {
-    int csize = cell_size();
-    int start = BOARD_MARGIN;
+    const Layout *l = layout_get();
+    int csize = l->cell;
+    if (csize <= 0) return 0;
+    layout_mouse(&x, &y);
     /* 使用半格宽度作为容差，以便点击靠近线条也能生效 */
     int half = csize / 2;
-    int rel_x = x - start;
-    int rel_y = y - start;
+    int rel_x = x - l->board_x;
+    int rel_y = y - l->board_y;
     if (rel_x < -half || rel_y < -half) return 0;
     int c = (rel_x + half) / csize;
     int r = (rel_y + half) / csize;
@@ -271,11 +454,12 @@ int pixel_to_cell(int x, int y, int *row, int *col)
 void draw_game_over(SDL_Renderer *ren, int winner)
 {
     if (!ren) return;
-    SDL_Rect overlay = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_Rect overlay = ui_full();
     /* 半透明遮罩 */
     SDL_SetRenderDrawColor(ren, 0, 0, 0, 128);
     SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
     SDL_RenderFillRect(ren, &overlay);
+    perf_count_draw(1);
     SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
     /* 不再走控制台提示：全程只用图形界面 */
 }
@@ -285,10 +469,11 @@ void draw_game_result(SDL_Renderer *ren, int winner)
 {
     if (!ren) return;
     /* 绘制半透明遮罩层 */
-    SDL_Rect overlay = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_Rect overlay = ui_full();
     SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
     SDL_SetRenderDrawColor(ren, 0, 0, 0, 180);
     SDL_RenderFillRect(ren, &overlay);
+    perf_count_draw(1);
     SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
 
     /* 根据获胜者选择提示文本 */
@@ -301,28 +486,22 @@ void draw_game_result(SDL_Renderer *ren, int winner)
         msg = "平局！";
     }
     /* 文本区域 */
-    SDL_Rect rect;
-    rect.w = WINDOW_WIDTH * 3 / 4;
-    rect.h = 80;
-    rect.x = (WINDOW_WIDTH - rect.w) / 2;
-    rect.y = (WINDOW_HEIGHT - rect.h) / 2;
+    SDL_Rect rect = ui_rect(80, 280, 480, 80);
     SDL_Color color = {255, 255, 255, 255};
     draw_menu_text_center(ren, &rect, msg, color);
 
     /* 再补一句提示：回到菜单用鼠标点一下就行 */
-    SDL_Rect rect2 = rect;
-    rect2.y += 60;
-    rect2.h = 50;
+    SDL_Rect rect2 = ui_rect(80, 340, 480, 50);
     SDL_Color color2 = {230, 230, 230, 255};
     draw_menu_text_center(ren, &rect2, "(鼠标左键返回)", color2);
     SDL_RenderPresent(ren);
 }
 
-/* 使用七段显示样式绘制 0-9 的数字；- SDL_SetRenderDrawColor() : SDL 库函数，设置绘制颜色 */
-static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
-                               int digit, SDL_Color color)
+/* 使用七段显示样式绘制 0-9 的数字：点亮的段加进 batch，由调用者一次画掉 */
+static void draw_segment_digit(SDL_Renderer *ren, RectBatch *batch, int x, int y, int w, int h,
+                               int digit)
 {
-    if (!ren) return;
+    if (!ren || !batch) return;
     /* 定义每个数字需要点亮的段 */
     static const int segments[10][7] = {
         /* a b c d e f g (a=0) */
@@ -339,7 +518,7 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
     };
     int thick = w / 10;
     if (thick < 2) thick = 2;
-    SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, color.a);
+    /* 点亮的段只加进批次，颜色由批次统一设 */
     /* 计算段坐标 */
     SDL_Rect seg;
     /* 顶部横段 a */
@@ -348,7 +527,7 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y;
         seg.w = w;
         seg.h = thick;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 右上纵段 b */
     if (segments[digit][1]) {
@@ -356,7 +535,7 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 右下纵段 c */
     if (segments[digit][2]) {
@@ -364,7 +543,7 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h / 2;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 底部横段 d */
     if (segments[digit][3]) {
@@ -372,7 +551,7 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h - thick;
         seg.w = w;
         seg.h = thick;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 左下纵段 e */
     if (segments[digit][4]) {
@@ -380,7 +559,7 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h / 2;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 左上纵段 f */
     if (segments[digit][5]) {
@@ -388,7 +567,7 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 中间横段 g */
     if (segments[digit][6]) {
@@ -396,15 +575,15 @@ static void draw_segment_digit(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h / 2 - thick / 2;
         seg.w = w;
         seg.h = thick;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
 }
 
-/* 使用七段显示样式绘制数字或字母；- toupper() : 来自 <ctype.h>，将字符转换为大写字母 */
-static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
-                              char ch, SDL_Color color)
+/* 使用七段显示样式绘制数字或字母：点亮的段加进 batch，由调用者一次画掉 */
+static void draw_segment_char(SDL_Renderer *ren, RectBatch *batch, int x, int y, int w, int h,
+                              char ch)
 {
-    if (!ren) return;
+    if (!ren || !batch) return;
     /* 定义 7 段灯的状态: 0:off 1:on */
     int pattern[7] = {0};
     if (ch >= '0' && ch <= '9') {
@@ -444,6 +623,7 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
         case 'Z': pattern[0]=1; pattern[1]=1; pattern[3]=1; pattern[4]=1; pattern[6]=1; break;
         case 'T': pattern[0]=1; pattern[1]=1; pattern[2]=1; break;
         case 'Q': pattern[0]=1; pattern[1]=1; pattern[2]=1; pattern[3]=1; pattern[5]=1; pattern[6]=1; break;
+        case '-': pattern[6]=1; break;
         default:
             /* 未支持的字符不绘制 */
             return;
@@ -451,14 +631,14 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
     }
     SDL_Rect seg;
     int thick = w / 6;
-    SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, color.a);
+    /* 点亮的段只加进批次，颜色由批次统一设 */
     /* 顶部水平段 a */
     if (pattern[0]) {
         seg.x = x;
         seg.y = y;
         seg.w = w;
         seg.h = thick;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 右上垂直段 b */
     if (pattern[1]) {
@@ -466,7 +646,7 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 右下垂直段 c */
     if (pattern[2]) {
@@ -474,7 +654,7 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h / 2;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 底部水平段 d */
     if (pattern[3]) {
@@ -482,7 +662,7 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h - thick;
         seg.w = w;
         seg.h = thick;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 左下垂直段 e */
     if (pattern[4]) {
@@ -490,7 +670,7 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h / 2;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 左上垂直段 f */
     if (pattern[5]) {
@@ -498,7 +678,7 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y;
         seg.w = thick;
         seg.h = h / 2;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
     }
     /* 中间水平段 g */
     if (pattern[6]) {
@@ -506,7 +686,27 @@ static void draw_segment_char(SDL_Renderer *ren, int x, int y, int w, int h,
         seg.y = y + h / 2 - thick / 2;
         seg.w = w;
         seg.h = thick;
-        SDL_RenderFillRect(ren, &seg);
+        rect_batch_add(ren, batch, &seg);
+    }
+}
+
+/* 往 batch 里加一个字符的七段图形（小写转大写）；七段字库里没有“:”和“.”，手动画小点 */
+static void draw_segment_glyph(SDL_Renderer *ren, RectBatch *batch, int x, int y, int w, int h, char ch)
+{
+    if (ch == '.') {
+        int dot = w / 4;
+        if (dot < 2) dot = 2;
+        SDL_Rect d = {x + w / 2 - dot / 2, y + h - dot, dot, dot};
+        rect_batch_add(ren, batch, &d);
+    } else if (ch == ':') {
+        int dot = w / 4;
+        if (dot < 2) dot = 2;
+        SDL_Rect d1 = {x + w / 2 - dot / 2, y + h / 3 - dot / 2, dot, dot};
+        SDL_Rect d2 = {x + w / 2 - dot / 2, y + (h * 2) / 3 - dot / 2, dot, dot};
+        rect_batch_add(ren, batch, &d1);
+        rect_batch_add(ren, batch, &d2);
+    } else {
+        draw_segment_char(ren, batch, x, y, w, h, (char)toupper((unsigned char)ch));
     }
 }
 
@@ -515,29 +715,265 @@ static void draw_segment_text(SDL_Renderer *ren, int x, int y, int w, int h,
                               const char *text, SDL_Color color)
 {
     if (!ren || !text) return;
+    /* 整串字的所有段攒成一批，最后一次 FillRects */
+    RectBatch batch;
+    rect_batch_begin(&batch, color);
     int posX = x;
     for (const char *p = text; *p; p++) {
-        /* 七段字库里没有“:”，这里手动画两个小点出来当分隔符 */
-        if (*p == ':') {
-            int dot = w / 4;
-            if (dot < 2) dot = 2;
-            SDL_SetRenderDrawColor(ren, color.r, color.g, color.b, color.a);
-            SDL_Rect d1 = {posX + w / 2 - dot / 2, y + h / 3 - dot / 2, dot, dot};
-            SDL_Rect d2 = {posX + w / 2 - dot / 2, y + (h * 2) / 3 - dot / 2, dot, dot};
-            SDL_RenderFillRect(ren, &d1);
-            SDL_RenderFillRect(ren, &d2);
-        } else {
-            draw_segment_char(ren, posX, y, w, h, (char)toupper((unsigned char)*p), color);
-        }
+        draw_segment_glyph(ren, &batch, posX, y, w, h, *p);
         /* 在字符之间加入一点间隔（别挤成一坨） */
         posX += w + (w / 4);
     }
+    rect_batch_flush(ren, &batch);
+}
+
+/* ========== HUD 缓存 ==========
+ * 比分、计时器、悔棋数、回放手数这几串七段字，以前每帧每一段都要重新算、重新画。
+ * 现在分两层缓存：
+ *   1. 字形图集：每种字号一张，所有字符的七段图形（白色）各占一格，只画一次；
+ *   2. 每个 HUD 项一张小纹理：内容变了才从图集里把字符拷过去重拼，没变就直接贴。
+ * 颜色在最后贴图时用 ColorMod / AlphaMod 上，所以同一张图集各种颜色都能用。
+ * 不支持渲染目标时退回 draw_segment_text 直接画。 */
+
+/* 图集里有的字符，顺序就是格子的顺序 */
+static const char HUD_GLYPHS[] = "0123456789ABCDEFHILNOPQRTUVYZ-:.";
+#define HUD_GLYPH_COUNT ((int)sizeof(HUD_GLYPHS) - 1)
+#define HUD_ATLAS_SLOTS 4        // 现在只用到 12x16、12x18 和性能面板的小字三种字号
+#define PERF_OVERLAY_LINES 7
+#define HUD_TEXT_MAX    16       // 一串字最多几个字符（性能面板的 "16.7 16.9 33.4" 够用）
+
+typedef enum {
+    HUD_SCORE_BLACK = 0,
+    HUD_SCORE_WHITE,
+    HUD_TIMER,
+    HUD_UNDO,
+    HUD_PLAYBACK_MOVE,
+    HUD_PERF_FIRST,                              // 性能面板的数字，一行一项
+    HUD_ITEM_COUNT = HUD_PERF_FIRST + PERF_OVERLAY_LINES
+} HudItem;
+
+typedef struct {
+    int          w, h;           // 每格字形的大小；tex 为 NULL 表示空位
+    SDL_Texture *tex;
+} HudAtlas;
+
+typedef struct {
+    SDL_Texture *tex;            // 宽度按 HUD_TEXT_MAX 个字符开，够放任何一串
+    int          w, h;           // 字形大小
+    int          used_w;         // 当前这串字实际占的宽度
+    char         text[HUD_TEXT_MAX + 1];
+} HudString;
+
+static HudAtlas      g_hud_atlas[HUD_ATLAS_SLOTS];
+static int           g_hud_atlas_next = 0;
+static HudString     g_hud[HUD_ITEM_COUNT];
+static SDL_Renderer *g_hud_ren = NULL;
+
+static void hud_release(void)
+{
+    for (int i = 0; i < HUD_ATLAS_SLOTS; i++) {
+        if (g_hud_atlas[i].tex) SDL_DestroyTexture(g_hud_atlas[i].tex);
+        g_hud_atlas[i].tex = NULL;
+    }
+    for (int i = 0; i < HUD_ITEM_COUNT; i++) {
+        if (g_hud[i].tex) SDL_DestroyTexture(g_hud[i].tex);
+        memset(&g_hud[i], 0, sizeof(g_hud[i]));
+    }
+    g_hud_atlas_next = 0;
+    g_hud_ren = NULL;
+}
+
+/* 建一张透明的渲染目标纹理 */
+static SDL_Texture *hud_create_target(SDL_Renderer *ren, int w, int h)
+{
+    SDL_Texture *tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (tex) SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    return tex;
+}
+
+/* 把当前渲染目标清成全透明 */
+static void hud_clear_target(SDL_Renderer *ren)
+{
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(ren, 0, 0, 0, 0);
+    SDL_RenderClear(ren);
+}
+
+/* 取 w×h 字号的字形图集，没有就现画一张 */
+static SDL_Texture *hud_atlas(SDL_Renderer *ren, int w, int h)
+{
+    for (int i = 0; i < HUD_ATLAS_SLOTS; i++) {
+        if (g_hud_atlas[i].tex && g_hud_atlas[i].w == w && g_hud_atlas[i].h == h) return g_hud_atlas[i].tex;
+    }
+
+    SDL_Texture *tex = hud_create_target(ren, w * HUD_GLYPH_COUNT, h);
+    if (!tex) return NULL;
+    SDL_Texture *old = SDL_GetRenderTarget(ren);
+    if (SDL_SetRenderTarget(ren, tex) != 0) {
+        SDL_DestroyTexture(tex);
+        return NULL;
+    }
+    hud_clear_target(ren);
+    SDL_Color white = {255, 255, 255, 255};
+    RectBatch batch;
+    rect_batch_begin(&batch, white);
+    for (int i = 0; i < HUD_GLYPH_COUNT; i++) {
+        draw_segment_glyph(ren, &batch, i * w, 0, w, h, HUD_GLYPHS[i]);
+    }
+    rect_batch_flush(ren, &batch);
+    SDL_SetRenderTarget(ren, old);
+    perf_count_upload();
+
+    HudAtlas *slot = &g_hud_atlas[g_hud_atlas_next];
+    g_hud_atlas_next = (g_hud_atlas_next + 1) % HUD_ATLAS_SLOTS;
+    if (slot->tex) SDL_DestroyTexture(slot->tex);
+    slot->tex = tex;
+    slot->w = w;
+    slot->h = h;
+    return tex;
+}
+
+/* 把 text 从图集里拼到 hs->tex 上；失败返回 0 */
+static int hud_rebuild(SDL_Renderer *ren, HudString *hs, const char *text, int w, int h)
+{
+    int advance = w + (w / 4);
+    if (!hs->tex || hs->w != w || hs->h != h) {
+        if (hs->tex) SDL_DestroyTexture(hs->tex);
+        hs->tex = hud_create_target(ren, advance * HUD_TEXT_MAX, h);
+        if (!hs->tex) return 0;
+        hs->w = w;
+        hs->h = h;
+    }
+    SDL_Texture *atlas = hud_atlas(ren, w, h);
+    if (!atlas) return 0;
+
+    SDL_Texture *old = SDL_GetRenderTarget(ren);
+    if (SDL_SetRenderTarget(ren, hs->tex) != 0) return 0;
+    hud_clear_target(ren);
+    SDL_SetTextureColorMod(atlas, 255, 255, 255);
+    SDL_SetTextureAlphaMod(atlas, 255);
+    int n = 0;
+    for (const char *p = text; *p && n < HUD_TEXT_MAX; p++, n++) {
+        const char *g = strchr(HUD_GLYPHS, toupper((unsigned char)*p));
+        if (!g || !*g) continue;          /* 空格等：只占位不画 */
+        SDL_Rect src = {(int)(g - HUD_GLYPHS) * w, 0, w, h};
+        SDL_Rect dst = {n * advance, 0, w, h};
+        SDL_RenderCopy(ren, atlas, &src, &dst);
+    }
+    SDL_SetRenderTarget(ren, old);
+    perf_count_upload();
+
+    hs->used_w = n * advance;
+    snprintf(hs->text, sizeof(hs->text), "%s", text);
+    return 1;
+}
+
+/* 画一个 HUD 项：内容没变就直接贴缓存的纹理 */
+static void draw_hud_text(SDL_Renderer *ren, HudItem item, int x, int y, int w, int h,
+                          const char *text, SDL_Color color)
+{
+    if (!ren || !text) return;
+    if (ren != g_hud_ren || SDL_AtomicSet(&g_hud_dirty, 0)) {
+        hud_release();
+        g_hud_ren = ren;
+    }
+
+    HudString *hs = &g_hud[item];
+    int fresh = hs->tex && hs->w == w && hs->h == h && strcmp(hs->text, text) == 0;
+    if (!fresh && (strlen(text) > HUD_TEXT_MAX || !SDL_RenderTargetSupported(ren) ||
+                   !hud_rebuild(ren, hs, text, w, h))) {
+        hs->text[0] = '\0';
+        draw_segment_text(ren, x, y, w, h, text, color);
+        return;
+    }
+    if (hs->used_w <= 0) return;
+
+    SDL_SetTextureColorMod(hs->tex, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(hs->tex, color.a);
+    SDL_Rect src = {0, 0, hs->used_w, h};
+    SDL_Rect dst = {x, y, hs->used_w, h};
+    SDL_RenderCopy(ren, hs->tex, &src, &dst);
+    perf_count_draw(1);
+}
+
+/* ========== 回放控制条：棋盘下方的进度条 + 左上角的手数 ========== */
+
+/* 进度条的可点区域（比画出来的细条高一些，方便点中） */
+static SDL_Rect playback_bar_rect(void)
+{
+    return ui_rect(40, 610, 560, 24);
+}
+
+void draw_playback_bar(SDL_Renderer *ren, int move, int total, int playing, double speed)
+{
+    if (!ren) return;
+    SDL_Rect area = playback_bar_rect();
+
+    /* 底槽 */
+    int track_h = ui_px(6);
+    SDL_Rect track = {area.x, area.y + area.h / 2 - track_h / 2, area.w, track_h};
+    SDL_SetRenderDrawColor(ren, 160, 130, 100, 255);
+    SDL_RenderFillRect(ren, &track);
+
+    /* 已播放部分 */
+    int filled = (total > 0) ? (int)((long)area.w * move / total) : 0;
+    SDL_Rect done = {track.x, track.y, filled, track.h};
+    SDL_SetRenderDrawColor(ren, 200, 60, 90, 255);
+    SDL_RenderFillRect(ren, &done);
+
+    /* 滑块 */
+    int knob_w = ui_px(10);
+    SDL_Rect knob = {area.x + filled - knob_w / 2, area.y + ui_px(2), knob_w, area.h - ui_px(4)};
+    SDL_SetRenderDrawColor(ren, 90, 60, 80, 255);
+    SDL_RenderFillRect(ren, &knob);
+    perf_count_draw(3);
+
+    /* 左上角：当前手数/总手数，暂停时前面加个 P */
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%s%d-%d", playing ? "" : "P ", move, total);
+    SDL_Color color = {40, 40, 40, 255};
+    SDL_Rect at = ui_rect(10, 10, 12, 18);
+    draw_hud_text(ren, HUD_PLAYBACK_MOVE, at.x, at.y, at.w, at.h, buf, color);
+
+    /* 手数下面：播放速度（档位不多，文字缓存里很快就都有了） */
+    TTF_Font *font = res_font(RES_FONT_SMALL);
+    if (font) {
+        char sbuf[32];
+        snprintf(sbuf, sizeof(sbuf), "速度 ×%g", speed);
+        int tw, th;
+        SDL_Texture *tex = textcache_get(ren, font, res_font_size(RES_FONT_SMALL), sbuf, color, &tw, &th);
+        if (tex) {
+            SDL_Rect dst = {at.x, at.y + at.h + ui_px(6), tw, th};
+            SDL_RenderCopy(ren, tex, NULL, &dst);
+            perf_count_draw(1);
+        }
+    }
+}
+
+int playback_bar_hit(int x, int y)
+{
+    SDL_Rect area = playback_bar_rect();
+    int slack = ui_px(8);
+    layout_mouse(&x, &y);
+    /* 左右各放宽一点，拖到两头时容易落在 0 和最后一手上 */
+    return y >= area.y && y < area.y + area.h && x >= area.x - slack && x <= area.x + area.w + slack;
+}
+
+int playback_bar_move(int x, int total)
+{
+    SDL_Rect area = playback_bar_rect();
+    layout_mouse(&x, NULL);
+    int rel = x - area.x;
+    if (rel < 0) rel = 0;
+    if (rel > area.w) rel = area.w;
+    return (area.w > 0) ? (int)(((long)rel * total + area.w / 2) / area.w) : 0;
 }
 
 /* 绘制主菜单界面；- SDL_SetRenderDrawColor() : SDL 库函数，设置绘制颜色 */
 void draw_main_menu(SDL_Renderer *ren, int has_resume)
 {
     if (!ren) return;
+    sync_layout(ren);
 
     /* 先画背景图（如果加载失败，会退化成纯色底） */
     SDL_SetRenderDrawColor(ren, 240, 240, 240, 255);
@@ -547,13 +983,9 @@ void draw_main_menu(SDL_Renderer *ren, int has_resume)
     /* 盖一层浅色雾面：背景再花也不怕，按钮/文字会更清楚 */
     draw_menu_fog(ren, 110);
 
-    /* 按钮布局：五个竖着排的长矩形 */
-    int bw = WINDOW_WIDTH * 3 / 4;
-    int bh = 60;
-    int spacing = 20;
-
-    int left = (WINDOW_WIDTH - bw) / 2;
-    int top  = 80;
+    /* 按钮布局：五个竖着排的长矩形（和点击判断共用 layout.c 的表） */
+    UiButton buttons[LAYOUT_MAX_BUTTONS];
+    int n = layout_buttons(UI_SCREEN_MAIN, 0, 0, buttons);
 
     const char *labels[5] = {
         has_resume ? "1. 继续上次对局" : "1. 继续上次对局（暂无存档）",
@@ -563,35 +995,31 @@ void draw_main_menu(SDL_Renderer *ren, int has_resume)
         "5. 退出游戏"
     };
 
-    for (int i = 0; i < 5; i++) {
-        SDL_Rect rect = {left, top + i * (bh + spacing), bw, bh};
+    SDL_Rect rects[5];
+    SDL_Color fills[5];
+    for (int i = 0; i < 5 && i < n; i++) {
+        rects[i] = buttons[i].rect;
 
         /* 按钮：统一用偏粉的半透明底色，跟背景更搭一点 */
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-
         if (i == 0 && !has_resume) {
             /* 没有存档时，把“继续”按钮画成灰一点，避免误点 */
-            SDL_SetRenderDrawColor(ren, 210, 210, 210, 140);
+            SDL_Color grey = {210, 210, 210, 140};
+            fills[i] = grey;
         } else {
             /* 轻微做点深浅变化，让列表看起来不那么“板” */
-            Uint8 g = (Uint8)(185 - i * 6);
-            Uint8 b = (Uint8)(210 - i * 5);
-            SDL_SetRenderDrawColor(ren, 255, g, b, 170);
+            SDL_Color pink = {255, (Uint8)(185 - i * 6), (Uint8)(210 - i * 5), 170};
+            fills[i] = pink;
         }
+    }
+    /* 五个按钮的底色、边框各一次调用画完 */
+    draw_button_rects(ren, rects, fills, n < 5 ? n : 5);
 
-        SDL_RenderFillRect(ren, &rect);
-
-        /* 边框也别太硬，稍微淡一点 */
-        SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-        SDL_RenderDrawRect(ren, &rect);
-
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
-
+    for (int i = 0; i < 5 && i < n; i++) {
         SDL_Color textColor = {20, 20, 20, 255};
         if (i == 0 && !has_resume) {
             textColor.r = 90; textColor.g = 90; textColor.b = 90;
         }
-        draw_menu_text_center(ren, &rect, labels[i], textColor);
+        draw_menu_text_center(ren, &rects[i], labels[i], textColor);
     }
 
     SDL_RenderPresent(ren);
@@ -601,6 +1029,7 @@ void draw_main_menu(SDL_Renderer *ren, int has_resume)
 void draw_ai_difficulty_menu(SDL_Renderer *ren)
 {
     if (!ren) return;
+    sync_layout(ren);
 
     /* 和主菜单保持一致：同一张背景图 + 雾面 */
     SDL_SetRenderDrawColor(ren, 245, 245, 245, 255);
@@ -608,12 +1037,8 @@ void draw_ai_difficulty_menu(SDL_Renderer *ren)
     draw_menu_background(ren);
     draw_menu_fog(ren, 110);
 
-    int bw = WINDOW_WIDTH * 3 / 4;
-    int bh = 60;
-    int spacing = 20;
-
-    int left = (WINDOW_WIDTH - bw) / 2;
-    int top  = 120;
+    UiButton buttons[LAYOUT_MAX_BUTTONS];
+    int n = layout_buttons(UI_SCREEN_AI, 0, 0, buttons);
 
     const char *labels[4] = {
         "1. 简单",
@@ -622,24 +1047,20 @@ void draw_ai_difficulty_menu(SDL_Renderer *ren)
         "4. 返回"
     };
 
-    for (int i = 0; i < 4; i++) {
-        SDL_Rect rect = {left, top + i * (bh + spacing), bw, bh};
-
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
+    SDL_Rect rects[4];
+    SDL_Color fills[4];
+    for (int i = 0; i < 4 && i < n; i++) {
+        rects[i] = buttons[i].rect;
 
         /* 难度按钮也用同一套“粉色半透明”风格 */
-        Uint8 g = (Uint8)(185 - i * 8);
-        Uint8 b = (Uint8)(210 - i * 8);
-        SDL_SetRenderDrawColor(ren, 255, g, b, 170);
-        SDL_RenderFillRect(ren, &rect);
-
-        SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-        SDL_RenderDrawRect(ren, &rect);
-
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+        SDL_Color pink = {255, (Uint8)(185 - i * 8), (Uint8)(210 - i * 8), 170};
+        fills[i] = pink;
+    }
+    draw_button_rects(ren, rects, fills, n < 4 ? n : 4);
 
+    for (int i = 0; i < 4 && i < n; i++) {
         SDL_Color textColor = {20, 20, 20, 255};
-        draw_menu_text_center(ren, &rect, labels[i], textColor);
+        draw_menu_text_center(ren, &rects[i], labels[i], textColor);
     }
 
     SDL_RenderPresent(ren);
@@ -649,9 +1070,67 @@ void draw_ai_difficulty_menu(SDL_Renderer *ren)
 /* 绘制游戏结束后的菜单（再来一局/退出游戏）；- SDL_SetRenderDrawColor() : SDL 库函数，设置绘制颜色 */
 
 /* ========== 回放菜单：列出历史对局（鼠标点选） ========== */
-void draw_playback_menu(SDL_Renderer *ren, int page, int total, int per_page)
+
+/* 缩略图纹理：只给当前这一页上传，按落子序列哈希认。一页最多 PLAYLIST_MAX_ROWS 行，
+ * 多留一页的位置，来回翻页时刚看过的那页不用重传 */
+#define THUMB_TEXTURES (PLAYLIST_MAX_ROWS * 2)
+
+typedef struct {
+    uint64_t     hash;       // 0 = 空位
+    SDL_Texture *tex;
+    unsigned     last_used;
+} ThumbTex;
+
+static ThumbTex      g_thumbs[THUMB_TEXTURES];
+static unsigned      g_thumb_tick = 0;
+static SDL_Renderer *g_thumb_ren = NULL;
+
+static void thumbs_release(void)
+{
+    for (int i = 0; i < THUMB_TEXTURES; i++) {
+        if (g_thumbs[i].tex) SDL_DestroyTexture(g_thumbs[i].tex);
+        g_thumbs[i].tex = NULL;
+        g_thumbs[i].hash = 0;
+    }
+    g_thumb_ren = NULL;
+}
+
+/* 取某盘棋缩略图的纹理；后台还没准备好时返回 NULL（准备好了会有事件叫醒界面重画） */
+static SDL_Texture *thumb_texture(SDL_Renderer *ren, uint64_t hash)
+{
+    if (!hash) return NULL;
+    if (ren != g_thumb_ren) {
+        thumbs_release();
+        g_thumb_ren = ren;
+    }
+    ThumbTex *victim = &g_thumbs[0];
+    for (int i = 0; i < THUMB_TEXTURES; i++) {
+        if (g_thumbs[i].hash == hash) {
+            g_thumbs[i].last_used = ++g_thumb_tick;
+            return g_thumbs[i].tex;
+        }
+        if (g_thumbs[i].last_used < victim->last_used) victim = &g_thumbs[i];
+    }
+
+    SDL_Surface *img = playlist_thumb(hash);
+    if (!img) return NULL;
+    SDL_Texture *tex = SDL_CreateTextureFromSurface(ren, img);
+    SDL_FreeSurface(img);
+    if (!tex) return NULL;
+    SDL_SetTextureScaleMode(tex, SDL_ScaleModeLinear);   // 96 像素缩到按钮里，线性过滤才不起锯齿
+    perf_count_upload();
+
+    if (victim->tex) SDL_DestroyTexture(victim->tex);
+    victim->hash = hash;
+    victim->tex = tex;
+    victim->last_used = ++g_thumb_tick;
+    return tex;
+}
+void draw_playback_menu(SDL_Renderer *ren, int page, int total, int per_page,
+                        const RecordSummary *rows, int row_count)
 {
     if (!ren) return;
+    sync_layout(ren);
 
     SDL_SetRenderDrawColor(ren, 240, 240, 240, 255);
     SDL_RenderClear(ren);
@@ -661,54 +1140,73 @@ void draw_playback_menu(SDL_Renderer *ren, int page, int total, int per_page)
     draw_menu_fog(ren, 110);
 
     /* 标题 */
-    SDL_Rect title = {0, 20, WINDOW_WIDTH, 60};
+    SDL_Rect title = ui_rect(0, 20, LAYOUT_DESIGN_SIZE, 60);
     SDL_Color titleColor = {60, 40, 55, 255};
     draw_menu_text_center(ren, &title, "对局回放", titleColor);
 
-    int list_w = WINDOW_WIDTH * 3 / 4;
-    int left = (WINDOW_WIDTH - list_w) / 2;
-    int row_h = 52;
-    int gap = 14;
-    int top = 110;
-
     int start_index = page * per_page;
     int show_count = total - start_index;
     if (show_count > per_page) show_count = per_page;
     if (show_count < 0) show_count = 0;
+    if (show_count > PLAYLIST_MAX_ROWS) show_count = PLAYLIST_MAX_ROWS;
+
+    /* 按钮位置和 main.c 判断点击用的是同一张表：每行“第 N 轮”+“删除”，再是翻页和返回 */
+    UiButton buttons[LAYOUT_MAX_BUTTONS];
+    int nrects = layout_buttons(UI_SCREEN_LIST, show_count, total > per_page, buttons);
+
+    /* 先把这一屏所有按钮的底色、边框一起画掉，再逐个写字 */
+    SDL_Rect rects[LAYOUT_MAX_BUTTONS];
+    SDL_Color fills[LAYOUT_MAX_BUTTONS];
+    SDL_Color playFill = {255, 180, 210, 170};
+    SDL_Color delFill  = {255, 155, 190, 180};   /* 删除按钮：稍微深一点，别点错 */
+    for (int i = 0; i < nrects; i++) {
+        rects[i] = buttons[i].rect;
+        fills[i] = (buttons[i].id == UI_LIST_DELETE) ? delFill : playFill;
+    }
+    draw_button_rects(ren, rects, fills, nrects);
+
+    SDL_Color textColor = {40, 30, 40, 255};
+    for (int b = 0; b < nrects; b++) {
+        const UiButton *btn = &buttons[b];
+        switch (btn->id) {
+        case UI_LIST_PLAY: {
+            int i = btn->row;
+            int idx = start_index + i;
+            int have = rows && i < row_count && rows[i].index == idx;
+            /* 按钮左边放终局缩略图，文字往右让一让（缩略图没到时也让，免得文字跳） */
+            int pad = ui_px(3);
+            SDL_Rect thumb = {btn->rect.x + pad, btn->rect.y + pad, btn->rect.h - 2 * pad, btn->rect.h - 2 * pad};
+            SDL_Rect text = {thumb.x + thumb.w, btn->rect.y, btn->rect.w - (thumb.x + thumb.w - btn->rect.x), btn->rect.h};
+            SDL_Texture *tt = have ? thumb_texture(ren, rows[i].hash) : NULL;
+            if (tt) {
+                SDL_RenderCopy(ren, tt, NULL, &thumb);
+                perf_count_draw(1);
+            }
 
-    /* 每行：左边“第 N 轮”按钮，右边“删除”小按钮 */
-    int del_w = 90;
-    int play_w = list_w - del_w - 10;
-
-    for (int i = 0; i < show_count; i++) {
-        int idx = start_index + i;
-        SDL_Rect playRect = {left, top + i * (row_h + gap), play_w, row_h};
-        SDL_Rect delRect  = {left + play_w + 10, top + i * (row_h + gap), del_w, row_h};
-
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-
-        /* 回放按钮 */
-        SDL_SetRenderDrawColor(ren, 255, 180, 210, 170);
-        SDL_RenderFillRect(ren, &playRect);
-        SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-        SDL_RenderDrawRect(ren, &playRect);
-
-        /* 删除按钮：稍微深一点，别点错 */
-        SDL_SetRenderDrawColor(ren, 255, 155, 190, 180);
-        SDL_RenderFillRect(ren, &delRect);
-        SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-        SDL_RenderDrawRect(ren, &delRect);
-
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
-
-        char label[64];
-        snprintf(label, sizeof(label), "第 %d 轮", idx + 1);
-
-        SDL_Color textColor = {40, 30, 40, 255};
-        draw_menu_text_center(ren, &playRect, label, textColor);
-
-        SDL_Color delText = {40, 30, 40, 255};
-        draw_menu_text_center(ren, &delRect, "删除", delText);
+            /* 摘要还没从后台取回来时只显示编号，取回来后补上日期、胜负和手数 */
+            char label[96];
+            if (have) {
+                const RecordSummary *r = &rows[i];
+                if (!r->ok) {
+                    snprintf(label, sizeof(label), "第 %d 轮（已损坏）", idx + 1);
+                } else {
+                    const char *res = (r->winner == 1) ? "黑胜" : (r->winner == 2) ? "白胜" : "平局";
+                    /* 时间只留“月-日”，按钮宽度有限 */
+                    const char *md = (strlen(r->time) >= 10) ? r->time + 5 : "";
+                    snprintf(label, sizeof(label), "第 %d 轮  %.5s  %s %d手", idx + 1, md, res, r->moves);
+                }
+            } else {
+                snprintf(label, sizeof(label), "第 %d 轮", idx + 1);
+            }
+            draw_menu_text_center(ren, &text, label, textColor);
+            break;
+        }
+        case UI_LIST_DELETE: draw_menu_text_center(ren, &btn->rect, "删除", textColor); break;
+        case UI_LIST_PREV:   draw_menu_text_center(ren, &btn->rect, "上一页", textColor); break;
+        case UI_LIST_NEXT:   draw_menu_text_center(ren, &btn->rect, "下一页", textColor); break;
+        case UI_LIST_BACK:   draw_menu_text_center(ren, &btn->rect, "返回", textColor); break;
+        default: break;
+        }
     }
 
     /* 翻页提示 */
@@ -717,78 +1215,39 @@ void draw_playback_menu(SDL_Renderer *ren, int page, int total, int per_page)
         int pages = (total + per_page - 1) / per_page;
         snprintf(pbuf, sizeof(pbuf), "第 %d/%d 页", page + 1, pages);
 
-        SDL_Rect pageRect = {0, WINDOW_HEIGHT - 120, WINDOW_WIDTH, 40};
+        SDL_Rect pageRect = ui_rect(0, 520, LAYOUT_DESIGN_SIZE, 40);
         SDL_Color pc = {70, 60, 70, 255};
         draw_menu_text_center(ren, &pageRect, pbuf, pc);
     }
 
-
-    /* 翻页按钮（记录多时才显示） */
-    if (total > per_page) {
-        SDL_Rect prevRect = { 60, WINDOW_HEIGHT - 80, 120, 50 };
-        SDL_Rect nextRect = { WINDOW_WIDTH - 60 - 120, WINDOW_HEIGHT - 80, 120, 50 };
-
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-
-        SDL_SetRenderDrawColor(ren, 255, 180, 210, 170);
-        SDL_RenderFillRect(ren, &prevRect);
-        SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-        SDL_RenderDrawRect(ren, &prevRect);
-
-        SDL_SetRenderDrawColor(ren, 255, 180, 210, 170);
-        SDL_RenderFillRect(ren, &nextRect);
-        SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-        SDL_RenderDrawRect(ren, &nextRect);
-
-        SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
-
-        SDL_Color t = {40, 30, 40, 255};
-        draw_menu_text_center(ren, &prevRect, "上一页", t);
-        draw_menu_text_center(ren, &nextRect, "下一页", t);
-    }
-
-    /* 底部按钮：返回主菜单 */
-    SDL_Rect backRect = { (WINDOW_WIDTH - 240) / 2, WINDOW_HEIGHT - 80, 240, 50 };
-    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(ren, 255, 180, 210, 170);
-    SDL_RenderFillRect(ren, &backRect);
-    SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-    SDL_RenderDrawRect(ren, &backRect);
-    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
-
-    SDL_Color backText = {40, 30, 40, 255};
-    draw_menu_text_center(ren, &backRect, "返回", backText);
-
     SDL_RenderPresent(ren);
 }
 
 void draw_playback_empty(SDL_Renderer *ren)
 {
     if (!ren) return;
+    sync_layout(ren);
 
     SDL_SetRenderDrawColor(ren, 240, 240, 240, 255);
     SDL_RenderClear(ren);
     draw_menu_background(ren);
     draw_menu_fog(ren, 110);
 
-    SDL_Rect title = {0, 20, WINDOW_WIDTH, 60};
+    SDL_Rect title = ui_rect(0, 20, LAYOUT_DESIGN_SIZE, 60);
     SDL_Color titleColor = {60, 40, 55, 255};
     draw_menu_text_center(ren, &title, "对局回放", titleColor);
 
-    SDL_Rect msg = {0, 150, WINDOW_WIDTH, 60};
+    SDL_Rect msg = ui_rect(0, 150, LAYOUT_DESIGN_SIZE, 60);
     SDL_Color mc = {70, 60, 70, 255};
     draw_menu_text_center(ren, &msg, "暂无对局记录", mc);
 
-    SDL_Rect backRect = { (WINDOW_WIDTH - 240) / 2, WINDOW_HEIGHT - 80, 240, 50 };
-    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(ren, 255, 180, 210, 170);
-    SDL_RenderFillRect(ren, &backRect);
-    SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-    SDL_RenderDrawRect(ren, &backRect);
-    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+    UiButton back;
+    layout_buttons(UI_SCREEN_LIST_EMPTY, 0, 0, &back);
+    SDL_Color backFill = {255, 180, 210, 170};
+    draw_button_rects(ren, &back.rect, &backFill, 1);
 
     SDL_Color backText = {40, 30, 40, 255};
-    draw_menu_text_center(ren, &backRect, "返回", backText);
+    draw_menu_text_center(ren, &back.rect, "返回", backText);
 
     SDL_RenderPresent(ren);
 }
@@ -797,40 +1256,28 @@ void draw_playback_empty(SDL_Renderer *ren)
 void draw_end_menu(SDL_Renderer *ren)
 {
     if (!ren) return;
+    sync_layout(ren);
 
     /* 半透明遮罩：不完全挡住棋盘，稍微柔一点 */
     SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
     SDL_SetRenderDrawColor(ren, 0, 0, 0, 140);
-    SDL_Rect overlay = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_Rect overlay = ui_full();
     SDL_RenderFillRect(ren, &overlay);
     SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
 
-    int bw = 220;
-    int bh = 80;
-    int gap = 40;
-
-    int left = (WINDOW_WIDTH - (2 * bw + gap)) / 2;
-    int top  = WINDOW_HEIGHT / 2 - bh / 2;
-
     SDL_Color white = {255, 255, 255, 255};
 
-    /* 左侧：再来一局 */
-    SDL_Rect r1 = {left, top, bw, bh};
-    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(ren, 255, 185, 210, 180);
-    SDL_RenderFillRect(ren, &r1);
-    SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-    SDL_RenderDrawRect(ren, &r1);
-    draw_menu_text_center(ren, &r1, "再来一局", white);
-
-    /* 右侧：返回主菜单 */
-    SDL_Rect r2 = {left + bw + gap, top, bw, bh};
-    SDL_SetRenderDrawColor(ren, 255, 165, 195, 180);
-    SDL_RenderFillRect(ren, &r2);
-    SDL_SetRenderDrawColor(ren, 90, 60, 80, 140);
-    SDL_RenderDrawRect(ren, &r2);
-    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
-    draw_menu_text_center(ren, &r2, "返回主菜单", white);
+    /* 左侧：再来一局；右侧：返回主菜单（位置和 main.c 的点击判断共用 layout.c 里的表） */
+    UiButton buttons[2];
+    layout_buttons(UI_SCREEN_END, 0, 0, buttons);
+    SDL_Rect rects[2] = { buttons[0].rect, buttons[1].rect };
+    SDL_Color fills[2] = {
+        {255, 185, 210, 180},
+        {255, 165, 195, 180},
+    };
+    draw_button_rects(ren, rects, fills, 2);
+    draw_menu_text_center(ren, &rects[0], "再来一局", white);
+    draw_menu_text_center(ren, &rects[1], "返回主菜单", white);
 
     SDL_RenderPresent(ren);
 }
@@ -841,10 +1288,11 @@ void draw_scoreboard(SDL_Renderer *ren, int score_black, int score_white)
 {
     if (!ren) return;
     /* 定义计分板区域起点 */
-    int x = 10;
-    int y = 10;
+    SDL_Rect origin = ui_rect(10, 10, 12, 16);   // w/h 是数码管单个字的大小
+    int x = origin.x;
+    int y = origin.y;
     /* 为了防止计分板图标被误认为棋子，这里将图标半径调小并使用不同颜色 */
-    int radius = 6;
+    int radius = ui_px(6);
     /* 黑方图标及分数 */
     /* 使用深灰色而非纯黑色，避免和棋子颜色混淆 */
     SDL_Color blackColor = {60, 60, 60, 255};
@@ -855,16 +1303,16 @@ void draw_scoreboard(SDL_Renderer *ren, int score_black, int score_white)
     /* 分数可能是多位数字，将其分解为字符 */
     char buf[4];
     snprintf(buf, sizeof(buf), "%d", score_black);
-    draw_segment_text(ren, x + radius * 2 + 5, y, 12, 16, buf, digitColor);
+    draw_hud_text(ren, HUD_SCORE_BLACK, x + radius * 2 + ui_px(5), y, origin.w, origin.h, buf, digitColor);
     /* 白方图标及分数 */
-    int offsetX = 120;
+    int offsetX = ui_px(120);
     /* 使用浅灰色代替纯白色 */
     SDL_Color whiteColor = {200, 200, 200, 255};
     draw_filled_circle(ren, x + offsetX + radius, y + radius, radius, whiteColor);
     snprintf(buf, sizeof(buf), "%d", score_white);
     /* 白色数字用深灰色描绘以便可见 */
     SDL_Color whiteDigitColor = {80, 80, 80, 255};
-    draw_segment_text(ren, x + offsetX + radius * 2 + 5, y, 12, 16, buf, whiteDigitColor);
+    draw_hud_text(ren, HUD_SCORE_WHITE, x + offsetX + radius * 2 + ui_px(5), y, origin.w, origin.h, buf, whiteDigitColor);
 }
 
 /* 右上角计时器：显示本局用时（mm:ss）。 */
@@ -879,15 +1327,15 @@ void draw_timer(SDL_Renderer *ren, int elapsed_seconds)
     char buf[16];
     snprintf(buf, sizeof(buf), "%02d:%02d", mm, ss);
 
-    /* 估算一下宽度，把它贴在右上角 */
-    int char_w = 12;
+    /* 估算一下宽度，把它贴在右上角（设计区域的右边，不是窗口的右边） */
+    SDL_Rect r = ui_rect(LAYOUT_DESIGN_SIZE - 10, 10, 12, 18);
+    int char_w = r.w;
     int gap = char_w / 4;
     int total_w = 5 * (char_w + gap); /* "mm:ss" 共 5 个字符 */
-    int x = WINDOW_WIDTH - total_w - 10;
-    int y = 10;
+    int x = r.x - total_w;
 
     SDL_Color color = {40, 40, 40, 255};
-    draw_segment_text(ren, x, y, char_w, 18, buf, color);
+    draw_hud_text(ren, HUD_TIMER, x, r.y, char_w, r.h, buf, color);
 }
 
 /* 显示悔棋次数（按一次算一次）。 */
@@ -899,12 +1347,61 @@ void draw_undo_count(SDL_Renderer *ren, int undo_count)
     char buf[16];
     snprintf(buf, sizeof(buf), "U%d", undo_count);
 
-    int char_w = 12;
+    SDL_Rect r = ui_rect(LAYOUT_DESIGN_SIZE - 10, 32, 12, 18); /* 在计时器下面一点 */
+    int char_w = r.w;
     int gap = char_w / 4;
     int total_w = (int)strlen(buf) * (char_w + gap);
-    int x = WINDOW_WIDTH - total_w - 10;
-    int y = 32; /* 在计时器下面一点 */
+    int x = r.x - total_w;
 
     SDL_Color color = {60, 60, 60, 255};
-    draw_segment_text(ren, x, y, char_w, 18, buf, color);
-}
\ No newline at end of file
+    draw_hud_text(ren, HUD_UNDO, x, r.y, char_w, r.h, buf, color);
+}
+
+/* 性能面板：标签是固定的中文（文字缓存里一直命中），数字用七段 HUD 缓存，
+ * 数字本身每 PERF_REFRESH_MS 才变一次，所以打开面板每帧也就多十几次贴图 */
+void draw_perf_overlay(SDL_Renderer *ren, const PerfStats *st)
+{
+    if (!ren || !st) return;
+
+    static const char *labels[PERF_OVERLAY_LINES] = {
+        "帧时间 ms",
+        "绘制调用/帧",
+        "纹理上传/帧",
+        "唤醒/秒",
+        "AI 思考 ms",
+        "AI 节点/秒",
+        "读写 ms",
+    };
+    char values[PERF_OVERLAY_LINES][HUD_TEXT_MAX + 1];
+    snprintf(values[0], sizeof(values[0]), "%.1f %.1f %.1f", st->frame_last_ms, st->frame_avg_ms, st->frame_p99_ms);
+    snprintf(values[1], sizeof(values[1]), "%d", st->draws);
+    snprintf(values[2], sizeof(values[2]), "%d", st->uploads);
+    snprintf(values[3], sizeof(values[3]), "%.1f", st->wakeups_per_sec);
+    snprintf(values[4], sizeof(values[4]), "%.1f", st->ai_ms);
+    snprintf(values[5], sizeof(values[5]), "%.0f", st->ai_nodes_per_sec);
+    snprintf(values[6], sizeof(values[6]), "%.1f", st->io_ms);
+
+    int line_h = ui_px(20);
+    SDL_Rect panel = ui_rect(10, 56, 300, PERF_OVERLAY_LINES * 20 + 12);
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(ren, 0, 0, 0, 170);
+    SDL_RenderFillRect(ren, &panel);
+    SDL_SetRenderDrawBlendMode(ren, SDL_BLENDMODE_NONE);
+    perf_count_draw(1);
+
+    TTF_Font *font = res_font(RES_FONT_SMALL);
+    SDL_Color label_color = {220, 220, 220, 255};
+    SDL_Color value_color = {120, 255, 140, 255};
+    for (int i = 0; i < PERF_OVERLAY_LINES; i++) {
+        int y = panel.y + ui_px(6) + i * line_h;
+        int tw, th;
+        SDL_Texture *tex = font ? textcache_get(ren, font, res_font_size(RES_FONT_SMALL), labels[i], label_color, &tw, &th) : NULL;
+        if (tex) {
+            SDL_Rect dst = {panel.x + ui_px(8), y + (line_h - th) / 2, tw, th};
+            SDL_RenderCopy(ren, tex, NULL, &dst);
+            perf_count_draw(1);
+        }
+        draw_hud_text(ren, (HudItem)(HUD_PERF_FIRST + i), panel.x + ui_px(120), y + ui_px(3),
+                      ui_px(7), ui_px(12), values[i], value_color);
+    }
+}
@@ -0,0 +1,149 @@
+/*
+ * heatmap.c
+ * 估值热力图（见 heatmap.h）。
+ *
+ * 颜色按固定的对数刻度从打分换算（不按这一盘的最高分归一化），所以落一颗子只会改到
+ * 它附近几条线上的格子，其他格子颜色不变，也就不用重传。
+ */
+
+#include "heatmap.h"
+#include "ai.h"
+#include "perf.h"
+#include <math.h>
+#include <string.h>
+
+/* 刻度：空旷处的空位是 HEAT_SCORE_LOW 分（四个方向各一颗，自己 10 + 对手 9），
+ * 到 HEAT_SCORE_HIGH 就算满格（再往上是能连五/必须堵的点，一样画成最红） */
+#define HEAT_SCORE_LOW   76
+#define HEAT_SCORE_HIGH  1600
+
+static SDL_Texture  *g_tex = NULL;
+static SDL_Renderer *g_ren = NULL;
+static int           g_enabled = 0;
+static SDL_atomic_t  g_lost;
+
+/* 上次算分时的局面，和上次传进纹理的颜色 */
+static Cell   g_cells[BOARD_SIZE][BOARD_SIZE];
+static int    g_player = -1;     // -1 = 还没算过
+static int    g_finished = 0;
+static int    g_scores[BOARD_SIZE][BOARD_SIZE];
+static Uint32 g_texels[BOARD_SIZE][BOARD_SIZE];
+
+void heatmap_toggle(void)
+{
+    g_enabled = !g_enabled;
+}
+
+int heatmap_enabled(void)
+{
+    return g_enabled;
+}
+
+void heatmap_lost(void)
+{
+    SDL_AtomicSet(&g_lost, 1);
+}
+
+void heatmap_release(void)
+{
+    if (g_tex) SDL_DestroyTexture(g_tex);
+    g_tex = NULL;
+    g_ren = NULL;
+    g_player = -1;
+}
+
+/* 一个分数换成一个像素（ARGB8888，不预乘）：蓝 -> 黄 -> 红，越高越不透明。
+ * 有子的点（分数 0）完全透明，颜色还用最低档的蓝，线性过滤时边上不会晕出黑边 */
+static Uint32 heat_color(int score)
+{
+    float t = 0.0f;
+    if (score > HEAT_SCORE_LOW) {
+        t = (float)(log((double)score / HEAT_SCORE_LOW) / log((double)HEAT_SCORE_HIGH / HEAT_SCORE_LOW));
+        if (t > 1.0f) t = 1.0f;
+    }
+    float r, g, b;
+    if (t < 0.5f) {
+        float u = t * 2.0f;
+        r = 40 + (240 - 40) * u;
+        g = 90 + (200 - 90) * u;
+        b = 220 + (40 - 220) * u;
+    } else {
+        float u = (t - 0.5f) * 2.0f;
+        r = 240 + (220 - 240) * u;
+        g = 200 + (30 - 200) * u;
+        b = 40 + (30 - 40) * u;
+    }
+    Uint32 a = (score > 0) ? (Uint32)(40 + 150 * t) : 0;
+    return (a << 24) | ((Uint32)r << 16) | ((Uint32)g << 8) | (Uint32)b;
+}
+
+static int ensure_texture(SDL_Renderer *ren)
+{
+    if (g_tex && g_ren == ren) return 1;
+    heatmap_release();
+    g_tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                              BOARD_SIZE, BOARD_SIZE);
+    if (!g_tex) return 0;
+    g_ren = ren;
+    SDL_SetTextureBlendMode(g_tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(g_tex, SDL_ScaleModeLinear);   // 格子之间平滑过渡
+    SDL_AtomicSet(&g_lost, 1);   // 新纹理的内容是未定义的，整张传一遍
+    return 1;
+}
+
+/* 局面变了就重算分数，把颜色变了的格子框成一个矩形传上去 */
+static void update_texture(const GameState *game)
+{
+    int full = SDL_AtomicSet(&g_lost, 0);
+    int moved = (g_player != game->current_player || g_finished != game->finished ||
+                 memcmp(g_cells, game->cells, sizeof(g_cells)) != 0);
+    if (!moved && !full) return;
+
+    int r0 = BOARD_SIZE, c0 = BOARD_SIZE, r1 = -1, c1 = -1;
+    if (moved) {
+        memcpy(g_cells, game->cells, sizeof(g_cells));
+        g_player = game->current_player;
+        g_finished = game->finished;
+        ai_score_board(game, g_scores);
+        for (int r = 0; r < BOARD_SIZE; r++) {
+            for (int c = 0; c < BOARD_SIZE; c++) {
+                Uint32 px = heat_color(g_scores[r][c]);
+                if (px == g_texels[r][c]) continue;
+                g_texels[r][c] = px;
+                if (r < r0) r0 = r;
+                if (r > r1) r1 = r;
+                if (c < c0) c0 = c;
+                if (c > c1) c1 = c;
+            }
+        }
+    }
+    if (full) {
+        r0 = c0 = 0;
+        r1 = c1 = BOARD_SIZE - 1;
+    }
+    if (r1 < 0) return;   // 分数变了但颜色一样
+
+    /* 锁住的那块内容是未定义的（可能是显卡那边的临时缓冲），要一格不落全写一遍 */
+    SDL_Rect dirty = {c0, r0, c1 - c0 + 1, r1 - r0 + 1};
+    void *pixels = NULL;
+    int pitch = 0;
+    if (SDL_LockTexture(g_tex, &dirty, &pixels, &pitch) != 0) {
+        SDL_AtomicSet(&g_lost, 1);   // 下次再试
+        return;
+    }
+    for (int r = r0; r <= r1; r++) {
+        memcpy((Uint8 *)pixels + (size_t)(r - r0) * pitch, &g_texels[r][c0],
+               (size_t)dirty.w * sizeof(Uint32));
+    }
+    SDL_UnlockTexture(g_tex);
+    perf_count_upload();
+}
+
+void heatmap_draw(SDL_Renderer *ren, const GameState *game, const SDL_Rect *dst)
+{
+    if (!g_enabled || !ren || !game || !dst) return;
+    if (!ensure_texture(ren)) return;
+    update_texture(game);
+    SDL_RenderCopy(ren, g_tex, NULL, dst);
+    perf_count_draw(1);
+}
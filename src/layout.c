@@ -0,0 +1,150 @@
+/*
+ * layout.c
+ * 界面布局表（见 layout.h）。下面的数字都是 640×640 设计尺寸里的坐标。
+ */
+
+#include "layout.h"
+#include "game.h"
+
+static Layout g_layout = {
+    LAYOUT_DESIGN_SIZE, LAYOUT_DESIGN_SIZE, 1.0f, 0, 0, 1.0f, 1.0f,
+    40, 40, (LAYOUT_DESIGN_SIZE - 80) / (BOARD_SIZE - 1), 0
+};
+static int g_win_w = 0, g_win_h = 0;   // 上次的窗口大小（鼠标坐标换算用）
+
+/* 棋盘四周留白 */
+#define BOARD_MARGIN 40
+
+static void compute(int w, int h, int win_w, int win_h)
+{
+    Layout *l = &g_layout;
+    int side = (w < h) ? w : h;
+    l->w = w;
+    l->h = h;
+    l->scale = (float)side / LAYOUT_DESIGN_SIZE;
+    l->ox = (w - side) / 2;
+    l->oy = (h - side) / 2;
+    l->mouse_sx = (win_w > 0) ? (float)w / win_w : 1.0f;
+    l->mouse_sy = (win_h > 0) ? (float)h / win_h : 1.0f;
+
+    int margin = ui_px(BOARD_MARGIN);
+    l->cell = (side - 2 * margin) / (BOARD_SIZE - 1);
+    l->board_x = l->ox + margin;
+    l->board_y = l->oy + margin;
+    l->generation++;
+}
+
+int layout_sync(SDL_Renderer *ren)
+{
+    int w = 0, h = 0;
+    if (!ren || SDL_GetRendererOutputSize(ren, &w, &h) != 0 || w <= 0 || h <= 0) return 0;
+    int win_w = w, win_h = h;
+    SDL_Window *win = SDL_RenderGetWindow(ren);
+    if (win) SDL_GetWindowSize(win, &win_w, &win_h);
+
+    if (g_layout.generation && w == g_layout.w && h == g_layout.h &&
+        win_w == g_win_w && win_h == g_win_h) {
+        return 0;
+    }
+    g_win_w = win_w;
+    g_win_h = win_h;
+    compute(w, h, win_w, win_h);
+    return 1;
+}
+
+const Layout *layout_get(void)
+{
+    return &g_layout;
+}
+
+int ui_px(int design)
+{
+    float v = design * g_layout.scale;
+    return (int)(v < 0 ? v - 0.5f : v + 0.5f);
+}
+
+SDL_Rect ui_rect(int x, int y, int w, int h)
+{
+    SDL_Rect r;
+    r.x = g_layout.ox + ui_px(x);
+    r.y = g_layout.oy + ui_px(y);
+    r.w = ui_px(w);
+    r.h = ui_px(h);
+    return r;
+}
+
+SDL_Rect ui_full(void)
+{
+    SDL_Rect r = {0, 0, g_layout.w, g_layout.h};
+    return r;
+}
+
+void layout_mouse(int *x, int *y)
+{
+    if (x) *x = (int)(*x * g_layout.mouse_sx);
+    if (y) *y = (int)(*y * g_layout.mouse_sy);
+}
+
+static int add(UiButton *out, int n, UiId id, int row, SDL_Rect r)
+{
+    out[n].id = id;
+    out[n].row = row;
+    out[n].rect = r;
+    return n + 1;
+}
+
+int layout_buttons(UiScreen screen, int rows, int paged, UiButton *out)
+{
+    int n = 0;
+    switch (screen) {
+    case UI_SCREEN_MAIN:
+        /* 五个竖着排的长按钮 */
+        for (int i = 0; i < 5; i++) {
+            n = add(out, n, (UiId)(UI_MAIN_RESUME + i), 0, ui_rect(80, 80 + i * 80, 480, 60));
+        }
+        break;
+    case UI_SCREEN_AI:
+        for (int i = 0; i < 4; i++) {
+            n = add(out, n, (UiId)(UI_AI_EASY + i), 0, ui_rect(80, 120 + i * 80, 480, 60));
+        }
+        break;
+    case UI_SCREEN_LIST:
+        /* 每行：左边“第 N 轮”按钮，右边“删除”小按钮 */
+        if (rows > PLAYLIST_MAX_ROWS) rows = PLAYLIST_MAX_ROWS;
+        for (int i = 0; i < rows; i++) {
+            int y = 110 + i * 66;
+            n = add(out, n, UI_LIST_PLAY, i, ui_rect(80, y, 380, 52));
+            n = add(out, n, UI_LIST_DELETE, i, ui_rect(470, y, 90, 52));
+        }
+        /* 翻页按钮（记录多时才有） */
+        if (paged) {
+            n = add(out, n, UI_LIST_PREV, 0, ui_rect(60, 560, 120, 50));
+            n = add(out, n, UI_LIST_NEXT, 0, ui_rect(460, 560, 120, 50));
+        }
+        n = add(out, n, UI_LIST_BACK, 0, ui_rect(200, 560, 240, 50));
+        break;
+    case UI_SCREEN_LIST_EMPTY:
+        n = add(out, n, UI_LIST_BACK, 0, ui_rect(200, 560, 240, 50));
+        break;
+    case UI_SCREEN_END:
+        n = add(out, n, UI_END_AGAIN, 0, ui_rect(80, 280, 220, 80));
+        n = add(out, n, UI_END_MENU, 0, ui_rect(340, 280, 220, 80));
+        break;
+    }
+    return n;
+}
+
+UiId layout_hit(UiScreen screen, int rows, int paged, int x, int y, int *row)
+{
+    UiButton buttons[LAYOUT_MAX_BUTTONS];
+    int n = layout_buttons(screen, rows, paged, buttons);
+    layout_mouse(&x, &y);
+    for (int i = 0; i < n; i++) {
+        const SDL_Rect *r = &buttons[i].rect;
+        if (x >= r->x && x <= r->x + r->w && y >= r->y && y <= r->y + r->h) {
+            if (row) *row = buttons[i].row;
+            return buttons[i].id;
+        }
+    }
+    return UI_NONE;
+}
@@ -0,0 +1,450 @@
+/*
+ * lzblock.c
+ *
+ * 块压缩归档的实现：一个小巧的 LZ77 压缩器 + 归档文件读写。
+ *
+ * 压缩流是一串“序列”，每个序列：
+ *     token（高 4 位 = 字面量长度，低 4 位 = 匹配长度 - 4；等于 15 时后面跟扩展字节）
+ *     字面量
+ *     匹配偏移（16 位小端） + 扩展的匹配长度
+ * 最后一个序列只有字面量，没有匹配。
+ */
+
+#include "lzblock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_MATCH   4
+#define HASH_BITS   14
+#define HASH_SIZE   (1 << HASH_BITS)
+#define CHAIN_DEPTH 32   /* 每个位置最多往回找多少个候选 */
+
+static const char LZB_MAGIC[4] = {'S', 'I', 'X', 'Z'};
+static const uint32_t LZB_VERSION = 1;
+
+/* 取 4 个字节算哈希 */
+static uint32_t hash4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/* 写一个扩展长度（LZ4 风格：一串 255，最后一个 <255 的字节） */
+static uint8_t *put_len(uint8_t *op, size_t len)
+{
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/* 在 pos 处沿哈希链找最长匹配，返回长度（不足 MIN_MATCH 返回 0） */
+static size_t find_match(const uint8_t *src, size_t n, size_t pos,
+                         const int32_t *head, const int32_t *prev, size_t *best_off)
+{
+    if (pos + MIN_MATCH > n) return 0;
+    size_t best = 0;
+    int32_t cand = head[hash4(src + pos)];
+    for (int depth = 0; cand >= 0 && depth < CHAIN_DEPTH; depth++) {
+        size_t c = (size_t)cand;
+        if (pos - c > 65535) break;
+        if (pos + best < n && src[c + best] == src[pos + best]) {
+            size_t len = 0;
+            while (pos + len < n && src[c + len] == src[pos + len]) len++;
+            if (len > best) {
+                best = len;
+                *best_off = pos - c;
+            }
+        }
+        cand = prev[c];
+    }
+    return best >= MIN_MATCH ? best : 0;
+}
+
+/* 把 pos 插入哈希链 */
+static void insert_pos(const uint8_t *src, size_t n, size_t pos, int32_t *head, int32_t *prev)
+{
+    if (pos + MIN_MATCH > n) return;
+    uint32_t h = hash4(src + pos);
+    prev[pos] = head[h];
+    head[h] = (int32_t)pos;
+}
+
+/* 输出一个序列：字面量 [lit, lit+lit_len) + 匹配（match_len 为 0 表示结尾序列） */
+static uint8_t *emit(uint8_t *op, const uint8_t *lit, size_t lit_len, size_t off, size_t match_len)
+{
+    uint8_t *token = op++;
+    size_t ml = match_len ? match_len - MIN_MATCH : 0;
+    *token = (uint8_t)(((lit_len < 15 ? lit_len : 15) << 4) | (ml < 15 ? ml : 15));
+    if (lit_len >= 15) op = put_len(op, lit_len - 15);
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (match_len) {
+        *op++ = (uint8_t)(off & 0xFF);
+        *op++ = (uint8_t)(off >> 8);
+        if (ml >= 15) op = put_len(op, ml - 15);
+    }
+    return op;
+}
+
+size_t lz_compress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap)
+{
+    if (!src || !dst || n > LZB_BLOCK_SIZE || cap < LZ_COMPRESS_BOUND(n)) return 0;
+
+    int32_t *head = (int32_t *)malloc(HASH_SIZE * sizeof(int32_t));
+    int32_t *prev = (int32_t *)malloc((n ? n : 1) * sizeof(int32_t));
+    if (!head || !prev) {
+        free(head);
+        free(prev);
+        return 0;
+    }
+    for (int i = 0; i < HASH_SIZE; i++) head[i] = -1;
+
+    uint8_t *op = dst;
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos < n) {
+        size_t off = 0;
+        size_t len = find_match(src, n, pos, head, prev, &off);
+        if (!len) {
+            insert_pos(src, n, pos, head, prev);
+            pos++;
+            continue;
+        }
+        /* 懒惰匹配：下一个位置如果能匹配得更长，就先把当前字节当字面量 */
+        insert_pos(src, n, pos, head, prev);
+        size_t off2 = 0;
+        size_t len2 = find_match(src, n, pos + 1, head, prev, &off2);
+        if (len2 > len + 1) {
+            pos++;
+            continue;
+        }
+
+        op = emit(op, src + anchor, pos - anchor, off, len);
+        for (size_t k = 1; k < len; k++) insert_pos(src, n, pos + k, head, prev);
+        pos += len;
+        anchor = pos;
+    }
+    op = emit(op, src + anchor, n - anchor, 0, 0);
+
+    free(head);
+    free(prev);
+    return (size_t)(op - dst);
+}
+
+size_t lz_decompress(const uint8_t *src, size_t n, uint8_t *dst, size_t cap)
+{
+    const uint8_t *ip = src;
+    const uint8_t *end = src + n;
+    size_t out = 0;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t lit = token >> 4;
+        if (lit == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return 0;
+                b = *ip++;
+                lit += b;
+            } while (b == 255);
+        }
+        if ((size_t)(end - ip) < lit || cap - out < lit) return 0;
+        memcpy(dst + out, ip, lit);
+        ip += lit;
+        out += lit;
+
+        if (ip >= end) break; /* 结尾序列没有匹配部分 */
+
+        if (end - ip < 2) return 0;
+        size_t off = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t ml = token & 15;
+        if (ml == 15) {
+            uint8_t b;
+            do {
+                if (ip >= end) return 0;
+                b = *ip++;
+                ml += b;
+            } while (b == 255);
+        }
+        ml += MIN_MATCH;
+        if (off == 0 || off > out || cap - out < ml) return 0;
+        /* 匹配可能和输出重叠（比如重复的 ,{"p":）：不重叠时整段 memcpy，
+         * 偏移 >= 8 时按 8 字节一组拷（每组内部不重叠），更近的才逐字节拷 */
+        uint8_t *d = dst + out;
+        const uint8_t *m = d - off;
+        if (off >= ml) {
+            memcpy(d, m, ml);
+        } else {
+            size_t k = 0;
+            if (off >= 8) {
+                for (; k + 8 <= ml; k += 8) memcpy(d + k, m + k, 8);
+            }
+            for (; k < ml; k++) d[k] = m[k];
+        }
+        out += ml;
+    }
+    return out;
+}
+
+/* ========== 归档文件 ========== */
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* 读整个文件到内存 */
+static uint8_t *read_file(const char *path, size_t *out_len)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    fseek(fp, 0, SEEK_END);
+    long sz = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (sz < 0) {
+        fclose(fp);
+        return NULL;
+    }
+    uint8_t *buf = (uint8_t *)malloc((size_t)sz + 1);
+    if (!buf) {
+        fclose(fp);
+        return NULL;
+    }
+    size_t got = fread(buf, 1, (size_t)sz, fp);
+    fclose(fp);
+    buf[got] = '\0';
+    *out_len = got;
+    return buf;
+}
+
+int lzb_write_segment(const char *json_path, const char *lzb_path)
+{
+    size_t n = 0;
+    uint8_t *text = read_file(json_path, &n);
+    if (!text) return 0;
+
+    /* 第一遍：切块（记录不跨块），顺便数记录数 */
+    uint32_t nrec = 0, nblk = 0;
+    size_t blk_fill = 0;
+    for (size_t i = 0; i < n; ) {
+        size_t j = i;
+        while (j < n && text[j] != '\n') j++;
+        size_t len = (j < n ? j + 1 : j) - i;
+        if (len > 1) {
+            if (nblk == 0 || blk_fill + len > LZB_BLOCK_SIZE) {
+                nblk++;
+                blk_fill = 0;
+            }
+            blk_fill += len;
+            nrec++;
+        }
+        i += len;
+    }
+
+    size_t table_bytes = 16 + (size_t)nblk * 12 + (size_t)nrec * 8;
+    uint8_t *table = (uint8_t *)calloc(1, table_bytes);
+    uint8_t *raw = (uint8_t *)malloc(LZB_BLOCK_SIZE);
+    uint8_t *comp = (uint8_t *)malloc(LZ_COMPRESS_BOUND(LZB_BLOCK_SIZE));
+    char tmp[256];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", lzb_path);
+    FILE *fp = fopen(tmp, "wb");
+    int ok = (table && raw && comp && fp);
+
+    if (ok) {
+        memcpy(table, LZB_MAGIC, 4);
+        put_u32(table + 4, LZB_VERSION);
+        put_u32(table + 8, nblk);
+        put_u32(table + 12, nrec);
+        /* 先占位，数据写完再回填块表和记录表 */
+        ok = fwrite(table, 1, table_bytes, fp) == table_bytes;
+    }
+
+    uint32_t blk = 0, rec = 0;
+    size_t fill = 0;
+    uint32_t file_off = (uint32_t)table_bytes;
+    size_t i = 0;
+    while (ok) {
+        /* 取下一条记录；没有了或者块放不下时，先把当前块压缩写出 */
+        size_t len = 0;
+        while (i < n) {
+            size_t j = i;
+            while (j < n && text[j] != '\n') j++;
+            len = (j < n ? j + 1 : j) - i;
+            if (len > 1) break;
+            i += len;
+            len = 0;
+        }
+        if (fill > 0 && (len == 0 || fill + len > LZB_BLOCK_SIZE)) {
+            size_t clen = lz_compress(raw, fill, comp, LZ_COMPRESS_BOUND(LZB_BLOCK_SIZE));
+            if (!clen || fwrite(comp, 1, clen, fp) != clen) {
+                ok = 0;
+                break;
+            }
+            uint8_t *e = table + 16 + (size_t)blk * 12;
+            put_u32(e, file_off);
+            put_u32(e + 4, (uint32_t)clen);
+            put_u32(e + 8, (uint32_t)fill);
+            file_off += (uint32_t)clen;
+            blk++;
+            fill = 0;
+        }
+        if (len == 0) break;
+        if (len > LZB_BLOCK_SIZE) { /* 单条记录超过一个块，不可能出现，保险起见 */
+            ok = 0;
+            break;
+        }
+        uint8_t *r = table + 16 + (size_t)nblk * 12 + (size_t)rec * 8;
+        put_u32(r, blk);
+        put_u32(r + 4, (uint32_t)fill);
+        memcpy(raw + fill, text + i, len);
+        if (raw[fill + len - 1] != '\n') ok = 0; /* 段文件最后一行没换行：交给调用者退回未压缩 */
+        fill += len;
+        rec++;
+        i += len;
+    }
+
+    if (ok) {
+        ok = (fseek(fp, 0, SEEK_SET) == 0) && fwrite(table, 1, table_bytes, fp) == table_bytes;
+    }
+    if (fp) {
+        if (fclose(fp) != 0) ok = 0;
+    }
+    free(text);
+    free(table);
+    free(raw);
+    free(comp);
+
+    if (!ok) {
+        remove(tmp);
+        return 0;
+    }
+    remove(lzb_path);
+    if (rename(tmp, lzb_path) != 0) {
+        remove(tmp);
+        return 0;
+    }
+    return 1;
+}
+
+/* 读头部，校验魔数，拿到块数和记录数 */
+static int read_header(FILE *fp, uint32_t *nblk, uint32_t *nrec)
+{
+    uint8_t h[16];
+    if (fread(h, 1, 16, fp) != 16) return 0;
+    if (memcmp(h, LZB_MAGIC, 4) != 0 || get_u32(h + 4) != LZB_VERSION) return 0;
+    *nblk = get_u32(h + 8);
+    *nrec = get_u32(h + 12);
+    return 1;
+}
+
+/* 把第 b 块解压到 dst（至少 LZB_BLOCK_SIZE 字节）。comp 是调用者给的压缩数据缓冲区 */
+static int read_block_into(FILE *fp, uint32_t b, uint8_t *comp, uint8_t *dst, size_t *raw_len)
+{
+    uint8_t e[12];
+    if (fseek(fp, 16 + (long)b * 12, SEEK_SET) != 0 || fread(e, 1, 12, fp) != 12) return 0;
+    uint32_t off = get_u32(e), clen = get_u32(e + 4), rlen = get_u32(e + 8);
+    if (rlen > LZB_BLOCK_SIZE || clen > LZ_COMPRESS_BOUND(LZB_BLOCK_SIZE)) return 0;
+    if (fseek(fp, (long)off, SEEK_SET) != 0 ||
+        fread(comp, 1, clen, fp) != clen ||
+        lz_decompress(comp, clen, dst, rlen) != rlen) {
+        return 0;
+    }
+    *raw_len = rlen;
+    return 1;
+}
+
+static uint8_t *load_block(FILE *fp, uint32_t b, size_t *raw_len)
+{
+    uint8_t *comp = (uint8_t *)malloc(LZ_COMPRESS_BOUND(LZB_BLOCK_SIZE));
+    uint8_t *raw = (uint8_t *)malloc(LZB_BLOCK_SIZE + 1);
+    if (!comp || !raw || !read_block_into(fp, b, comp, raw, raw_len)) {
+        free(comp);
+        free(raw);
+        return NULL;
+    }
+    free(comp);
+    raw[*raw_len] = '\0';
+    return raw;
+}
+
+char *lzb_read_record(const char *lzb_path, int local)
+{
+    FILE *fp = fopen(lzb_path, "rb");
+    if (!fp) return NULL;
+
+    uint32_t nblk, nrec;
+    uint8_t r[8];
+    char *line = NULL;
+    if (read_header(fp, &nblk, &nrec) && local >= 0 && (uint32_t)local < nrec &&
+        fseek(fp, 16 + (long)nblk * 12 + (long)local * 8, SEEK_SET) == 0 &&
+        fread(r, 1, 8, fp) == 8 && get_u32(r) < nblk) {
+        size_t rlen = 0;
+        uint8_t *raw = load_block(fp, get_u32(r), &rlen);
+        uint32_t off = get_u32(r + 4);
+        if (raw && off < rlen) {
+            const uint8_t *s = raw + off;
+            const uint8_t *e = memchr(s, '\n', rlen - off);
+            size_t len = e ? (size_t)(e - s) + 1 : rlen - off;
+            line = (char *)malloc(len + 1);
+            if (line) {
+                memcpy(line, s, len);
+                line[len] = '\0';
+            }
+        }
+        free(raw);
+    }
+    fclose(fp);
+    return line;
+}
+
+char *lzb_read_all(const char *lzb_path, size_t *out_len)
+{
+    FILE *fp = fopen(lzb_path, "rb");
+    if (!fp) return NULL;
+
+    uint32_t nblk, nrec;
+    if (!read_header(fp, &nblk, &nrec)) {
+        fclose(fp);
+        return NULL;
+    }
+    /* 每块直接解压到最终缓冲区里，不再经过临时块 */
+    size_t cap = (size_t)nblk * LZB_BLOCK_SIZE + 1;
+    char *all = (char *)malloc(cap);
+    uint8_t *comp = (uint8_t *)malloc(LZ_COMPRESS_BOUND(LZB_BLOCK_SIZE));
+    size_t total = 0;
+    for (uint32_t b = 0; all && comp && b < nblk; b++) {
+        size_t rlen = 0;
+        if (!read_block_into(fp, b, comp, (uint8_t *)all + total, &rlen)) {
+            free(all);
+            all = NULL;
+            break;
+        }
+        total += rlen;
+    }
+    if (!comp) {
+        free(all);
+        all = NULL;
+    }
+    free(comp);
+    fclose(fp);
+    if (all) {
+        all[total] = '\0';
+        if (out_len) *out_len = total;
+    }
+    return all;
+}
@@ -29,14 +29,16 @@
 #include "gui.h"     // 图形界面（绘制棋盘、按钮等）
 #include "ai.h"      // 人工智能（电脑下棋的逻辑）
 #include "fileio.h"  // 文件读写（保存和加载对局记录）
+#include "playlist.h" // 回放列表的分页数据源（后台预取摘要）
+#include "replay.h"   // 回放用的关键帧索引（任意跳转）
+#include "stats.h"    // 累计战绩（跨启动保存的统计）
+#include "resource.h" // 字体、图片等进程级资源（只加载一次）
+#include "heatmap.h"  // 估值热力图（H 键）
+#include "perf.h"     // 性能计数（F3 性能面板）
+#include "layout.h"   // 界面布局表（按钮位置，画和点共用）
 #include "utils.h"   // 小工具函数（一些杂项）
 
-/* 
- * 回放历史对局时，每步之间的延迟时间（单位：毫秒）
- * 300 毫秒 = 0.3 秒，意思是在回放时，每下一步棋等待 0.3 秒再显示下一步
- * 这样用户才能看清楚每一步是怎么下的
- */
-static const int PLAYBACK_INTERVAL = 300;
+/* 回放每步之间的间隔（1 倍速 300 毫秒）和速度档位在 replay.h 里（REPLAY_BASE_INTERVAL_MS） */
 
 /* ========== 第三部分：全局变量（整个程序都可以用的数据） ========== */
 
@@ -46,6 +48,22 @@ static int score_pvp_white = 0;
 static int score_ai_black = 0;
 static int score_ai_white = 0;
 
+/* 整个程序只有一个窗口和一个渲染器：main 里创建一次，所有界面（场景）共用，
+ * 切换界面只是换一个场景函数来画，不再销毁、重建窗口（有些驱动上要几百毫秒，还会闪） */
+static SDL_Window   *g_win = NULL;
+static SDL_Renderer *g_ren = NULL;
+
+/* 场景：主菜单选完之后切到哪一个 */
+typedef enum {
+    SCENE_MENU = 0,      // 主菜单（含人机难度子菜单）
+    SCENE_RESUME,        // 继续上次对局
+    SCENE_GAME,          // 新开一局（模式见 g_scene_mode）
+    SCENE_PLAYBACK,      // 回放列表
+    SCENE_QUIT
+} Scene;
+
+static int g_scene_mode = 1;   // SCENE_GAME 用：1 双人，2/3/4 人机简单/中级/困难
+
 /* 这些变量用来控制游戏的音效（下棋时的"点击"声）；audio_dev： */
 static SDL_AudioDeviceID audio_dev = 0;  // 音频设备的 ID
 static double click_phase = 0.0;         // 声音相位，用于生成正弦波
@@ -155,6 +173,71 @@ static void close_audio(void)
 
 /* ========== 第五部分：游戏核心函数 ========== */
 
+/* 等下一个事件：有事件立刻返回 1；没有就睡到 deadline（SDL_GetTicks 的时刻）为止，超时返回 0。
+ * deadline 为 0 表示没有要按时做的事，一直睡到有事件为止。
+ * 以前每个循环都是 PollEvent + SDL_Delay(10)，什么都没发生也每秒转 100 圈、重画 100 次；
+ * 现在没有输入、没有到点的任务时进程就睡着，输入一来立刻醒。 */
+static int wait_event_until(SDL_Event *e, Uint32 deadline)
+{
+    perf_count_wakeup();
+    if (deadline == 0) return SDL_WaitEvent(e);
+    Sint32 left = (Sint32)(deadline - SDL_GetTicks());
+    if (left <= 0) return SDL_PollEvent(e);
+    return SDL_WaitEventTimeout(e, (int)left);
+}
+
+/* 两个时刻取早的那个；0 表示“没有” */
+static Uint32 earlier_deadline(Uint32 a, Uint32 b)
+{
+    if (a == 0) return b;
+    if (b == 0) return a;
+    return ((Sint32)(a - b) <= 0) ? a : b;
+}
+
+/* F3 性能面板开着时，数字到点了就要重画一帧 */
+static int perf_refresh_due(void)
+{
+    Uint32 t = perf_next_refresh();
+    return t != 0 && (Sint32)(SDL_GetTicks() - t) >= 0;
+}
+
+/* 落子动画没播完：到点了就要再画一帧 */
+static int anim_frame_due(void)
+{
+    Uint32 t = gui_anim_next_frame();
+    return t != 0 && (Sint32)(SDL_GetTicks() - t) >= 0;
+}
+
+/* 让电脑走一步，顺便记下用时和看过的局面数（给性能面板） */
+static void timed_ai_move(GameState *game, int difficulty)
+{
+    Uint64 t0 = perf_now();
+    ai_move(game, difficulty);
+    perf_set_ai(perf_ms_since(t0), ai_last_nodes());
+}
+
+/* 存续玩档，顺便记下读写用时 */
+static void timed_save_resume(const GameState *game, int mode, int elapsed)
+{
+    Uint64 t0 = perf_now();
+    save_resume_game(game, mode, elapsed);
+    perf_set_io(perf_ms_since(t0));
+}
+
+/* 窗口标题：本次启动的比分 + 这个模式的累计战绩（stats.bin 里直接读，不扫存档） */
+static void set_score_title(SDL_Window *win, int mode, int sb, int sw)
+{
+    char title[192];
+    int n = snprintf(title, sizeof(title), "六子棋(%s) - 黑:%d 白:%d", stats_mode_name(mode), sb, sw);
+    StatTotals t;
+    if (stats_totals(mode, &t) && t.games > 0 && n > 0 && n < (int)sizeof(title)) {
+        int avg = (int)(stats_avg_seconds(&t) + 0.5);
+        snprintf(title + n, sizeof(title) - (size_t)n, " | 累计 %d 盘 黑胜 %d 白胜 %d 均 %.0f 手 %d:%02d",
+                 t.games, t.black_wins, t.white_wins, stats_avg_moves(&t), avg / 60, avg % 60);
+    }
+    SDL_SetWindowTitle(win, title);
+}
+
 /* 执行一局游戏；- snprintf() : 来自 <stdio.h>，格式化字符串（类似 printf，但写入到缓冲区） */
 static void run_game_internal(int mode, const GameState *resume_state, int resume_elapsed)
 {
@@ -165,46 +248,22 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
     /* 如果是从“继续上次对局”进来的，只在第一盘用存档状态。 */
     int first_round = 1;
 
-    /* ========== 第一步：创建游戏窗口 ========== */
+    /* ========== 第一步：拿到游戏窗口 ========== */
     
-    // 定义两个变量用来存储窗口和渲染器
+    // 窗口和渲染器是 main 里创建好的那一份（所有界面共用）
     // SDL_Window 是窗口
     // SDL_Renderer 是渲染器（用来在窗口上画东西，
-    SDL_Window *win = NULL;
-    SDL_Renderer *ren = NULL;
-    
-    // 初始化图形界面（创建窗口和渲染器）
-    // gui_init 函数会创建窗口，并把窗口和渲染器的地址存到 win 和 ren 里
-    if (gui_init(&win, &ren) != 0) {
-        printf("图形界面初始化失败\n");
-        return;  // 如果初始化失败，直接退出函数
-    }
-    
-    // 设置窗口标题，显示当前比分
-    // 比如："六子棋 - 黑:2 白:1" 表示黑棋赢了 2 局，白棋赢了 1 局
-    char titleBuf[64];  // 创建一个字符串数组，用来存放标题文字
-    {
-        int sb = 0, sw = 0;
-        const char *mode_text = "双人";
-        if (mode == 1) {
-            sb = score_pvp_black;
-            sw = score_pvp_white;
-            mode_text = "双人";
-        } else {
-            sb = score_ai_black;
-            sw = score_ai_white;
-            if (mode == 2) mode_text = "人机-简单";
-            if (mode == 3) mode_text = "人机-中级";
-            if (mode == 4) mode_text = "人机-困难";
-        }
-        snprintf(titleBuf, sizeof(titleBuf), "六子棋(%s) - 黑:%d 白:%d", mode_text, sb, sw);
-        SDL_SetWindowTitle(win, titleBuf);
-    }  // 把标题设置到窗口上
+    SDL_Window *win = g_win;
+    SDL_Renderer *ren = g_ren;
     
     /* 选好“当前模式对应的计分板”——双人和人机分开算。 */
     int *score_black_ptr = (mode == 1) ? &score_pvp_black : &score_ai_black;
     int *score_white_ptr = (mode == 1) ? &score_pvp_white : &score_ai_white;
 
+    // 设置窗口标题，显示当前比分和这个模式的历史总战绩
+    // 比如："六子棋(双人) - 黑:2 白:1 | 累计 35 盘 黑胜 20 白胜 13 均 41 手 3:05"
+    set_score_title(win, mode, *score_black_ptr, *score_white_ptr);
+
 /* ========== 外层循环：可以连续玩多局游戏 ========== */
     
     // 只要 continuePlaying 是 1（继续玩），就一直循环
@@ -240,7 +299,7 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
             /* 极少数情况下，存档时轮到 AI：继续后直接让 AI 走一步。 */
             if (!game_over && mode >= 2 && mode <= 4 && game.current_player == 2) {
                 int before = game.moves_count;
-                ai_move(&game, mode - 1);
+                timed_ai_move(&game, mode - 1);
 
                 if (game.moves_count > before) {
                     play_click_sound();
@@ -252,6 +311,11 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
 
         first_round = 0;  /* 只第一盘用存档 */
 
+        /* 脏标记：落子、悔棋、窗口被遮挡/恢复时置 1；计时器跳秒也要重画。
+         * 别的时候画面没变，就不重画 */
+        int dirty = 1;
+        int shown_seconds = -1;
+
         /* ========== 内层循环：游戏进行中的每一帧 ========== */
         
         // 只要 running 是 1（游戏还在进行），就一直循环
@@ -263,15 +327,34 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
             //
             SDL_Event e;
             
-            // SDL_PollEvent 会检查是否有新的事件（比如用户点击了鼠标）
-            // 这个循环会把所有待处理的事件都处理完
-            while (SDL_PollEvent(&e)) {
+            // 没事的时候睡着等：最多睡到右上角计时器该跳下一秒的时候
+            // 有事件就立刻醒，然后把所有待处理的事件都处理完
+            // F3 性能面板开着时，还要按时醒来刷新面板上的数字
+            Uint32 deadline = game_over ? 0 : start_ticks + (Uint32)(shown_seconds + 1) * 1000;
+            deadline = earlier_deadline(deadline, perf_next_refresh());
+            deadline = earlier_deadline(deadline, gui_anim_next_frame());
+            for (int have = wait_event_until(&e, deadline); have; have = SDL_PollEvent(&e)) {
+                if (e.type == SDL_WINDOWEVENT) {
+                    dirty = 1;   // 窗口被遮挡/恢复后补画一帧
+                }
+                /* F3：打开/关闭性能面板（结束后也能按） */
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3) {
+                    perf_toggle();
+                    dirty = 1;
+                    continue;
+                }
+                /* H：打开/关闭估值热力图 */
+                if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_h) {
+                    heatmap_toggle();
+                    dirty = 1;
+                    continue;
+                }
                 // 如果用户点击了窗口的关闭按钮（右上角的 ×）
                 if (e.type == SDL_QUIT) {
                     /* 关窗口也算“中途退出”：帮你把局面存一份，回主菜单就能继续。 */
                     if (!game_over) {
                         int elapsed = (int)((SDL_GetTicks() - start_ticks) / 1000);
-                        save_resume_game(&game, mode, elapsed);
+                        timed_save_resume(&game, mode, elapsed);
                     }
 
                     running = 0;         // 退出内层循环（这局游戏结束）
@@ -286,7 +369,7 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                     /* ESC：保存并退出到主菜单（以后可以“继续上次对局”）。 */
                     if (key == SDLK_ESCAPE) {
                         int elapsed = (int)((SDL_GetTicks() - start_ticks) / 1000);
-                        save_resume_game(&game, mode, elapsed);
+                        timed_save_resume(&game, mode, elapsed);
 
                         running = 0;
                         continuePlaying = 0;
@@ -319,6 +402,7 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
 
                         if (did) {
                             game.undo_count++;
+                            dirty = 1;
                         }
                     }
                 }
@@ -370,6 +454,7 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                             
                             // 播放"滴"的一声，让用户知道已经成功下棋了
                             play_click_sound();
+                            dirty = 1;  // 棋盘变了，要重画
                             
                             // ========== 第四步：检查是否有人赢了 ==========
                             
@@ -402,7 +487,7 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                                 if ((mode >= 2 && mode <= 4) && game.current_player == 2) {
                                     // 调用 AI 函数计算电脑的下一步
                                     // 对应模式：mode-1 即难度等级（2->1 简单，3->2 中级，4->3 困难）
-                                    ai_move(&game, mode - 1);
+                                    timed_ai_move(&game, mode - 1);
                                     
                                     // ai_move 函数内部已经调用了 place_stone() 并把步数记录到 moves 数组了
                                     // 所以我们这里不需要再记录
@@ -426,26 +511,40 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                 }
             }
             
+            if (!running) break;
+
             /* ========== 渲染画面（把棋盘画到屏幕上） ========== */
-            
-            // 绘制棋盘和棋子
-            //   - 最后一步的标记（通常用圆圈或高亮显示）
-            draw_game(ren, &game);
-            
-            // 绘制计分板（显示黑棋和白棋各赢了多少局）
-            // 计分板的分数在"再来一局"时保持不变
-            // 只有程序重新启动时才会清零
-            draw_scoreboard(ren, *score_black_ptr, *score_white_ptr);
 
-            /* 右上角 HUD：计时器 + 悔棋次数 */
+            /* 计时器只显示到秒：秒数变了才需要重画 */
             int elapsed_seconds = (int)((SDL_GetTicks() - start_ticks) / 1000);
-            draw_timer(ren, elapsed_seconds);
-            draw_undo_count(ren, game.undo_count);
-            
-            // 把所有绘制的内容显示到窗口上
-            // 之前的所有 draw_xxx 函数只是在内存中"画"好了，还没有真正显示
-            // SDL_RenderPresent
-            SDL_RenderPresent(ren);
+            if (!game_over && elapsed_seconds != shown_seconds) dirty = 1;
+            if (perf_refresh_due() || anim_frame_due()) dirty = 1;
+
+            if (dirty) {
+                perf_frame_begin();
+
+                // 绘制棋盘和棋子
+                //   - 最后一步的标记（通常用圆圈或高亮显示）
+                draw_game(ren, &game);
+
+                // 绘制计分板（显示黑棋和白棋各赢了多少局）
+                // 计分板的分数在"再来一局"时保持不变
+                // 只有程序重新启动时才会清零
+                draw_scoreboard(ren, *score_black_ptr, *score_white_ptr);
+
+                /* 右上角 HUD：计时器 + 悔棋次数 */
+                draw_timer(ren, elapsed_seconds);
+                draw_undo_count(ren, game.undo_count);
+                if (perf_enabled()) draw_perf_overlay(ren, perf_stats());
+
+                // 把所有绘制的内容显示到窗口上
+                // 之前的所有 draw_xxx 函数只是在内存中"画"好了，还没有真正显示
+                // SDL_RenderPresent
+                SDL_RenderPresent(ren);
+                perf_frame_end();
+                dirty = 0;
+                shown_seconds = elapsed_seconds;
+            }
             /* ========== 游戏结束后的处理 ========== */
             
             // 如果游戏已经结束（有人赢了或平局）
@@ -461,30 +560,25 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                 }
                 // 如果是平局（winner == 0），双方都不加分
                 
-                // 更新窗口标题，显示最新的比分
-                // 比如原来显示"六子棋 - 黑:2 白:1"，黑方又赢了一局后变成"六子棋 - 黑:3 白:1"
-                char tb[64];
-                {
-                    int sb = *score_black_ptr;
-                    int sw = *score_white_ptr;
-                    const char *mode_text = (mode == 1 ? "双人" :
-                                             (mode == 2 ? "人机-简单" : (mode == 3 ? "人机-中级" : "人机-困难")));
-                    snprintf(tb, sizeof(tb), "六子棋(%s) - 黑:%d 白:%d", mode_text, sb, sw);
-                    SDL_SetWindowTitle(win, tb);
-                }
-                
                 // ========== 第二步：保存对局记录到文件 ==========
                 
                 // 调用 save_record 函数将当前对局保存到文件
-                // 保存的信息包括：对局时间、获胜者、每一步的详细记录
-                // 这样用户以后可以回放历史对局
-                if (save_record(&game)) {
+                // 保存的信息包括：对局时间、模式、用时、获胜者、每一步的详细记录
+                // 这样用户以后可以回放历史对局；累计统计也是在这里更新的
+                Uint64 io_start = perf_now();
+                int saved = save_record(&game, mode, (int)((SDL_GetTicks() - start_ticks) / 1000));
+                perf_set_io(perf_ms_since(io_start));
+                if (saved) {
                     // 保存成功
                     printf("对局记录已保存\n");
                 } else {
                     // 保存失败（可能是文件权限问题或磁盘空间不足）
                     fprintf(stderr, "警告：保存对局记录失败\n");
                 }
+
+                // 更新窗口标题，显示最新的比分和累计战绩
+                // 比如原来显示"黑:2 白:1"，黑方又赢了一局后变成"黑:3 白:1"
+                set_score_title(win, mode, *score_black_ptr, *score_white_ptr);
                 
                 /* 这盘已经结束了：续玩存档可以清掉了（避免菜单里一直出现“继续上次对局”）。 */
                 clear_resume_game();
@@ -492,6 +586,12 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                 // ========== 第三步：显示胜负结果 ==========
 
                 // 在显示再来一局/退出菜单之前，先显示胜负提示
+                // 最后一颗子的落子动画不播了：先把棋盘画成最终画面再盖结果
+                gui_anim_finish();
+                draw_game(ren, &game);
+                draw_scoreboard(ren, *score_black_ptr, *score_white_ptr);
+                draw_timer(ren, shown_seconds);
+                draw_undo_count(ren, game.undo_count);
                 draw_game_result(ren, game.winner);
                 // 等待一小段时间，让玩家看清胜负信息
                 SDL_Delay(1500);
@@ -511,8 +611,8 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                 // 一直循环，直到用户点击了按钮或关闭窗口
                 while (waiting) {
                     SDL_Event ev;
-                    // 处理所有事件（鼠标点击、窗口关闭等）
-                    while (SDL_PollEvent(&ev)) {
+                    // 睡着等事件（鼠标点击、窗口关闭等），来了就把积压的都处理完
+                    for (int have = wait_event_until(&ev, 0); have; have = SDL_PollEvent(&ev)) {
                         // 如果用户关闭窗口
                         if (ev.type == SDL_QUIT) {
                             // 直接退出，不再继续游戏
@@ -521,37 +621,26 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                             waiting = 0;
                             break;
                         }
+                        // 窗口被遮挡/恢复、改了大小：结束画面整个重画一遍（棋盘 + 比分 + 遮罩和按钮）
+                        else if (ev.type == SDL_WINDOWEVENT) {
+                            draw_game(ren, &game);
+                            draw_scoreboard(ren, *score_black_ptr, *score_white_ptr);
+                            draw_end_menu(ren);
+                        }
                         // 如果用户点击了鼠标左键
                         else if (ev.type == SDL_MOUSEBUTTONDOWN && ev.button.button == SDL_BUTTON_LEFT) {
-                            // 获取鼠标点击的坐标
-                            int mx = ev.button.x;  // 鼠标 x 坐标
-                            int my = ev.button.y;  // 鼠标 y 坐标
-
-                            // 定义两个按钮的位置和大小
-                            // 这些数值需要和 draw_end_menu 函数中绘制按钮的位置一致
-                            int bw = 200;   // 按钮宽度
-                            int bh = 80;    // 按钮高度
-                            int leftBtnX = (WINDOW_WIDTH / 2) - bw - 20;      // 左侧按钮的 x 坐标
-                            int topBtnY  = (WINDOW_HEIGHT / 2) - (bh / 2);    // 按钮的 y 坐标（两个按钮一样）
-
-                            // 定义两个按钮的矩形区域（位置和大小）
-                            SDL_Rect replayRect = {leftBtnX, topBtnY, bw, bh};           // "再来一局"按钮
-                            SDL_Rect quitRect   = {leftBtnX + bw + 40, topBtnY, bw, bh}; // "退出游戏"按钮（在右边）
-
-                            // 检查用户点击的是否是"再来一局"按钮（左侧按钮）
-                            // 判断方法：检查鼠标坐标是否在按钮的矩形区域内
-                            if (mx >= replayRect.x && mx <= replayRect.x + replayRect.w &&
-                                my >= replayRect.y && my <= replayRect.y + replayRect.h) {
-                                // 用户点击了"再来一局"
+                            // 按钮的位置和 draw_end_menu 画的用同一张表（layout.c），不用再抄一份坐标
+                            UiId hit = layout_hit(UI_SCREEN_END, 0, 0, ev.button.x, ev.button.y, NULL);
+
+                            // 用户点击了"再来一局"（左侧按钮）
+                            if (hit == UI_END_AGAIN) {
                                 waiting = 0;      // 停止等待
                                 running = 0;      // 结束当前局游戏（会重新开始新的一局）
                                 break;            // 跳出事件循环
                             }
 
-                            // 检查用户点击的是否是"退出游戏"按钮（右侧按钮）
-                            if (mx >= quitRect.x && mx <= quitRect.x + quitRect.w &&
-                                my >= quitRect.y && my <= quitRect.y + quitRect.h) {
-                                // 用户点击了"退出游戏"
+                            // 用户点击了"返回主菜单"（右侧按钮）
+                            if (hit == UI_END_MENU) {
                                 waiting = 0;         // 停止等待
                                 running = 0;         // 结束当前局游戏
                                 continuePlaying = 0; // 不再玩下一局（退出到主菜单）
@@ -559,22 +648,13 @@ static void run_game_internal(int mode, const GameState *resume_state, int resum
                             }
                         }
                     }
-                    // 稍微延迟一下，避免 CPU 占用过高
-                    SDL_Delay(10);  // 延迟 10 毫秒
                 }
             }
-            
-            // 每帧都延迟一下，控制游戏循环的速度
-            // 如果没有延迟，循环会运行得非常快，CPU 占用会很高
-            SDL_Delay(10);
+            // 不用再 SDL_Delay：下一圈会在 wait_event_until 里睡到有事可做
         }
     }
     
-    // ========== 游戏结束，清理资源 ==========
-    
-    // 关闭窗口和渲染器，释放资源
-    //
-    gui_quit(win, ren);
+    // 窗口不用关：回到主菜单接着用
 }
 
 
@@ -592,7 +672,10 @@ static void run_resume_game(void)
     int mode = 1;
     int elapsed = 0;
 
-    if (!load_resume_game(&game, &mode, &elapsed)) {
+    Uint64 io_start = perf_now();
+    int loaded = load_resume_game(&game, &mode, &elapsed);
+    perf_set_io(perf_ms_since(io_start));
+    if (!loaded) {
         printf("没有可继续的存档。\n");
         return;
     }
@@ -607,98 +690,179 @@ static void run_resume_game(void)
 /* 从文件读取并播放一局历史对弈；- fopen() : 打开文件（"r" 模式表示只读） */
 /* ========== 第六部分：回放功能 ========== */
 
-/* 小工具：判断鼠标点是否落在某个矩形按钮里 */
-static int point_in_rect(int x, int y, const SDL_Rect *r)
-{
-    if (!r) return 0;
-    if (x < r->x) return 0;
-    if (y < r->y) return 0;
-    if (x > r->x + r->w) return 0;
-    if (y > r->y + r->h) return 0;
-    return 1;
-}
-
-/* 播放一局：自动一手一手走，鼠标左键随时退出回放 */
+/* 播放一局：按关键帧索引随意跳转。
+ * 空格 暂停/继续，← → 单步（会自动暂停），Home/End 跳到开头/结尾，
+ * ↑ ↓（或 + -）调速度（0.1 ~ 1000 倍），
+ * 点或拖棋盘下方的进度条直接跳到那一手；Esc 或点棋盘其他地方退出回放。
+ *
+ * 自动播放由播放时钟（replay.h）按高精度时间算出“现在该第几手”，不在循环里 Delay：
+ * 没事时睡到下一手出现的时刻，有输入立刻醒；只有显示的那一手（或状态、速度）变了才重画，
+ * 倍速高到一帧要走好几手时就直接跳过去，画面跟着显示器的刷新走。 */
 static void playback_one_game(SDL_Renderer *ren, const GameState *game)
 {
     if (!ren || !game) return;
 
-    GameState temp;
-    init_game(&temp);
+    /* 关键帧索引十几 KB，放静态区，别压在栈上 */
+    static Replay rp;
+    replay_build(&rp, game);
 
-    int stop = 0;
+    GameState view;
+    int cur = 0;            // 当前显示到第几手（0 = 空棋盘）
+    int dragging = 0;
+    int shown = -1;         // 上次画出来的是第几手 / 什么播放状态 / 什么速度，没变就不重画
+    int shown_playing = -1;
+    int shown_speed = -1;
+    int running = 1;
+
+    /* 时间基准：进回放的那一刻，单位毫秒（高精度计时器） */
+    Uint64 t0 = perf_now();
+    ReplayClock clk;
+    replay_clock_init(&clk);
+    replay_clock_play(&clk, 0, 0.0);
 
-    for (int i = 0; i < game->moves_count; i++) {
+    while (running) {
         SDL_Event ev;
-        while (SDL_PollEvent(&ev)) {
+        /* 暂停时一直睡到有输入；播放时最多睡到下一手出现的时刻（性能面板开着时还要按时刷新） */
+        Uint32 deadline = 0;
+        if (clk.playing) {
+            double wait = replay_clock_next(&clk, cur) - perf_ms_since(t0);
+            deadline = SDL_GetTicks() + (wait > 0 ? (Uint32)(wait + 0.999) : 0);   // 宁可晚不到 1 毫秒，别空转
+            if (deadline == 0) deadline = 1;   // 0 表示“没有”
+        }
+        deadline = earlier_deadline(deadline, perf_next_refresh());
+        deadline = earlier_deadline(deadline, gui_anim_next_frame());
+        for (int have = wait_event_until(&ev, deadline); have; have = SDL_PollEvent(&ev)) {
             if (ev.type == SDL_QUIT) {
-                stop = 1;
+                running = 0;
                 break;
             }
+            if (ev.type == SDL_WINDOWEVENT) {
+                shown = -1;   // 窗口被遮挡/恢复后补画一帧
+            }
+            if (ev.type == SDL_KEYDOWN) {
+                double now = perf_ms_since(t0);
+                switch (ev.key.keysym.sym) {
+                case SDLK_ESCAPE:
+                    running = 0;
+                    break;
+                case SDLK_SPACE:
+                    if (clk.playing) {
+                        replay_clock_pause(&clk);
+                    } else {
+                        if (cur >= rp.total) cur = 0;  // 播完了再按空格就从头播
+                        replay_clock_play(&clk, cur, now);
+                    }
+                    break;
+                case SDLK_LEFT:
+                    replay_clock_pause(&clk);
+                    if (cur > 0) cur--;
+                    break;
+                case SDLK_RIGHT:
+                    replay_clock_pause(&clk);
+                    if (cur < rp.total) cur++;
+                    break;
+                case SDLK_HOME:
+                    replay_clock_pause(&clk);
+                    cur = 0;
+                    break;
+                case SDLK_END:
+                    replay_clock_pause(&clk);
+                    cur = rp.total;
+                    break;
+                case SDLK_UP:
+                case SDLK_EQUALS:      // 不按 Shift 的 “+” 键
+                case SDLK_PLUS:
+                case SDLK_KP_PLUS:
+                    replay_clock_shift(&clk, +1, cur, now);
+                    break;
+                case SDLK_DOWN:
+                case SDLK_MINUS:
+                case SDLK_KP_MINUS:
+                    replay_clock_shift(&clk, -1, cur, now);
+                    break;
+                case SDLK_F3:
+                    perf_toggle();
+                    shown = -1;
+                    break;
+                case SDLK_h:
+                    heatmap_toggle();
+                    shown = -1;
+                    break;
+                default:
+                    break;
+                }
+            }
             if (ev.type == SDL_MOUSEBUTTONDOWN &&
                 ev.button.button == SDL_BUTTON_LEFT) {
-                /* 回放中点一下，就当“退出回放” */
-                stop = 1;
-                break;
+                if (playback_bar_hit(ev.button.x, ev.button.y)) {
+                    dragging = 1;
+                    replay_clock_pause(&clk);
+                    cur = playback_bar_move(ev.button.x, rp.total);
+                } else {
+                    /* 和以前一样：点一下棋盘就退出回放 */
+                    running = 0;
+                    break;
+                }
+            }
+            if (ev.type == SDL_MOUSEMOTION && dragging) {
+                cur = playback_bar_move(ev.motion.x, rp.total);
+            }
+            if (ev.type == SDL_MOUSEBUTTONUP && ev.button.button == SDL_BUTTON_LEFT) {
+                dragging = 0;
             }
         }
-        if (stop) break;
-
-        Move m = game->moves[i];
+        if (!running) break;
 
-        /* 回放时严格按记录里的落子方来下 */
-        temp.current_player = m.player;
-        temp.finished = 0;
-        place_stone(&temp, m.row, m.col);
-
-        draw_game(ren, &temp);
-        SDL_RenderPresent(ren);
-        SDL_Delay(PLAYBACK_INTERVAL);
-    }
-
-    if (stop) return;
-
-    /* 播放完：展示胜负，点一下回到回放列表 */
-    draw_game_result(ren, game->winner);
+        /* 自动播放：按时钟算出现在该第几手（高倍速时可能一下跳好几手） */
+        if (clk.playing) {
+            cur = replay_clock_move(&clk, rp.total, perf_ms_since(t0));
+            if (cur >= rp.total) replay_clock_pause(&clk);
+        }
 
-    int waiting = 1;
-    while (waiting) {
-        SDL_Event ev;
-        while (SDL_PollEvent(&ev)) {
-            if (ev.type == SDL_QUIT) {
-                waiting = 0;
-                break;
-            }
-            if (ev.type == SDL_MOUSEBUTTONDOWN &&
-                ev.button.button == SDL_BUTTON_LEFT) {
-                waiting = 0;
-                break;
+        if (cur != shown || clk.playing != shown_playing || clk.speed != shown_speed ||
+            perf_refresh_due() || anim_frame_due()) {
+            perf_frame_begin();
+            replay_seek(&rp, cur, &view);
+            if (cur >= rp.total) gui_anim_finish();   // 最后一手上面要盖结果，不播动画
+            draw_game(ren, &view);
+            draw_playback_bar(ren, cur, rp.total, clk.playing, replay_speed(clk.speed));
+            if (perf_enabled()) draw_perf_overlay(ren, perf_stats());
+            if (cur >= rp.total) {
+                /* 到最后一手：盖上胜负结果（draw_game_result 自己会 Present） */
+                draw_game_result(ren, rp.winner);
+            } else {
+                SDL_RenderPresent(ren);
             }
+            perf_frame_end();
+            shown = cur;
+            shown_playing = clk.playing;
+            shown_speed = clk.speed;
         }
-        SDL_Delay(10);
     }
 }
 
 /* 图形化的回放入口：列出“第 N 轮”按钮，并带删除按钮 */
 static void run_playback(void)
 {
-    SDL_Window *win = NULL;
-    SDL_Renderer *ren = NULL;
-
-    if (gui_init(&win, &ren) != 0) {
-        fprintf(stderr, "无法初始化界面，退出回放。\n");
-        return;
-    }
+    SDL_Renderer *ren = g_ren;
 
     const int per_page = 6;
     int page = 0;
     int running = 1;
 
+    /* 列表摘要由 playlist 在后台按页取，这里每帧只查缓存 */
+    playlist_open(per_page);
+    RecordSummary rows[PLAYLIST_MAX_ROWS];
+
+    /* 点了按钮、窗口变化、后台取回新页时才重画 */
+    int dirty = 1;
+
     while (running) {
-        int total = record_count();
+        int total = playlist_total();
+        int updated = playlist_take_updates();
 
         if (total <= 0) {
-            draw_playback_empty(ren);
+            if (dirty || updated) draw_playback_empty(ren);
         } else {
             int pages = (total + per_page - 1) / per_page;
             if (pages <= 0) pages = 1;
@@ -706,11 +870,18 @@ static void run_playback(void)
             if (page < 0) page = 0;
             if (page >= pages) page = pages - 1;
 
-            draw_playback_menu(ren, page, total, per_page);
+            if (dirty || updated) {
+                int row_count = 0;
+                int ready = playlist_page(page, rows, &row_count);
+                draw_playback_menu(ren, page, total, per_page, ready ? rows : NULL, row_count);
+            }
         }
+        dirty = 0;
 
         SDL_Event ev;
-        while (SDL_PollEvent(&ev)) {
+        /* 睡着等：鼠标、键盘，或者 playlist 取回新页时放进来的 SDL_USEREVENT */
+        for (int have = wait_event_until(&ev, 0); have; have = SDL_PollEvent(&ev)) {
+            if (ev.type != SDL_MOUSEMOTION) dirty = 1;
             if (ev.type == SDL_QUIT) {
                 running = 0;
                 break;
@@ -719,86 +890,55 @@ static void run_playback(void)
             if (ev.type == SDL_MOUSEBUTTONDOWN &&
                 ev.button.button == SDL_BUTTON_LEFT) {
 
-                int mx = ev.button.x;
-                int my = ev.button.y;
-
-                SDL_Rect backRect = { (WINDOW_WIDTH - 240) / 2, WINDOW_HEIGHT - 80, 240, 50 };
-
-                if (point_in_rect(mx, my, &backRect)) {
-                    running = 0;
-                    break;
-                }
-
-                if (total <= 0) {
-                    break;
-                }
-
-                /* 翻页按钮（只有记录多的时候才显示） */
-                SDL_Rect prevRect = { 60, WINDOW_HEIGHT - 80, 120, 50 };
-                SDL_Rect nextRect = { WINDOW_WIDTH - 60 - 120, WINDOW_HEIGHT - 80, 120, 50 };
-
-                int pages = (total + per_page - 1) / per_page;
-                if (pages < 1) pages = 1;
-
-                if (total > per_page) {
-                    if (point_in_rect(mx, my, &prevRect)) {
-                        if (page > 0) page--;
-                        break;
-                    }
-                    if (point_in_rect(mx, my, &nextRect)) {
-                        if (page < pages - 1) page++;
-                        break;
-                    }
-                }
-
-                /* 逐行判断：点“第 N 轮”就回放；点“删除”就删这一条 */
-                int list_w = WINDOW_WIDTH * 3 / 4;
-                int left = (WINDOW_WIDTH - list_w) / 2;
-                int row_h = 52;
-                int gap = 14;
-                int top = 110;
-
-                int del_w = 90;
-                int play_w = list_w - del_w - 10;
-
                 int start_index = page * per_page;
                 int show_count = total - start_index;
                 if (show_count > per_page) show_count = per_page;
                 if (show_count < 0) show_count = 0;
 
-                int did_action = 0;
-
-                for (int i = 0; i < show_count; i++) {
-                    int idx = start_index + i;
-                    SDL_Rect playRect = { left, top + i * (row_h + gap), play_w, row_h };
-                    SDL_Rect delRect  = { left + play_w + 10, top + i * (row_h + gap), del_w, row_h };
+                /* 按钮表和 draw_playback_menu 画的是同一张（layout.c） */
+                int row = 0;
+                UiId hit = layout_hit(total <= 0 ? UI_SCREEN_LIST_EMPTY : UI_SCREEN_LIST,
+                                      show_count, total > per_page, ev.button.x, ev.button.y, &row);
 
-                    if (point_in_rect(mx, my, &delRect)) {
-                        delete_record(idx);
-
-                        /* 删完可能页数变少，下一轮循环会自动夹紧 page */
-                        did_action = 1;
-                        break;
-                    }
+                int pages = (total + per_page - 1) / per_page;
+                if (pages < 1) pages = 1;
 
-                    if (point_in_rect(mx, my, &playRect)) {
-                        GameState g;
-                        if (load_record(idx, &g)) {
-                            playback_one_game(ren, &g);
-                        }
-                        did_action = 1;
-                        break;
+                switch (hit) {
+                case UI_LIST_BACK:
+                    running = 0;
+                    break;
+                /* 翻页按钮（只有记录多的时候才显示） */
+                case UI_LIST_PREV:
+                    if (page > 0) page--;
+                    break;
+                case UI_LIST_NEXT:
+                    if (page < pages - 1) page++;
+                    break;
+                /* 点“删除”就删这一条；删完可能页数变少，下一轮循环会自动夹紧 page */
+                case UI_LIST_DELETE:
+                    delete_record(start_index + row);
+                    playlist_invalidate();
+                    break;
+                /* 点“第 N 轮”就回放 */
+                case UI_LIST_PLAY: {
+                    GameState g;
+                    Uint64 io_start = perf_now();
+                    int loaded = load_record(start_index + row, &g);
+                    perf_set_io(perf_ms_since(io_start));
+                    if (loaded) {
+                        playback_one_game(ren, &g);
                     }
+                    break;
                 }
-
-                if (did_action) break;
+                default:
+                    break;
+                }
+                if (hit != UI_NONE) break;
             }
         }
-
-        SDL_Delay(10);
     }
 
-    gui_quit(win, ren);
+    playlist_close();
 }
 
 
@@ -807,13 +947,7 @@ static void run_playback(void)
 /* 显示主菜单界面并等待用户点击；- SDL_PollEvent() : SDL 库函数，检查并获取事件（鼠标点击等） */
 static int show_main_menu(void)
 {
-    SDL_Window *win = NULL;
-    SDL_Renderer *ren = NULL;
-
-    if (gui_init(&win, &ren) != 0) {
-        fprintf(stderr, "无法初始化菜单窗口\n");
-        return 0;  // 直接当退出
-    }
+    SDL_Renderer *ren = g_ren;
 
     /* 主菜单：先看看有没有“未结束的存档” */
     int has_resume = has_resume_game();
@@ -825,32 +959,23 @@ static int show_main_menu(void)
     int selection = 0;  // 0 表示“还没选”
     int running = 1;
 
-    /* 主菜单按钮布局（要和 gui.c 里保持一致） */
-    const int bw_main = WINDOW_WIDTH * 3 / 4;
-    const int bh_main = 60;
-    const int spacing_main = 20;
-    const int top_main = 80;
-    const int left_main = (WINDOW_WIDTH - bw_main) / 2;
-    const int main_count = 5;
-
-    /* 人机难度按钮布局（要和 gui.c 里保持一致） */
-    const int bw_ai = WINDOW_WIDTH * 3 / 4;
-    const int bh_ai = 60;
-    const int spacing_ai = 20;
-    const int top_ai = 120;
-    const int left_ai = (WINDOW_WIDTH - bw_ai) / 2;
-    const int ai_count = 4;
-
     while (running) {
         SDL_Event e;
 
-        while (SDL_PollEvent(&e)) {
+        /* 菜单是静态的：睡着等输入，不再每 10 毫秒醒一次 */
+        for (int have = wait_event_until(&e, 0); have; have = SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
                 selection = 0;
                 running = 0;
                 break;
             }
 
+            /* 窗口被遮挡/恢复后补画当前这一屏 */
+            if (e.type == SDL_WINDOWEVENT) {
+                if (state == 0) draw_main_menu(ren, has_resume);
+                else draw_ai_difficulty_menu(ren);
+            }
+
             /* AI 菜单里按 ESC 直接回主菜单 */
             if (e.type == SDL_KEYDOWN && state == 1) {
                 if (e.key.keysym.sym == SDLK_ESCAPE) {
@@ -861,84 +986,66 @@ static int show_main_menu(void)
             }
 
             if (e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT) {
-                int mx = e.button.x;
-                int my = e.button.y;
-
-                if (state == 0) {
-                    /* 主菜单：5 个按钮 */
-                    for (int i = 0; i < main_count; i++) {
-                        int bx = left_main;
-                        int by = top_main + i * (bh_main + spacing_main);
-
-                        if (mx >= bx && mx <= bx + bw_main && my >= by && my <= by + bh_main) {
-                            if (i == 0) {
-                                /* 继续上次对局：没存档就别选了 */
-                                if (!has_resume) break;
-                                selection = 1;  // 继续
-                            } else if (i == 1) {
-                                selection = 2;  // 双人
-                            } else if (i == 2) {
-                                /* 点“人机对战”：切到难度选择 */
-                                state = 1;
-                                draw_ai_difficulty_menu(ren);
-                                break;
-                            } else if (i == 3) {
-                                selection = 6;  // 回放
-                            } else {
-                                selection = 0;  // 退出
-                            }
-
-                            if (selection != 0) running = 0;
-                            else running = 0;  // 退出也要关菜单
-                            break;
-                        }
-                    }
-                } else {
-                    /* 人机难度菜单：4 个按钮 */
-                    for (int i = 0; i < ai_count; i++) {
-                        int bx = left_ai;
-                        int by = top_ai + i * (bh_ai + spacing_ai);
-
-                        if (mx >= bx && mx <= bx + bw_ai && my >= by && my <= by + bh_ai) {
-                            if (i == 0) selection = 3;      // 人机简单
-                            else if (i == 1) selection = 4; // 人机中级
-                            else if (i == 2) selection = 5; // 人机困难
-                            else {
-                                /* 返回主菜单 */
-                                state = 0;
-                                has_resume = has_resume_game();
-                                draw_main_menu(ren, has_resume);
-                                selection = 0;
-                            }
-
-                            if (selection != 0) running = 0;
-                            break;
-                        }
-                    }
+                /* 按钮位置和 gui.c 画的共用 layout.c 里的表 */
+                UiId hit = layout_hit(state == 0 ? UI_SCREEN_MAIN : UI_SCREEN_AI, 0, 0,
+                                      e.button.x, e.button.y, NULL);
+
+                switch (hit) {
+                case UI_MAIN_RESUME:
+                    /* 继续上次对局：没存档就别选了 */
+                    if (has_resume) selection = 1;
+                    break;
+                case UI_MAIN_PVP:      selection = 2; break;   // 双人
+                case UI_MAIN_AI:
+                    /* 点“人机对战”：切到难度选择 */
+                    state = 1;
+                    draw_ai_difficulty_menu(ren);
+                    break;
+                case UI_MAIN_PLAYBACK: selection = 6; break;   // 回放
+                case UI_MAIN_QUIT:     running = 0; break;     // 退出：selection 保持 0
+                case UI_AI_EASY:       selection = 3; break;   // 人机简单
+                case UI_AI_MEDIUM:     selection = 4; break;   // 人机中级
+                case UI_AI_HARD:       selection = 5; break;   // 人机困难
+                case UI_AI_BACK:
+                    /* 返回主菜单 */
+                    state = 0;
+                    has_resume = has_resume_game();
+                    draw_main_menu(ren, has_resume);
+                    break;
+                default:
+                    break;
                 }
+                if (selection != 0) running = 0;
+                if (!running) break;
             }
         }
-
-        SDL_Delay(10);
     }
 
-    gui_quit(win, ren);
     return selection;
 }
 
+/* 切换场景：同一个窗口里换一个界面，只是改个状态。
+ * 把上一个界面没处理完的鼠标/键盘事件丢掉（比如点菜单按钮那一下的松开），
+ * 免得新界面把它当成自己的点击；标题恢复成默认的。 */
+static void enter_scene(Scene scene)
+{
+    SDL_FlushEvents(SDL_KEYDOWN, SDL_MOUSEWHEEL);
+    if (scene != SCENE_QUIT) SDL_SetWindowTitle(g_win, "六子棋");
+}
+
 
 /* ========== 第八部分：程序入口 main 函数 ========== */
 
 /* main 函数 - 程序的入口点；- SetConsoleOutputCP() : Windows API，设置控制台输出编码（UTF-8） */
 int main(int argc, char *argv[])
 {
-    // ========== 第一步：处理未使用的参数 ==========
+    // ========== 第一步：处理命令行参数 ==========
     
-    // 这两个参数我们没用，但是 C 语言要求 main 函数必须有这两个参数
-    // 加上 (void) 可以告诉编译器"我知道这个参数没用，这是故意的"
-    // 这样编译器就不会发出警告了
-    (void)argc;
-    (void)argv;
+    // 目前只有一个：--fullscreen 启动后直接全屏（窗口建好之后再切，见下面）
+    int fullscreen = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fullscreen") == 0) fullscreen = 1;
+    }
     
     // ========== 第二步：Windows 系统特殊设置 ==========
     
@@ -970,6 +1077,10 @@ int main(int argc, char *argv[])
         return 1;  // 返回 1 表示程序异常退出
     }
     
+    // 字体和菜单背景图在后台线程里加载，之后所有界面共用这一份（见 resource.h）
+    // 加载失败也不退出：没有字体只是菜单上不显示文字
+    res_init();
+
     // ========== 第六步：初始化音频系统 ==========
     
     // 初始化音频设备（用来播放下棋时的音效）
@@ -981,48 +1092,73 @@ int main(int argc, char *argv[])
     
     // ========== 第七步：主循环（游戏的核心循环） ==========
     
-    int running = 1;  // 1 表示程序还在运行，0 表示要退出了
+    // 整个程序只创建这一个窗口和渲染器，所有界面都在它上面画
+    if (gui_init(&g_win, &g_ren) != 0) {
+        fprintf(stderr, "图形界面初始化失败\n");
+        close_audio();
+        res_shutdown();
+        SDL_Quit();
+        return 1;
+    }
+    /* 全屏用“桌面分辨率”那种：不切显示模式，布局按新的输出大小重排 */
+    if (fullscreen) SDL_SetWindowFullscreen(g_win, SDL_WINDOW_FULLSCREEN_DESKTOP);
+
+    Scene scene = SCENE_MENU;  // 先显示主菜单
     
     // 这个循环会一直运行，直到用户选择退出
-    while (running) {
-        // 显示主菜单，让用户选择要做什么。
-        // show_main_menu 函数会显示菜单界面，等待用户点击，然后返回选择的编号（1-6）。
-        int choice = show_main_menu();
-
-        // 根据用户的选择，执行相应的功能
-        switch (choice) {
-            case 1:  // 继续上次对局
-                run_resume_game();
-                break;
-            case 2:  // 双人对战
-                run_game(1);
-                break;
-            case 3:  // 人机对战（简单）
-                run_game(2);
+    while (scene != SCENE_QUIT) {
+        Scene next = SCENE_MENU;  // 除了主菜单自己，其他界面结束后都回主菜单
+
+        switch (scene) {
+            case SCENE_MENU: {
+                // 显示主菜单，让用户选择要做什么。
+                // show_main_menu 函数会显示菜单界面，等待用户点击，然后返回选择的编号（1-6）。
+                int choice = show_main_menu();
+
+                // 根据用户的选择，决定切到哪个场景
+                switch (choice) {
+                    case 1:  next = SCENE_RESUME; break;                      // 继续上次对局
+                    case 2:  next = SCENE_GAME; g_scene_mode = 1; break;      // 双人对战
+                    case 3:  next = SCENE_GAME; g_scene_mode = 2; break;      // 人机对战（简单）
+                    case 4:  next = SCENE_GAME; g_scene_mode = 3; break;      // 人机对战（中级）
+                    case 5:  next = SCENE_GAME; g_scene_mode = 4; break;      // 人机对战（困难）
+                    case 6:  next = SCENE_PLAYBACK; break;                    // 回放历史对局
+                    default: next = SCENE_QUIT; break;                        // 退出游戏 / 关闭窗口
+                }
                 break;
-            case 4:  // 人机对战（中级）
-                run_game(3);
+            }
+            case SCENE_RESUME:
+                run_resume_game();
                 break;
-            case 5:  // 人机对战（困难）
-                run_game(4);
+            case SCENE_GAME:
+                run_game(g_scene_mode);
                 break;
-            case 6:  // 回放历史对局
+            case SCENE_PLAYBACK:
                 run_playback();
                 break;
-            default:  // 退出游戏 / 关闭窗口
-                running = 0;
+            default:
+                next = SCENE_QUIT;
                 break;
         }
-        
-        // 注意：如果用户选择 1、2、3 或 4，执行完对应功能后会回到这里
-        // 然后循环继续，再次显示主菜单
-        // 只有选择 5 或关闭窗口，running 才会变成 0，循环才会结束
+
+        // 注意：对局、回放结束后会回到这里，切回主菜单
+        // 只有在主菜单选“退出”或关闭窗口，才会切到 SCENE_QUIT，循环才会结束
+        enter_scene(next);
+        scene = next;
     }
     
     // ========== 第八步：清理资源，退出程序 ==========
     
+    // 关闭唯一的窗口和渲染器
+    gui_quit(g_win, g_ren);
+    g_win = NULL;
+    g_ren = NULL;
+
     // 关闭音频设备
     close_audio();
+
+    // 关掉字体、释放图片
+    res_shutdown();
     
     // 释放 SDL 占用的所有资源
     SDL_Quit();
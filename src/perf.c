@@ -0,0 +1,147 @@
+/*
+ * perf.c
+ * 性能计数和面板数字（见 perf.h）。
+ */
+
+#include "perf.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int      g_enabled = 0;
+
+static float    g_frames[PERF_FRAMES];   // 环形缓冲：最近的帧时间（毫秒）
+static int      g_frame_pos = 0;
+static int      g_frame_count = 0;
+static Uint64   g_frame_start = 0;
+static double   g_frame_last = 0.0;
+
+static int      g_draws = 0, g_uploads = 0;            // 这一帧到目前为止
+static int      g_last_draws = 0, g_last_uploads = 0;  // 上一帧的结果
+static unsigned g_wakeups = 0;                          // 上次刷新面板以来
+
+static double   g_ai_ms = 0.0;
+static long     g_ai_nodes = 0;
+static double   g_io_ms = 0.0;
+
+static PerfStats g_shown;
+static Uint32    g_last_refresh = 0;
+
+Uint64 perf_now(void)
+{
+    return SDL_GetPerformanceCounter();
+}
+
+double perf_ms_since(Uint64 start)
+{
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+void perf_frame_begin(void)
+{
+    g_frame_start = perf_now();
+    /* 菜单等不计帧的界面里画的东西不算到这一帧头上 */
+    g_draws = 0;
+    g_uploads = 0;
+}
+
+void perf_frame_end(void)
+{
+    if (!g_frame_start) return;
+    g_frame_last = perf_ms_since(g_frame_start);
+    g_frame_start = 0;
+    g_frames[g_frame_pos] = (float)g_frame_last;
+    g_frame_pos = (g_frame_pos + 1) % PERF_FRAMES;
+    if (g_frame_count < PERF_FRAMES) g_frame_count++;
+
+    g_last_draws = g_draws;
+    g_last_uploads = g_uploads;
+    g_draws = 0;
+    g_uploads = 0;
+}
+
+void perf_count_draw(int n)
+{
+    g_draws += n;
+}
+
+void perf_count_upload(void)
+{
+    g_uploads++;
+}
+
+void perf_count_wakeup(void)
+{
+    g_wakeups++;
+}
+
+void perf_set_ai(double ms, long nodes)
+{
+    g_ai_ms = ms;
+    g_ai_nodes = nodes;
+}
+
+void perf_set_io(double ms)
+{
+    g_io_ms = ms;
+}
+
+int perf_toggle(void)
+{
+    g_enabled = !g_enabled;
+    g_last_refresh = 0;   // 一打开就算一次
+    return g_enabled;
+}
+
+int perf_enabled(void)
+{
+    return g_enabled;
+}
+
+static int cmp_float(const void *a, const void *b)
+{
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+/* 重新算一遍面板上的数字 */
+static void refresh(Uint32 now)
+{
+    PerfStats *s = &g_shown;
+    s->frame_last_ms = g_frame_last;
+    s->frame_avg_ms = 0.0;
+    s->frame_p99_ms = 0.0;
+    if (g_frame_count > 0) {
+        float sorted[PERF_FRAMES];
+        double sum = 0.0;
+        memcpy(sorted, g_frames, (size_t)g_frame_count * sizeof(float));
+        for (int i = 0; i < g_frame_count; i++) sum += sorted[i];
+        qsort(sorted, (size_t)g_frame_count, sizeof(float), cmp_float);
+        s->frame_avg_ms = sum / g_frame_count;
+        s->frame_p99_ms = sorted[(g_frame_count * 99) / 100];
+    }
+    s->draws = g_last_draws;
+    s->uploads = g_last_uploads;
+
+    Uint32 span = g_last_refresh ? now - g_last_refresh : 0;
+    s->wakeups_per_sec = span ? g_wakeups * 1000.0 / span : 0.0;
+    g_wakeups = 0;
+
+    s->ai_ms = g_ai_ms;
+    s->ai_nodes_per_sec = (g_ai_ms > 0.0) ? g_ai_nodes * 1000.0 / g_ai_ms : 0.0;
+    s->io_ms = g_io_ms;
+    g_last_refresh = now;
+}
+
+const PerfStats *perf_stats(void)
+{
+    Uint32 now = SDL_GetTicks();
+    if (!g_last_refresh || (Uint32)(now - g_last_refresh) >= PERF_REFRESH_MS) refresh(now);
+    return &g_shown;
+}
+
+Uint32 perf_next_refresh(void)
+{
+    if (!g_enabled) return 0;
+    Uint32 t = g_last_refresh + PERF_REFRESH_MS;
+    return t ? t : 1;
+}
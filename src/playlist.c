@@ -0,0 +1,403 @@
+/*
+ * playlist.c
+ * 回放列表的分页数据源：后台线程预取 + 小 LRU 缓存，顺带准备缩略图。
+ */
+
+#include "playlist.h"
+#include "fileio.h"
+#include "store.h"
+#include "dedup.h"
+#include "boardimg.h"
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <utime.h>
+#include <time.h>
+
+/* 缓存里的一页 */
+typedef struct {
+    int page;                             // -1 = 空位
+    int count;
+    unsigned last_used;                   // LRU 用的“最近使用时刻”
+    RecordSummary rows[PLAYLIST_MAX_ROWS];
+    SDL_Surface  *thumbs[PLAYLIST_MAX_ROWS];  // 缩略图，后台取到之前是 NULL
+} CachedPage;
+
+static CachedPage g_cache[PLAYLIST_CACHE_PAGES];
+static unsigned   g_tick = 0;
+static int        g_per_page = 6;
+static int        g_total = 0;
+static int        g_generation = 0;      // 每次作废缓存 +1，取到一半的旧结果直接丢掉
+static int        g_updates = 0;
+
+/* 预取队列：当前页优先，然后是后一页、前一页 */
+static int        g_want[3] = {-1, -1, -1};
+
+static SDL_Thread *g_thread = NULL;
+static SDL_mutex  *g_lock = NULL;
+static SDL_cond   *g_cond = NULL;
+static int         g_running = 0;
+
+/* 在缓存里找一页，找不到返回 NULL（调用时要持锁） */
+static CachedPage *find_page(int page)
+{
+    for (int i = 0; i < PLAYLIST_CACHE_PAGES; i++) {
+        if (g_cache[i].page == page) return &g_cache[i];
+    }
+    return NULL;
+}
+
+/* 清空一个缓存位置（连同缩略图） */
+static void drop_page(CachedPage *c)
+{
+    for (int i = 0; i < PLAYLIST_MAX_ROWS; i++) {
+        if (c->thumbs[i]) SDL_FreeSurface(c->thumbs[i]);
+        c->thumbs[i] = NULL;
+    }
+    c->page = -1;
+    c->count = 0;
+}
+
+/* 找一个位置放新页：优先空位，否则淘汰最久没用的（调用时要持锁） */
+static CachedPage *evict_slot(void)
+{
+    CachedPage *victim = &g_cache[0];
+    for (int i = 0; i < PLAYLIST_CACHE_PAGES; i++) {
+        if (g_cache[i].page < 0) return &g_cache[i];
+        if (g_cache[i].last_used < victim->last_used) victim = &g_cache[i];
+    }
+    drop_page(victim);
+    return victim;
+}
+
+static void clear_cache(void)
+{
+    for (int i = 0; i < PLAYLIST_CACHE_PAGES; i++) drop_page(&g_cache[i]);
+}
+
+/* 告诉界面有新东西了：置标记，再叫醒在 SDL_WaitEvent 里睡着的界面
+ * （SDL_PushEvent 可以在别的线程调用；调用时要持锁） */
+static void notify_updated(void)
+{
+    g_updates = 1;
+    SDL_Event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = SDL_USEREVENT;
+    ev.user.code = PLAYLIST_EVENT_CODE;
+    SDL_PushEvent(&ev);
+}
+
+/* 从一行 JSON 里抠出摘要：只找几个字段，不用还原整盘棋
+ * （只有没带 "h" 字段的老记录要用 rec 完整解析一遍来算哈希） */
+static void summarize(const char *line, int index, RecordSummary *out, GameRecord *rec)
+{
+    memset(out, 0, sizeof(*out));
+    out->index = index;
+    if (!line || record_check(line, strlen(line)) == RECORD_CORRUPT) return;
+
+    const char *t = strstr(line, "\"time\":\"");
+    if (t) sscanf(t + 8, "%19[^\"]", out->time);
+    const char *w = strstr(line, "\"winner\":");
+    if (w) sscanf(w + 9, "%d", &out->winner);
+    const char *u = strstr(line, "\"undo\":");
+    if (u) sscanf(u + 7, "%d", &out->undo);
+
+    const char *m = strstr(line, "\"moves\":[");
+    if (!m) return;
+    for (const char *p = m; (p = strstr(p, "{\"p\":")) != NULL; p += 5) out->moves++;
+    out->ok = 1;
+
+    out->hash = dedup_line_hash(line, strlen(line));
+    if (!out->hash && rec && record_from_json(line, rec)) out->hash = record_hash(&rec->game);
+}
+
+/* 取一盘棋的缩略图：磁盘缓存里有就直接读，没有就离屏画一张再存起来。
+ * 在后台线程里调用；rec 是工作区 */
+static SDL_Surface *load_thumb(const char *line, uint64_t hash, GameRecord *rec)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%016llx_%d.bmp", PLAYLIST_THUMB_DIR,
+             (unsigned long long)hash, PLAYLIST_THUMB_SIZE);
+    SDL_Surface *img = SDL_LoadBMP(path);
+    if (img) {
+        utime(path, NULL);   // 刷新修改时间：清理磁盘缓存时按它判断最近用没用过
+        return img;
+    }
+
+    if (!line || !record_from_json(line, rec)) return NULL;
+    img = boardimg_render(&rec->game, PLAYLIST_THUMB_SIZE);
+    /* 存不下来也不要紧，下次再画 */
+    if (img) boardimg_save(img, path);
+    return img;
+}
+
+/* 缩略图目录里的一个文件 */
+typedef struct {
+    time_t mtime;
+    char   name[64];
+} ThumbFile;
+
+static int cmp_thumb_age(const void *a, const void *b)
+{
+    time_t x = ((const ThumbFile *)a)->mtime, y = ((const ThumbFile *)b)->mtime;
+    return (x > y) - (x < y);
+}
+
+/* 缩略图只写不删的话目录会一直长（删掉的记录、换过尺寸的旧图都留着）：
+ * 超过 PLAYLIST_THUMB_MAX 张就把最久没用过的删掉，删到 3/4，免得每次打开都要删 */
+static void prune_thumbs(void)
+{
+    DIR *dir = opendir(PLAYLIST_THUMB_DIR);
+    if (!dir) return;
+    ThumbFile *files = NULL;
+    int n = 0, cap = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        unsigned long long h;
+        int size;
+        if (sscanf(de->d_name, "%16llx_%d.bmp", &h, &size) != 2) continue;
+        if (strlen(de->d_name) >= sizeof(files[0].name)) continue;
+        char path[256];
+        struct stat st;
+        snprintf(path, sizeof(path), "%s/%s", PLAYLIST_THUMB_DIR, de->d_name);
+        if (stat(path, &st) != 0) continue;
+        if (n >= cap) {
+            cap = cap ? cap * 2 : 256;
+            ThumbFile *p = (ThumbFile *)realloc(files, (size_t)cap * sizeof(ThumbFile));
+            if (!p) break;
+            files = p;
+        }
+        files[n].mtime = st.st_mtime;
+        strcpy(files[n].name, de->d_name);
+        n++;
+    }
+    closedir(dir);
+
+    if (n > PLAYLIST_THUMB_MAX) {
+        qsort(files, (size_t)n, sizeof(ThumbFile), cmp_thumb_age);
+        int drop = n - PLAYLIST_THUMB_MAX * 3 / 4;
+        for (int i = 0; i < drop; i++) {
+            char path[256];
+            snprintf(path, sizeof(path), "%s/%s", PLAYLIST_THUMB_DIR, files[i].name);
+            remove(path);
+        }
+    }
+    free(files);
+}
+
+/* 后台线程：挑一个想要但还没缓存的页，去 store 里读出来 */
+static int prefetch_thread(void *arg)
+{
+    (void)arg;
+    char *lines[PLAYLIST_MAX_ROWS];
+    RecordSummary rows[PLAYLIST_MAX_ROWS];
+    SDL_Surface *thumbs[PLAYLIST_MAX_ROWS];
+    GameRecord *rec = (GameRecord *)malloc(sizeof(GameRecord));   // 放栈上太大
+
+    /* 要把整个目录 stat 一遍，放在这里不卡界面；缩略图也只有这个线程读写，不会删到正在用的 */
+    prune_thumbs();
+
+    SDL_LockMutex(g_lock);
+    while (g_running) {
+        int page = -1;
+        for (int i = 0; i < 3; i++) {
+            if (g_want[i] >= 0 && !find_page(g_want[i])) {
+                page = g_want[i];
+                break;
+            }
+        }
+        if (page < 0) {
+            SDL_CondWait(g_cond, g_lock);
+            continue;
+        }
+        int gen = g_generation;
+        int per_page = g_per_page;
+        SDL_UnlockMutex(g_lock);
+
+        /* 读盘不持锁：主线程照样能查缓存、翻页 */
+        int total = store_count();
+        int first = page * per_page;
+        int n = total - first;
+        if (n > per_page) n = per_page;
+        if (n < 0) n = 0;
+        memset(lines, 0, sizeof(lines));
+        if (n > 0) store_read_lines(first, n, lines);
+        for (int i = 0; i < n; i++) summarize(lines[i], first + i, &rows[i], rec);
+
+        SDL_LockMutex(g_lock);
+        int fresh = (gen == g_generation);
+        if (fresh) {
+            g_total = total;
+            CachedPage *c = find_page(page);
+            if (!c) c = evict_slot();
+            c->page = page;
+            c->count = n;
+            c->last_used = ++g_tick;
+            memcpy(c->rows, rows, sizeof(RecordSummary) * (size_t)n);
+            notify_updated();
+        }
+        /* 代数变了说明中途有删除：这页作废，下一圈按新编号重取 */
+        SDL_UnlockMutex(g_lock);
+
+        /* 摘要已经能画了，再准备这一页的缩略图（也不持锁） */
+        for (int i = 0; i < n; i++) {
+            thumbs[i] = (fresh && rec && rows[i].hash) ? load_thumb(lines[i], rows[i].hash, rec) : NULL;
+            free(lines[i]);
+        }
+
+        SDL_LockMutex(g_lock);
+        CachedPage *c = (fresh && gen == g_generation) ? find_page(page) : NULL;
+        int added = 0;
+        for (int i = 0; i < n; i++) {
+            if (c && !c->thumbs[i] && thumbs[i]) {
+                c->thumbs[i] = thumbs[i];
+                added = 1;
+            } else if (thumbs[i]) {
+                SDL_FreeSurface(thumbs[i]);   // 这页在这期间被淘汰或作废了
+            }
+        }
+        if (added) notify_updated();
+    }
+    SDL_UnlockMutex(g_lock);
+    free(rec);
+    return 0;
+}
+
+int playlist_open(int per_page)
+{
+    if (g_thread) return 1;
+    if (per_page < 1) per_page = 1;
+    if (per_page > PLAYLIST_MAX_ROWS) per_page = PLAYLIST_MAX_ROWS;
+    g_per_page = per_page;
+    clear_cache();
+    /* 缩略图的磁盘缓存目录 */
+    struct stat st;
+    store_ensure_dir();
+    if (stat(PLAYLIST_THUMB_DIR, &st) != 0) {
+        #ifdef _WIN32
+        mkdir(PLAYLIST_THUMB_DIR);
+        #else
+        mkdir(PLAYLIST_THUMB_DIR, 0755);
+        #endif
+    }
+    g_want[0] = g_want[1] = g_want[2] = -1;
+    g_total = record_count();
+    g_updates = 0;
+
+    g_lock = SDL_CreateMutex();
+    g_cond = SDL_CreateCond();
+    if (!g_lock || !g_cond) {
+        fprintf(stderr, "playlist: SDL_CreateMutex/SDL_CreateCond error: %s\n", SDL_GetError());
+        playlist_close();
+        return 0;
+    }
+    g_running = 1;
+    g_thread = SDL_CreateThread(prefetch_thread, "playlist", NULL);
+    if (!g_thread) {
+        fprintf(stderr, "playlist: SDL_CreateThread error: %s\n", SDL_GetError());
+        g_running = 0;
+        playlist_close();
+        return 0;
+    }
+    return 1;
+}
+
+void playlist_close(void)
+{
+    if (g_thread) {
+        SDL_LockMutex(g_lock);
+        g_running = 0;
+        SDL_CondSignal(g_cond);
+        SDL_UnlockMutex(g_lock);
+        SDL_WaitThread(g_thread, NULL);
+        g_thread = NULL;
+    }
+    if (g_cond) SDL_DestroyCond(g_cond);
+    if (g_lock) SDL_DestroyMutex(g_lock);
+    g_cond = NULL;
+    g_lock = NULL;
+    clear_cache();
+}
+
+int playlist_total(void)
+{
+    if (!g_lock) return record_count();
+    SDL_LockMutex(g_lock);
+    int total = g_total;
+    SDL_UnlockMutex(g_lock);
+    return total;
+}
+
+int playlist_page(int page, RecordSummary *rows, int *count)
+{
+    if (count) *count = 0;
+    if (page < 0 || !g_lock) return 0;
+
+    SDL_LockMutex(g_lock);
+    int hit = 0;
+    CachedPage *c = find_page(page);
+    if (c) {
+        c->last_used = ++g_tick;
+        if (rows) memcpy(rows, c->rows, sizeof(RecordSummary) * (size_t)c->count);
+        if (count) *count = c->count;
+        hit = 1;
+    }
+
+    /* 不管命中没有，都把当前页和左右邻页排进预取队列 */
+    int pages = (g_total + g_per_page - 1) / g_per_page;
+    int want[3] = {page, page + 1, page - 1};
+    int changed = 0;
+    for (int i = 0; i < 3; i++) {
+        if (want[i] < 0 || want[i] >= pages) want[i] = -1;
+        if (g_want[i] != want[i]) changed = 1;
+        g_want[i] = want[i];
+    }
+    if (changed || !hit) SDL_CondSignal(g_cond);
+    SDL_UnlockMutex(g_lock);
+    return hit;
+}
+
+void playlist_invalidate(void)
+{
+    int total = record_count();
+    if (!g_lock) return;
+    SDL_LockMutex(g_lock);
+    g_generation++;
+    g_total = total;
+    clear_cache();
+    SDL_CondSignal(g_cond);
+    SDL_UnlockMutex(g_lock);
+}
+
+SDL_Surface *playlist_thumb(uint64_t hash)
+{
+    if (!hash || !g_lock) return NULL;
+    SDL_Surface *copy = NULL;
+    SDL_LockMutex(g_lock);
+    for (int i = 0; i < PLAYLIST_CACHE_PAGES && !copy; i++) {
+        CachedPage *c = &g_cache[i];
+        if (c->page < 0) continue;
+        for (int k = 0; k < c->count; k++) {
+            if (c->rows[k].hash == hash && c->thumbs[k]) {
+                /* 给一份拷贝：原件可能随时被后台线程淘汰 */
+                copy = SDL_DuplicateSurface(c->thumbs[k]);
+                break;
+            }
+        }
+    }
+    SDL_UnlockMutex(g_lock);
+    return copy;
+}
+
+int playlist_take_updates(void)
+{
+    if (!g_lock) return 0;
+    SDL_LockMutex(g_lock);
+    int u = g_updates;
+    g_updates = 0;
+    SDL_UnlockMutex(g_lock);
+    return u;
+}
@@ -0,0 +1,353 @@
+/*
+ * recfmt.c
+ *
+ * NDJSON / 二进制 / SGF 三种记录格式的编解码。
+ * 所有函数都只碰调用者给的缓冲区，不用全局变量，可以在多个线程里同时调用。
+ */
+
+#include "recfmt.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static const char BIN_MAGIC[4] = {'S', 'I', 'X', 'B'};
+static const uint8_t BIN_VERSION = 2;
+
+/* 二进制负载的固定部分：时间 19 + 胜者 1 + 悔棋 2 + 步数 2，版本 2 再加模式 1 + 用时 4。
+ * 版本 1 的文件照样能读：两种负载长度一奇一偶，按长度就能分开 */
+#define BIN_FIXED_V1 24
+#define BIN_FIXED 29
+
+RecordFormat recfmt_guess(const char *path)
+{
+    const char *dot = path ? strrchr(path, '.') : NULL;
+    if (dot && strcmp(dot, ".bin") == 0) return FMT_BINARY;
+    if (dot && strcmp(dot, ".sgf") == 0) return FMT_SGF;
+    return FMT_NDJSON;
+}
+
+const char *recfmt_name(RecordFormat fmt)
+{
+    switch (fmt) {
+    case FMT_BINARY: return "binary";
+    case FMT_SGF:    return "sgf";
+    default:         return "ndjson";
+    }
+}
+
+size_t recfmt_write_header(RecordFormat fmt, FILE *fp)
+{
+    if (fmt != FMT_BINARY || !fp) return 0;
+    uint8_t h[8] = {0};
+    memcpy(h, BIN_MAGIC, 4);
+    h[4] = BIN_VERSION;
+    return fwrite(h, 1, sizeof(h), fp);
+}
+
+int recfmt_read_header(RecordFormat fmt, FILE *fp)
+{
+    if (fmt != FMT_BINARY) return 1;
+    uint8_t h[8];
+    if (fread(h, 1, sizeof(h), fp) != sizeof(h)) return 0;
+    return memcmp(h, BIN_MAGIC, 4) == 0 && h[4] >= 1 && h[4] <= BIN_VERSION;
+}
+
+/* 确保缓冲区至少能再放 extra 个字节（外加一个 '\0'） */
+static int reserve(char **buf, size_t len, size_t *cap, size_t extra)
+{
+    if (len + extra + 1 <= *cap) return 1;
+    size_t ncap = *cap ? *cap : 256;
+    while (ncap < len + extra + 1) ncap *= 2;
+    char *p = (char *)realloc(*buf, ncap);
+    if (!p) return 0;
+    *buf = p;
+    *cap = ncap;
+    return 1;
+}
+
+int recfmt_next_unit(RecordFormat fmt, FILE *fp, char **unit, size_t *len, size_t *cap)
+{
+    *len = 0;
+
+    if (fmt == FMT_BINARY) {
+        uint8_t lb[2];
+        if (fread(lb, 1, 2, fp) != 2) return 0;
+        size_t n = (size_t)lb[0] | ((size_t)lb[1] << 8);
+        if (!reserve(unit, 0, cap, n)) return 0;
+        if (fread(*unit, 1, n, fp) != n) return 0;
+        (*unit)[n] = '\0';
+        *len = n;
+        return 1;
+    }
+
+    if (fmt == FMT_SGF) {
+        /* 跳到下一棵树的 '('，然后数括号；方括号里的值可能含 '(' ')'，要跳过（支持 \] 转义） */
+        int ch;
+        while ((ch = fgetc(fp)) != EOF && ch != '(') {
+        }
+        if (ch == EOF) return 0;
+        int depth = 0;
+        int in_value = 0, escaped = 0;
+        do {
+            if (!reserve(unit, *len, cap, 1)) return 0;
+            (*unit)[(*len)++] = (char)ch;
+            if (in_value) {
+                if (escaped) escaped = 0;
+                else if (ch == '\\') escaped = 1;
+                else if (ch == ']') in_value = 0;
+            } else if (ch == '[') {
+                in_value = 1;
+            } else if (ch == '(') {
+                depth++;
+            } else if (ch == ')') {
+                depth--;
+                if (depth == 0) break;
+            }
+        } while ((ch = fgetc(fp)) != EOF);
+        (*unit)[*len] = '\0';
+        return depth == 0;
+    }
+
+    /* NDJSON：按块 fgets 读一行（逐字节 fgetc 太慢，读线程会成为瓶颈），跳过空行 */
+    for (;;) {
+        if (!reserve(unit, *len, cap, 4096)) return 0;
+        if (!fgets(*unit + *len, (int)(*cap - *len), fp)) break;
+        *len += strlen(*unit + *len);
+        if ((*unit)[*len - 1] != '\n') continue;   // 行比缓冲区长，接着读
+        while (*len > 0 && ((*unit)[*len - 1] == '\n' || (*unit)[*len - 1] == '\r')) (*len)--;
+        if (*len > 0) break;
+    }
+    if (*len == 0) return 0;
+    (*unit)[*len] = '\0';
+    return 1;
+}
+
+/* 往对局里追加一步。和 fileio.c 的 parse_moves 一样：落子方不是 1/2、坐标越界就返回 0，
+ * 调用者整条记录作废（不能把坏数据当成白棋导进去，再盖上新的校验和） */
+static int push_move(GameState *game, int player, int row, int col)
+{
+    if ((player != 1 && player != 2) || !within_board(row, col)) return 0;
+    if (game->moves_count >= BOARD_SIZE * BOARD_SIZE) return 1;
+    game->cells[row][col] = (player == 1 ? CELL_BLACK : CELL_WHITE);
+    Move *m = &game->moves[game->moves_count++];
+    m->player = player;
+    m->row = row;
+    m->col = col;
+    return 1;
+}
+
+/* 解码收尾：和 parse_moves 保持一致 */
+static void finish_game(GameState *game, int winner, int undo)
+{
+    game->finished = 1;
+    game->winner = winner;
+    game->undo_count = undo;
+    game->current_player = (game->moves_count % 2 == 0) ? 1 : 2;
+}
+
+static int decode_binary(const uint8_t *p, size_t len, GameRecord *rec)
+{
+    if (len < BIN_FIXED_V1) return 0;
+    memcpy(rec->time, p, 19);
+    rec->time[19] = '\0';
+    for (int i = 18; i >= 0 && rec->time[i] == ' '; i--) rec->time[i] = '\0';
+    int winner = p[19];
+    int undo = p[20] | (p[21] << 8);
+    int n = p[22] | (p[23] << 8);
+    size_t fixed;
+    if (len == BIN_FIXED_V1 + (size_t)n * 2) {
+        fixed = BIN_FIXED_V1;
+        rec->mode = 0;
+        rec->dur = 0;
+    } else if (len == BIN_FIXED + (size_t)n * 2) {
+        fixed = BIN_FIXED;
+        rec->mode = p[24];
+        rec->dur = (int)((uint32_t)p[25] | ((uint32_t)p[26] << 8) | ((uint32_t)p[27] << 16) | ((uint32_t)p[28] << 24));
+    } else {
+        return 0;
+    }
+
+    init_game(&rec->game);
+    for (int i = 0; i < n; i++) {
+        unsigned v = p[fixed + i * 2] | (p[fixed + i * 2 + 1] << 8);
+        if (!push_move(&rec->game, (int)(v >> 10), (int)((v >> 5) & 31), (int)(v & 31))) return 0;
+    }
+    finish_game(&rec->game, winner, undo);
+    return 1;
+}
+
+static int encode_binary(const GameRecord *rec, char **buf, size_t *len, size_t *cap)
+{
+    const GameState *g = &rec->game;
+    size_t n = BIN_FIXED + (size_t)g->moves_count * 2;
+    if (!reserve(buf, *len, cap, 2 + n)) return 0;
+    uint8_t *p = (uint8_t *)*buf + *len;
+
+    p[0] = (uint8_t)(n & 0xFF);
+    p[1] = (uint8_t)(n >> 8);
+    p += 2;
+    memset(p, ' ', 19);
+    memcpy(p, rec->time, strnlen(rec->time, 19));
+    p[19] = (uint8_t)g->winner;
+    p[20] = (uint8_t)(g->undo_count & 0xFF);
+    p[21] = (uint8_t)((g->undo_count >> 8) & 0xFF);
+    p[22] = (uint8_t)(g->moves_count & 0xFF);
+    p[23] = (uint8_t)(g->moves_count >> 8);
+    uint32_t dur = (uint32_t)(rec->dur > 0 ? rec->dur : 0);
+    p[24] = (uint8_t)rec->mode;
+    p[25] = (uint8_t)(dur & 0xFF);
+    p[26] = (uint8_t)((dur >> 8) & 0xFF);
+    p[27] = (uint8_t)((dur >> 16) & 0xFF);
+    p[28] = (uint8_t)(dur >> 24);
+    for (int i = 0; i < g->moves_count; i++) {
+        const Move *m = &g->moves[i];
+        unsigned v = ((unsigned)(m->player & 3) << 10) | ((unsigned)(m->row & 31) << 5) | (unsigned)(m->col & 31);
+        p[BIN_FIXED + i * 2] = (uint8_t)(v & 0xFF);
+        p[BIN_FIXED + i * 2 + 1] = (uint8_t)(v >> 8);
+    }
+    *len += 2 + n;
+    return 1;
+}
+
+/* SGF 坐标：a..s 对应 0..18，先列后行 */
+static int sgf_coord(const char *v, size_t n, int *row, int *col)
+{
+    if (n != 2) return 0;
+    if (v[0] < 'a' || v[0] > 'z' || v[1] < 'a' || v[1] > 'z') return 0;
+    *col = v[0] - 'a';
+    *row = v[1] - 'a';
+    return 1;
+}
+
+static int decode_sgf(const char *s, size_t len, GameRecord *rec)
+{
+    init_game(&rec->game);
+    char date[11] = "";
+    char clock[9] = "";
+    int winner = 0, undo = 0;
+    rec->mode = 0;
+    rec->dur = 0;
+
+    const char *end = s + len;
+    const char *p = s;
+    char ident[8];
+    int il = 0;
+    int after_value = 0;
+    while (p < end) {
+        char ch = *p;
+        if (ch >= 'A' && ch <= 'Z') {
+            if (after_value) { /* 上一个属性的值读完了，这是新属性名 */
+                il = 0;
+                after_value = 0;
+            }
+            if (il < (int)sizeof(ident) - 1) ident[il++] = ch;
+            p++;
+            continue;
+        }
+        if (ch != '[') {
+            if (ch == ';' || ch == '(' || ch == ')') {
+                il = 0;
+                after_value = 0;
+            }
+            p++;
+            continue;
+        }
+        /* 读一个属性值 [..]，同一个属性后面可能连着好几个值 */
+        ident[il] = '\0';
+        const char *v = ++p;
+        while (p < end && *p != ']') {
+            if (*p == '\\' && p + 1 < end) p++;
+            p++;
+        }
+        size_t vn = (size_t)(p - v);
+        if (p < end) p++;
+        after_value = 1;
+
+        int row, col;
+        if ((strcmp(ident, "B") == 0 || strcmp(ident, "W") == 0) && sgf_coord(v, vn, &row, &col)) {
+            if (!push_move(&rec->game, ident[0] == 'B' ? 1 : 2, row, col)) return 0;
+        } else if (strcmp(ident, "DT") == 0 && vn >= 10) {
+            memcpy(date, v, 10);
+            date[10] = '\0';
+            if (vn >= 19 && v[10] == ' ') { /* 也兼容 DT[2025-12-18 22:27:25] */
+                memcpy(clock, v + 11, 8);
+                clock[8] = '\0';
+            }
+        } else if (strcmp(ident, "XT") == 0 && vn == 8) {
+            memcpy(clock, v, 8);
+            clock[8] = '\0';
+        } else if (strcmp(ident, "RE") == 0 && vn >= 1) {
+            winner = (v[0] == 'B') ? 1 : (v[0] == 'W') ? 2 : 0;
+        } else if (strcmp(ident, "XU") == 0) {
+            undo = atoi(v);
+        } else if (strcmp(ident, "XM") == 0) {
+            rec->mode = atoi(v);
+        } else if (strcmp(ident, "XD") == 0) {
+            rec->dur = atoi(v);
+        }
+        /* 不认识的属性（PB/PW/C 等）直接跳过 */
+    }
+
+    if (date[0]) {
+        snprintf(rec->time, sizeof(rec->time), "%s %s", date, clock[0] ? clock : "00:00:00");
+    } else {
+        strcpy(rec->time, "unknown");
+    }
+    finish_game(&rec->game, winner, undo);
+    return 1;
+}
+
+static int encode_sgf(const GameRecord *rec, char **buf, size_t *len, size_t *cap)
+{
+    const GameState *g = &rec->game;
+    if (!reserve(buf, *len, cap, 160 + (size_t)g->moves_count * 6)) return 0;
+    char *p = *buf + *len;
+
+    char date[11] = "", clock[9] = "";
+    if (strlen(rec->time) >= 19) {
+        memcpy(date, rec->time, 10);
+        memcpy(clock, rec->time + 11, 8);
+    }
+    const char *re = (g->winner == 1) ? "B+" : (g->winner == 2) ? "W+" : "0";
+
+    int n = sprintf(p, "(;FF[4]GM[Connect6]SZ[%d]", BOARD_SIZE);
+    if (date[0]) n += sprintf(p + n, "DT[%s]XT[%s]", date, clock);
+    n += sprintf(p + n, "RE[%s]XU[%d]", re, g->undo_count);
+    if (rec->mode) n += sprintf(p + n, "XM[%d]", rec->mode);
+    if (rec->dur) n += sprintf(p + n, "XD[%d]", rec->dur);
+    for (int i = 0; i < g->moves_count; i++) {
+        const Move *m = &g->moves[i];
+        n += sprintf(p + n, ";%c[%c%c]", m->player == 1 ? 'B' : 'W', 'a' + m->col, 'a' + m->row);
+    }
+    n += sprintf(p + n, ")\n");
+    *len += (size_t)n;
+    return 1;
+}
+
+int recfmt_decode(RecordFormat fmt, const char *unit, size_t len, GameRecord *rec)
+{
+    if (!unit || !rec) return 0;
+    switch (fmt) {
+    case FMT_BINARY: return decode_binary((const uint8_t *)unit, len, rec);
+    case FMT_SGF:    return decode_sgf(unit, len, rec);
+    default:         return record_from_json(unit, rec);
+    }
+}
+
+int recfmt_encode(RecordFormat fmt, const GameRecord *rec, char **buf, size_t *len, size_t *cap)
+{
+    if (!rec) return 0;
+    if (fmt == FMT_BINARY) return encode_binary(rec, buf, len, cap);
+    if (fmt == FMT_SGF) return encode_sgf(rec, buf, len, cap);
+
+    size_t n = 0;
+    char *line = record_to_json(&rec->game, rec->time, rec->mode, rec->dur, &n);
+    if (!line) return 0;
+    int ok = reserve(buf, *len, cap, n);
+    if (ok) {
+        memcpy(*buf + *len, line, n);
+        *len += n;
+    }
+    free(line);
+    return ok;
+}
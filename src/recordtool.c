@@ -0,0 +1,904 @@
+/*
+ * recordtool.c
+ * 对局记录的批量导入/导出命令行工具（recordtool.exe）。
+ *
+ *     recordtool convert <输入> <输出>      格式互转（按扩展名判断：.bin / .sgf / 其余当 NDJSON）
+ *     recordtool export  <输出>             把存档（liu/data 下的所有段）导出成一个文件
+ *     recordtool import  <输入> [<输入>...] 把若干文件合并进存档
+ *     recordtool verify  [-q]               校验存档里每条记录的 CRC32C，-q 把坏记录移进隔离区
+ *     recordtool validate                   用规则引擎把每局重下一遍，检查落子合法、胜者一致
+ *     recordtool stats   [--rebuild]        打印累计战绩（按模式、按天），--rebuild 先从存档重新统计
+ *     recordtool render  <目录> [--size N] [--bmp]  把每局的终局画成图片（默认 256 像素 PNG）
+ *     选项：-j N  工作线程数（默认 CPU 核数）
+ *
+ * 流水线：读线程把输入切成一批批“单元”（每批 BATCH_RECORDS 条）放进环形槽位，
+ * 多个工作线程并行解码 + 编码，主线程按批次顺序写出。槽位数固定，
+ * 所以内存占用和输入文件大小无关；导出存档时也是一段一段地读。
+ * 校验这类只读整个存档的命令则按段并行：每个线程领一个段，读（解压）+ 处理互不干扰。
+ * render 也是按段并行，每个线程用自己的软件渲染器画（boardimg.c），不开窗口、不要显卡。
+ */
+
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "fileio.h"
+#include "store.h"
+#include "recfmt.h"
+#include "crc32c.h"
+#include "stats.h"
+#include "boardimg.h"
+
+/* 每批多少条记录 */
+#define BATCH_RECORDS 512
+
+/* 槽位状态 */
+enum { SLOT_EMPTY, SLOT_FILLED, SLOT_WORKING, SLOT_DONE };
+
+/* 环形队列里的一批记录：输入单元首尾相接放在 in 里，编码结果放在 out 里 */
+typedef struct {
+    int    state;
+    long   seq;              // 批次序号，写出时按它排队
+    RecordFormat in_fmt;     // 这批单元的格式（import 时不同文件可能不同）
+    char  *in;
+    size_t in_len, in_cap;
+    size_t off[BATCH_RECORDS];
+    size_t len[BATCH_RECORDS];
+    int    count;
+    char  *out;
+    size_t out_len, out_cap;
+    int    bad;              // 解码失败的条数
+} Batch;
+
+/* 输入来源：一串文件，或者存档本身 */
+typedef struct {
+    char **files;
+    int    nfiles;
+    int    file_i;
+    FILE  *fp;
+    RecordFormat fmt;
+    int    from_store;
+    int    seg;              // 存档：当前段号
+    char  *text;             // 存档：当前段的文本
+    size_t text_len, pos;
+} Source;
+
+static Batch     *g_slots = NULL;
+static int        g_nslots = 0;
+static SDL_mutex *g_lock = NULL;
+static SDL_cond  *g_cond = NULL;
+static long       g_batches_total = -1;  // 读线程结束后才知道一共多少批
+static int        g_read_failed = 0;
+static RecordFormat g_out_fmt = FMT_NDJSON;
+static Source     g_src;
+static size_t     g_bytes_in = 0;
+
+/* 确保槽位的输入缓冲区能再放 extra 个字节 */
+static int batch_reserve(Batch *b, size_t extra)
+{
+    if (b->in_len + extra + 1 <= b->in_cap) return 1;
+    size_t ncap = b->in_cap ? b->in_cap : 65536;
+    while (ncap < b->in_len + extra + 1) ncap *= 2;
+    char *p = (char *)realloc(b->in, ncap);
+    if (!p) return 0;
+    b->in = p;
+    b->in_cap = ncap;
+    return 1;
+}
+
+/* 打开下一个输入文件，全部读完返回 0 */
+static int source_open_next(Source *s)
+{
+    while (s->file_i < s->nfiles) {
+        const char *path = s->files[s->file_i++];
+        s->fmt = recfmt_guess(path);
+        s->fp = fopen(path, "rb");
+        if (!s->fp) {
+            fprintf(stderr, "无法打开 %s\n", path);
+            g_read_failed = 1;
+            continue;
+        }
+        if (!recfmt_read_header(s->fmt, s->fp)) {
+            fprintf(stderr, "%s 不是有效的 %s 文件\n", path, recfmt_name(s->fmt));
+            fclose(s->fp);
+            s->fp = NULL;
+            g_read_failed = 1;
+            continue;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/* 从存档里切下一行：当前段读完就换下一段（压缩段在 store_segment_text 里解压） */
+static int source_store_line(Source *s, const char **line, size_t *len)
+{
+    for (;;) {
+        if (s->text && s->pos < s->text_len) {
+            const char *p = s->text + s->pos;
+            const char *nl = memchr(p, '\n', s->text_len - s->pos);
+            size_t n = nl ? (size_t)(nl - p) : s->text_len - s->pos;
+            s->pos += n + (nl ? 1 : 0);
+            if (n == 0) continue;
+            *line = p;
+            *len = n;
+            return 1;
+        }
+        free(s->text);
+        s->text = NULL;
+        if (s->seg >= store_segment_count()) return 0;
+        s->text = store_segment_text(s->seg++, &s->text_len);
+        s->pos = 0;
+        if (!s->text) g_read_failed = 1;
+    }
+}
+
+/* 往一批里装满单元，返回装进去的条数 */
+static int source_fill(Source *s, Batch *b)
+{
+    b->in_len = 0;
+    b->count = 0;
+
+    if (s->from_store) {
+        b->in_fmt = FMT_NDJSON;
+        const char *line;
+        size_t n;
+        while (b->count < BATCH_RECORDS && source_store_line(s, &line, &n)) {
+            if (!batch_reserve(b, n)) break;
+            memcpy(b->in + b->in_len, line, n);
+            b->off[b->count] = b->in_len;
+            b->len[b->count] = n;
+            b->in_len += n;
+            b->in[b->in_len++] = '\0';
+            b->count++;
+            g_bytes_in += n + 1;
+        }
+        return b->count;
+    }
+
+    /* 一批只放同一个文件（同一种格式）的单元 */
+    static char  *unit = NULL;
+    static size_t unit_cap = 0;
+    while (b->count < BATCH_RECORDS) {
+        if (!s->fp) {
+            if (b->count > 0 || !source_open_next(s)) break;
+        }
+        b->in_fmt = s->fmt;
+        size_t n = 0;
+        if (!recfmt_next_unit(s->fmt, s->fp, &unit, &n, &unit_cap)) {
+            fclose(s->fp);
+            s->fp = NULL;
+            continue;
+        }
+        if (!batch_reserve(b, n)) break;
+        memcpy(b->in + b->in_len, unit, n);
+        b->off[b->count] = b->in_len;
+        b->len[b->count] = n;
+        b->in_len += n;
+        b->in[b->in_len++] = '\0';
+        b->count++;
+        g_bytes_in += n;
+    }
+    if (b->count == 0) {
+        free(unit);
+        unit = NULL;
+        unit_cap = 0;
+    }
+    return b->count;
+}
+
+/* 读线程：按顺序填槽位，填不进去就等写线程腾出来 */
+static int reader_thread(void *arg)
+{
+    (void)arg;
+    long seq = 0;
+    for (;;) {
+        Batch *b = &g_slots[seq % g_nslots];
+        SDL_LockMutex(g_lock);
+        while (b->state != SLOT_EMPTY) SDL_CondWait(g_cond, g_lock);
+        SDL_UnlockMutex(g_lock);
+
+        /* 槽位是空的，只有读线程会碰它，装数据时不用持锁 */
+        if (source_fill(&g_src, b) == 0) break;
+
+        SDL_LockMutex(g_lock);
+        b->seq = seq++;
+        b->state = SLOT_FILLED;
+        SDL_CondBroadcast(g_cond);
+        SDL_UnlockMutex(g_lock);
+    }
+
+    SDL_LockMutex(g_lock);
+    g_batches_total = seq;
+    SDL_CondBroadcast(g_cond);
+    SDL_UnlockMutex(g_lock);
+    return 0;
+}
+
+/* 工作线程：领一批，逐条解码再编码成目标格式 */
+static int worker_thread(void *arg)
+{
+    (void)arg;
+    GameRecord *rec = (GameRecord *)malloc(sizeof(GameRecord));
+    if (!rec) return 1;
+
+    for (;;) {
+        Batch *b = NULL;
+        SDL_LockMutex(g_lock);
+        for (;;) {
+            for (int i = 0; i < g_nslots; i++) {
+                if (g_slots[i].state == SLOT_FILLED) {
+                    b = &g_slots[i];
+                    break;
+                }
+            }
+            if (b || g_batches_total >= 0) break;
+            SDL_CondWait(g_cond, g_lock);
+        }
+        if (b) b->state = SLOT_WORKING;
+        SDL_UnlockMutex(g_lock);
+        if (!b) break;   // 读完了，也没有剩下待处理的批
+
+        b->out_len = 0;
+        b->bad = 0;
+        for (int i = 0; i < b->count; i++) {
+            if (!recfmt_decode(b->in_fmt, b->in + b->off[i], b->len[i], rec) ||
+                !recfmt_encode(g_out_fmt, rec, &b->out, &b->out_len, &b->out_cap)) {
+                b->bad++;
+            }
+        }
+
+        SDL_LockMutex(g_lock);
+        b->state = SLOT_DONE;
+        SDL_CondBroadcast(g_cond);
+        SDL_UnlockMutex(g_lock);
+    }
+    free(rec);
+    return 0;
+}
+
+/* 导入的一批写进存档以后（还在存档锁里）把它们计进累计统计，和 save_record 一样每盘都算 */
+static int import_stats_locked(void *arg)
+{
+    const Batch *b = (const Batch *)arg;
+    return stats_add_lines_locked(b->out, b->out_len);
+}
+
+/* 跑一遍流水线。out 为 NULL 时写进存档，否则写文件。返回成功写出的条数，失败返回 -1 */
+static long run_pipeline(FILE *out, int threads)
+{
+    g_nslots = threads * 2 + 2;
+    g_slots = (Batch *)calloc((size_t)g_nslots, sizeof(Batch));
+    g_lock = SDL_CreateMutex();
+    g_cond = SDL_CreateCond();
+    if (!g_slots || !g_lock || !g_cond) return -1;
+
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    SDL_Thread *reader = SDL_CreateThread(reader_thread, "rec-reader", NULL);
+    SDL_Thread **workers = (SDL_Thread **)calloc((size_t)threads, sizeof(SDL_Thread *));
+    for (int i = 0; workers && i < threads; i++) {
+        workers[i] = SDL_CreateThread(worker_thread, "rec-worker", NULL);
+    }
+
+    /* 主线程负责写出：严格按批次序号，保证输出顺序和输入一致 */
+    long written = 0, bad = 0;
+    size_t bytes_out = 0;
+    int write_failed = 0;
+    for (long seq = 0;; seq++) {
+        Batch *b = &g_slots[seq % g_nslots];
+        SDL_LockMutex(g_lock);
+        while (!(b->state == SLOT_DONE && b->seq == seq) &&
+               !(g_batches_total >= 0 && seq >= g_batches_total)) {
+            SDL_CondWait(g_cond, g_lock);
+        }
+        int finished = (g_batches_total >= 0 && seq >= g_batches_total);
+        SDL_UnlockMutex(g_lock);
+        if (finished) break;
+
+        if (!write_failed && b->out_len > 0) {
+            int ok = out ? (fwrite(b->out, 1, b->out_len, out) == b->out_len)
+                         : store_append_batch(b->out, b->out_len, import_stats_locked, b);
+            if (!ok) write_failed = 1;
+        }
+        written += b->count - b->bad;
+        bad += b->bad;
+        bytes_out += b->out_len;
+
+        SDL_LockMutex(g_lock);
+        b->state = SLOT_EMPTY;
+        SDL_CondBroadcast(g_cond);
+        SDL_UnlockMutex(g_lock);
+    }
+
+    SDL_WaitThread(reader, NULL);
+    for (int i = 0; workers && i < threads; i++) SDL_WaitThread(workers[i], NULL);
+    free(workers);
+
+    double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+    if (secs <= 0) secs = 1e-9;
+    printf("%ld 条记录，跳过坏记录 %ld 条，用时 %.3f 秒\n", written, bad, secs);
+    printf("%.0f 条/秒，读 %.1f MB/s，写 %.1f MB/s（%d 个工作线程）\n",
+           written / secs, g_bytes_in / secs / 1e6, bytes_out / secs / 1e6, threads);
+
+    for (int i = 0; i < g_nslots; i++) {
+        free(g_slots[i].in);
+        free(g_slots[i].out);
+    }
+    free(g_slots);
+    g_slots = NULL;
+    SDL_DestroyCond(g_cond);
+    SDL_DestroyMutex(g_lock);
+
+    return (write_failed || g_read_failed) ? -1 : written;
+}
+
+/* ======= 按段并行处理整个存档 ======= */
+
+/* 一个段的处理结果 */
+typedef struct {
+    long   records;
+    long   bad;          // 坏记录条数
+    long   legacy;       // 没有校验字段的老记录
+    long   moves;        // 处理过的落子数（validate 用）
+    long   kinds[5];     // 按问题种类分的坏记录数（validate 用，下标见 ValidKind）
+    size_t bytes;        // 段的原始字节数
+    int    failed;       // 段文件读不出来
+    int   *bad_local;    // 坏记录的段内编号
+    int    bad_cap;
+} SegResult;
+
+typedef void (*SegFunc)(char *text, size_t len, SegResult *r);
+
+static SegmentInfo *g_snap = NULL;
+static int          g_snap_count = 0;
+static SegResult   *g_results = NULL;
+static SegFunc      g_seg_func = NULL;
+static SDL_atomic_t g_next_seg;
+
+static int segment_thread(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        int i = SDL_AtomicAdd(&g_next_seg, 1);
+        if (i >= g_snap_count) break;
+        size_t len = 0;
+        char *text = store_snapshot_text(&g_snap[i], &len);
+        if (!text) {
+            g_results[i].failed = 1;
+            continue;
+        }
+        g_results[i].bytes = len;
+        g_seg_func(text, len, &g_results[i]);
+        free(text);
+    }
+    return 0;
+}
+
+/* 对存档的每个段并行调用 fn；结果放在 g_results[i]。返回用时（秒），失败返回 -1 */
+static double run_segments(int threads, SegFunc fn)
+{
+    g_snap_count = store_snapshot(&g_snap);
+    if (g_snap_count < 0) return -1;
+    g_results = (SegResult *)calloc((size_t)(g_snap_count > 0 ? g_snap_count : 1), sizeof(SegResult));
+    if (!g_results) return -1;
+    g_seg_func = fn;
+    SDL_AtomicSet(&g_next_seg, 0);
+    if (threads > g_snap_count) threads = g_snap_count > 0 ? g_snap_count : 1;
+
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    SDL_Thread *tids[64];
+    for (int i = 0; i < threads; i++) tids[i] = SDL_CreateThread(segment_thread, "rec-seg", NULL);
+    for (int i = 0; i < threads; i++) SDL_WaitThread(tids[i], NULL);
+    double secs = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+    return secs > 0 ? secs : 1e-9;
+}
+
+static void free_segments(void)
+{
+    for (int i = 0; i < g_snap_count; i++) free(g_results[i].bad_local);
+    free(g_results);
+    free(g_snap);
+    g_results = NULL;
+    g_snap = NULL;
+    g_snap_count = 0;
+}
+
+static void note_bad(SegResult *r, int local)
+{
+    r->bad++;
+    if (r->bad > r->bad_cap) {
+        int ncap = r->bad_cap ? r->bad_cap * 2 : 16;
+        int *p = (int *)realloc(r->bad_local, sizeof(int) * (size_t)ncap);
+        if (!p) return;
+        r->bad_local = p;
+        r->bad_cap = ncap;
+    }
+    r->bad_local[r->bad - 1] = local;
+}
+
+/* verify：逐行校验 CRC，CRC 对得上（或是没有校验字段的老记录）再完整解析一遍，
+ * 和 load_record 的判断一致：CRC 只说明这一行没被改过，写进去时就是坏的照样解析不了 */
+static void verify_segment(char *text, size_t len, SegResult *r)
+{
+    GameRecord *rec = NULL;
+    size_t pos = 0;
+    while (pos < len) {
+        char *line = text + pos;
+        char *nl = memchr(line, '\n', len - pos);
+        size_t n = nl ? (size_t)(nl - line) : len - pos;
+        pos += n + (nl ? 1 : 0);
+        if (n == 0) continue;
+
+        int local = (int)r->records++;
+        int st = record_check(line, n);
+        if (st == RECORD_NO_CRC) r->legacy++;
+        if (st != RECORD_CORRUPT) {
+            if (!rec) rec = (GameRecord *)malloc(sizeof(GameRecord));
+            /* record_from_json 要 '\0' 结尾的行，段文本里这一行后面就是 '\n'，临时截断 */
+            if (rec && nl) *nl = '\0';
+            if (rec && !record_from_json(line, rec)) st = RECORD_CORRUPT;
+            if (nl) *nl = '\n';
+        }
+        if (st == RECORD_CORRUPT) note_bad(r, local);
+    }
+    free(rec);
+}
+
+/* ======= validate：按规则重下每一局 ======= */
+
+typedef enum {
+    VALID_OK = 0,
+    VALID_UNREADABLE,    // 解析不了（或 CRC 不对）
+    VALID_WRONG_TURN,    // 落子方和轮到的一方不符
+    VALID_ILLEGAL,       // 越界 / 落在已有棋子上 / 分出胜负后还在下
+    VALID_WRONG_WINNER   // 记录的胜者和规则算出来的不一样
+} ValidKind;
+
+static const char *valid_kind_name(int kind)
+{
+    switch (kind) {
+    case VALID_UNREADABLE:   return "无法解析";
+    case VALID_WRONG_TURN:   return "落子顺序不对";
+    case VALID_ILLEGAL:      return "非法落子";
+    case VALID_WRONG_WINNER: return "胜者不一致";
+    default:                 return "正常";
+    }
+}
+
+/* 用 place_stone（内部调 check_win）从空棋盘重下 rec 里的每一步。
+ * board 是调用者给的工作区，避免每局在栈上放一个 GameState。
+ * 返回 ValidKind；出问题的那一手（从 1 开始）写到 *at */
+static int replay_record(const GameRecord *rec, GameState *board, int *at)
+{
+    const GameState *g = &rec->game;
+    init_game(board);
+    *at = 0;
+    for (int i = 0; i < g->moves_count; i++) {
+        const Move *m = &g->moves[i];
+        *at = i + 1;
+        if (board->finished) return VALID_ILLEGAL;
+        if (m->player != board->current_player) return VALID_WRONG_TURN;
+        if (!place_stone(board, m->row, m->col)) return VALID_ILLEGAL;
+    }
+    *at = 0;
+    /* 没下完就退出的对局记录的胜者是 0，规则这边也还没分胜负，两边一致 */
+    if (board->winner != g->winner) return VALID_WRONG_WINNER;
+    return VALID_OK;
+}
+
+typedef struct {
+    GameRecord rec;
+    GameState  board;
+} ValidWork;
+
+/* 校验一行（'\0' 结尾），返回 ValidKind；落子数加到 *moves */
+static int validate_line(const char *line, ValidWork *w, long *moves, int *at)
+{
+    *at = 0;
+    if (!record_from_json(line, &w->rec)) return VALID_UNREADABLE;
+    *moves += w->rec.game.moves_count;
+    return replay_record(&w->rec, &w->board, at);
+}
+
+static void validate_segment(char *text, size_t len, SegResult *r)
+{
+    ValidWork *w = (ValidWork *)malloc(sizeof(ValidWork));
+    if (!w) {
+        r->failed = 1;
+        return;
+    }
+    size_t pos = 0;
+    while (pos < len) {
+        char *line = text + pos;
+        char *nl = memchr(line, '\n', len - pos);
+        size_t n = nl ? (size_t)(nl - line) : len - pos;
+        pos += n + (nl ? 1 : 0);
+        if (n == 0) continue;
+
+        int local = (int)r->records++;
+        /* 段文本里这一行后面就是 '\n'，临时截断成字符串；最后一行后面是 '\0' */
+        if (nl) *nl = '\0';
+        int at;
+        int kind = validate_line(line, w, &r->moves, &at);
+        if (nl) *nl = '\n';
+        if (kind != VALID_OK) {
+            r->kinds[kind]++;
+            note_bad(r, local);
+        }
+    }
+    free(w);
+}
+
+static int cmd_validate(int threads)
+{
+    double secs = run_segments(threads, validate_segment);
+    if (secs < 0) {
+        fprintf(stderr, "读取 manifest 失败\n");
+        return 1;
+    }
+
+    long records = 0, bad = 0, moves = 0, kinds[5] = {0};
+    int failed = 0;
+    for (int i = 0; i < g_snap_count; i++) {
+        SegResult *r = &g_results[i];
+        records += r->records;
+        bad += r->bad;
+        moves += r->moves;
+        for (int k = 0; k < 5; k++) kinds[k] += r->kinds[k];
+        if (r->failed) {
+            fprintf(stderr, "段 %d 读取失败\n", g_snap[i].id);
+            failed = 1;
+        }
+    }
+    printf("%ld 局（%d 个段），%ld 手，有问题的 %ld 局\n", records, g_snap_count, moves, bad);
+    for (int k = 1; k < 5; k++) {
+        if (kinds[k] > 0) printf("  %s：%ld 局\n", valid_kind_name(k), kinds[k]);
+    }
+    printf("用时 %.3f 秒，%.0f 手/秒，%.0f 局/秒（%d 个线程）\n",
+           secs, moves / secs, records / secs, threads);
+
+    /* 逐条列出问题记录：再读一遍这几条，把出问题的那一手也打出来 */
+    ValidWork *w = (ValidWork *)malloc(sizeof(ValidWork));
+    for (int i = 0, base = 0; w && i < g_snap_count; base += g_snap[i].count, i++) {
+        for (int k = 0; k < g_results[i].bad && k < g_results[i].bad_cap; k++) {
+            int index = base + g_results[i].bad_local[k];
+            char *line = store_read_line(index);
+            long unused = 0;
+            int at = 0;
+            int kind = line ? validate_line(line, w, &unused, &at) : VALID_UNREADABLE;
+            if (at > 0) {
+                const Move *m = &w->rec.game.moves[at - 1];
+                printf("  第 %d 条记录：%s（第 %d 手，%s 落在 %d,%d）\n", index + 1, valid_kind_name(kind),
+                       at, m->player == 1 ? "黑" : "白", m->row, m->col);
+            } else if (kind == VALID_WRONG_WINNER) {
+                printf("  第 %d 条记录：%s（记录是 %d，重下是 %d）\n", index + 1, valid_kind_name(kind),
+                       w->rec.game.winner, w->board.winner);
+            } else {
+                printf("  第 %d 条记录：%s\n", index + 1, valid_kind_name(kind));
+            }
+            free(line);
+        }
+    }
+    free(w);
+
+    free_segments();
+    return (bad > 0 || failed) ? 1 : 0;
+}
+
+static int cmd_verify(int threads, int quarantine)
+{
+    double secs = run_segments(threads, verify_segment);
+    if (secs < 0) {
+        fprintf(stderr, "读取 manifest 失败\n");
+        return 1;
+    }
+
+    long records = 0, bad = 0, legacy = 0;
+    size_t bytes = 0;
+    int failed = 0;
+    for (int i = 0; i < g_snap_count; i++) {
+        SegResult *r = &g_results[i];
+        records += r->records;
+        bad += r->bad;
+        legacy += r->legacy;
+        bytes += r->bytes;
+        if (r->failed) {
+            fprintf(stderr, "段 %d 读取失败\n", g_snap[i].id);
+            failed = 1;
+        }
+    }
+    printf("%ld 条记录（%d 个段），坏记录 %ld 条，无校验的老记录 %ld 条\n", records, g_snap_count, bad, legacy);
+    printf("用时 %.3f 秒，%.0f 条/秒，%.2f GB/s（CRC32C %s，%d 个线程）\n",
+           secs, records / secs, bytes / secs / 1e9,
+           crc32c_hw_available() ? "SSE4.2" : "查表", threads);
+
+    if (bad > 0 && quarantine) {
+        /* 从后往前删，前面记录的全局编号不受影响 */
+        long base = 0;
+        for (int i = 0; i < g_snap_count; i++) base += g_snap[i].count;
+        for (int i = g_snap_count - 1; i >= 0; i--) {
+            base -= g_snap[i].count;
+            for (int k = (int)g_results[i].bad - 1; k >= 0; k--) {
+                if (k >= g_results[i].bad_cap) continue;
+                int index = (int)base + g_results[i].bad_local[k];
+                char *line = store_read_line(index);
+                if (line) {
+                    quarantine_record(line);
+                    free(line);
+                }
+                if (!store_delete(index)) fprintf(stderr, "删除第 %d 条记录失败\n", index + 1);
+            }
+        }
+        printf("已把 %ld 条坏记录移到 liu/data/quarantine.json\n", bad);
+    } else {
+        for (int i = 0, base = 0; i < g_snap_count; base += g_snap[i].count, i++) {
+            for (int k = 0; k < g_results[i].bad && k < g_results[i].bad_cap; k++) {
+                printf("  第 %d 条记录损坏（段 %d）\n", base + g_results[i].bad_local[k] + 1, g_snap[i].id);
+            }
+        }
+    }
+
+    free_segments();
+    return (bad > 0 || failed) ? 1 : 0;
+}
+
+/* ======= render：把每局的终局画成图片 ======= */
+
+static const char *g_render_dir = NULL;
+static int         g_render_size = 256;
+static const char *g_render_ext = "png";
+
+static void render_segment(char *text, size_t len, SegResult *r)
+{
+    /* 这个段前面一共有多少条记录：文件名用存档里的全局编号 */
+    int seg = (int)(r - g_results);
+    int base = 0;
+    for (int i = 0; i < seg; i++) base += g_snap[i].count;
+
+    GameRecord *rec = (GameRecord *)malloc(sizeof(GameRecord));
+    if (!rec) {
+        r->failed = 1;
+        return;
+    }
+    size_t pos = 0;
+    while (pos < len) {
+        char *line = text + pos;
+        char *nl = memchr(line, '\n', len - pos);
+        size_t n = nl ? (size_t)(nl - line) : len - pos;
+        pos += n + (nl ? 1 : 0);
+        if (n == 0) continue;
+
+        int local = (int)r->records++;
+        if (nl) *nl = '\0';
+        int ok = record_from_json(line, rec);
+        if (nl) *nl = '\n';
+
+        /* 每个线程画自己的：boardimg_render 每次建一个软件渲染器，线程之间不共享任何东西 */
+        SDL_Surface *img = ok ? boardimg_render(&rec->game, g_render_size) : NULL;
+        if (img) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%06d.%s", g_render_dir, base + local + 1, g_render_ext);
+            ok = boardimg_save(img, path);
+            SDL_FreeSurface(img);
+        } else {
+            ok = 0;
+        }
+        if (!ok) note_bad(r, local);
+    }
+    free(rec);
+}
+
+static int cmd_render(int threads, const char *dir, int size, int bmp)
+{
+    struct stat st;
+    if (stat(dir, &st) != 0) {
+        #ifdef _WIN32
+        mkdir(dir);
+        #else
+        mkdir(dir, 0755);
+        #endif
+    }
+    g_render_dir = dir;
+    g_render_size = size;
+    g_render_ext = bmp ? "bmp" : "png";
+
+    double secs = run_segments(threads, render_segment);
+    if (secs < 0) {
+        fprintf(stderr, "读取 manifest 失败\n");
+        return 1;
+    }
+
+    long records = 0, bad = 0;
+    int failed = 0;
+    for (int i = 0; i < g_snap_count; i++) {
+        SegResult *r = &g_results[i];
+        records += r->records;
+        bad += r->bad;
+        if (r->failed) {
+            fprintf(stderr, "段 %d 读取失败\n", g_snap[i].id);
+            failed = 1;
+        }
+    }
+    printf("%ld 局，画出 %ld 张 %d×%d 的 %s 到 %s，失败 %ld 张\n",
+           records, records - bad, size, size, g_render_ext, dir, bad);
+    printf("用时 %.3f 秒，%.0f 张/秒，%.1f 百万像素/秒（%d 个线程）\n",
+           secs, (records - bad) / secs, (double)(records - bad) * size * size / secs / 1e6, threads);
+
+    for (int i = 0, base = 0; i < g_snap_count; base += g_snap[i].count, i++) {
+        for (int k = 0; k < g_results[i].bad && k < g_results[i].bad_cap; k++) {
+            printf("  第 %d 条记录没画出来\n", base + g_results[i].bad_local[k] + 1);
+        }
+    }
+
+    free_segments();
+    return (bad > 0 || failed) ? 1 : 0;
+}
+
+/* 一行统计：盘数、胜负、平均手数和用时 */
+static void print_totals(const char *label, const StatTotals *t)
+{
+    int avg = (int)(stats_avg_seconds(t) + 0.5);
+    printf("  %-12s %6d 盘  黑胜 %6d  白胜 %6d  未分胜负 %5d  均 %5.1f 手",
+           label, t->games, t->black_wins, t->white_wins, t->draws, stats_avg_moves(t));
+    if (t->timed > 0) printf("  均 %d:%02d", avg / 60, avg % 60);
+    printf("\n");
+}
+
+static int cmd_stats(int rebuild)
+{
+    if (rebuild) {
+        int n = stats_rebuild();
+        if (n < 0) {
+            fprintf(stderr, "重建统计失败\n");
+            return 1;
+        }
+        printf("已从存档重新统计 %d 盘\n", n);
+    }
+
+    StatTotals t;
+    printf("累计：\n");
+    for (int m = 1; m < STATS_MODES; m++) {
+        if (stats_totals(m, &t) && t.games > 0) print_totals(stats_mode_name(m), &t);
+    }
+    if (stats_totals(0, &t) && t.games > 0) print_totals(stats_mode_name(0), &t);
+    if (stats_totals(-1, &t)) print_totals("合计", &t);
+
+    StatDay *days = NULL;
+    int n = stats_load_days(&days);
+    if (n > 0) {
+        printf("按天：\n");
+        /* 同一天的几个模式合成一行 */
+        for (int i = 0; i < n; ) {
+            StatTotals day;
+            memset(&day, 0, sizeof(day));
+            int d = days[i].day;
+            for (; i < n && days[i].day == d; i++) {
+                day.games += days[i].t.games;
+                day.black_wins += days[i].t.black_wins;
+                day.white_wins += days[i].t.white_wins;
+                day.draws += days[i].t.draws;
+                day.timed += days[i].t.timed;
+                day.total_moves += days[i].t.total_moves;
+                day.total_seconds += days[i].t.total_seconds;
+            }
+            char label[16];
+            if (d > 0) snprintf(label, sizeof(label), "%04d-%02d-%02d", d / 10000, d / 100 % 100, d % 100);
+            else snprintf(label, sizeof(label), "(无日期)");
+            print_totals(label, &day);
+        }
+    }
+    free(days);
+    return n < 0 ? 1 : 0;
+}
+
+static void usage(void)
+{
+    printf("用法：\n");
+    printf("  recordtool [-j N] convert <输入> <输出>\n");
+    printf("  recordtool [-j N] export  <输出>\n");
+    printf("  recordtool [-j N] import  <输入> [<输入>...]\n");
+    printf("  recordtool [-j N] verify  [-q]\n");
+    printf("  recordtool [-j N] validate\n");
+    printf("  recordtool [-j N] render  <输出目录> [--size N] [--bmp]\n");
+    printf("  recordtool stats [--rebuild]\n");
+    printf("格式按扩展名判断：.bin 二进制，.sgf 棋谱，其余为 NDJSON\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = SDL_GetCPUCount();
+    int argi = 1;
+    while (argi < argc && argv[argi][0] == '-') {
+        if (strcmp(argv[argi], "-j") == 0 && argi + 1 < argc) {
+            threads = atoi(argv[argi + 1]);
+            argi += 2;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (threads > 64) threads = 64;
+    if (argi >= argc) {
+        usage();
+        return 1;
+    }
+
+    const char *cmd = argv[argi++];
+    FILE *out = NULL;
+    memset(&g_src, 0, sizeof(g_src));
+
+    if (strcmp(cmd, "convert") == 0 && argc - argi == 2) {
+        g_src.files = &argv[argi];
+        g_src.nfiles = 1;
+        g_out_fmt = recfmt_guess(argv[argi + 1]);
+        out = fopen(argv[argi + 1], "wb");
+    } else if (strcmp(cmd, "export") == 0 && argc - argi == 1) {
+        g_src.from_store = 1;
+        g_out_fmt = recfmt_guess(argv[argi]);
+        out = fopen(argv[argi], "wb");
+    } else if (strcmp(cmd, "verify") == 0 && argc - argi <= 1) {
+        int quarantine = (argc - argi == 1 && strcmp(argv[argi], "-q") == 0);
+        if (argc - argi == 1 && !quarantine) {
+            usage();
+            return 1;
+        }
+        return cmd_verify(threads, quarantine);
+    } else if (strcmp(cmd, "validate") == 0 && argc - argi == 0) {
+        return cmd_validate(threads);
+    } else if (strcmp(cmd, "render") == 0 && argc - argi >= 1) {
+        const char *dir = argv[argi++];
+        int size = 256, bmp = 0;
+        for (; argi < argc; argi++) {
+            if (strcmp(argv[argi], "--size") == 0 && argi + 1 < argc) {
+                size = atoi(argv[++argi]);
+            } else if (strcmp(argv[argi], "--bmp") == 0) {
+                bmp = 1;
+            } else {
+                usage();
+                return 1;
+            }
+        }
+        if (size < BOARDIMG_MIN_SIZE || size > BOARDIMG_MAX_SIZE) {
+            fprintf(stderr, "图片边长要在 %d 到 %d 之间\n", BOARDIMG_MIN_SIZE, BOARDIMG_MAX_SIZE);
+            return 1;
+        }
+        return cmd_render(threads, dir, size, bmp);
+    } else if (strcmp(cmd, "stats") == 0 && argc - argi <= 1) {
+        int rebuild = (argc - argi == 1 && strcmp(argv[argi], "--rebuild") == 0);
+        if (argc - argi == 1 && !rebuild) {
+            usage();
+            return 1;
+        }
+        return cmd_stats(rebuild);
+    } else if (strcmp(cmd, "import") == 0 && argc - argi >= 1) {
+        g_src.files = &argv[argi];
+        g_src.nfiles = argc - argi;
+        g_out_fmt = FMT_NDJSON;   // 存档本身就是 NDJSON
+        store_ensure_dir();
+    } else {
+        usage();
+        return 1;
+    }
+
+    if (strcmp(cmd, "import") != 0) {
+        if (!out) {
+            fprintf(stderr, "无法创建输出文件\n");
+            return 1;
+        }
+        recfmt_write_header(g_out_fmt, out);
+    }
+
+    int before = out ? 0 : store_count();
+    long n = run_pipeline(out, threads);
+    if (out && fclose(out) != 0) n = -1;
+    if (!out && n >= 0) {
+        /* 存档按落子序列去重，重复的对局只加引用计数 */
+        int added = store_count() - before;
+        printf("存档新增 %d 条，%ld 条是已有对局的重复\n", added, n - added);
+    }
+    return n < 0 ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * replay.c
+ * 关键帧 + 增量的回放索引。
+ */
+
+#include "replay.h"
+#include <string.h>
+
+/* 棋盘 -> 每格 2 bit 的紧凑形式 */
+static void pack_board(const Cell cells[BOARD_SIZE][BOARD_SIZE], uint8_t *out)
+{
+    memset(out, 0, REPLAY_PACKED_BYTES);
+    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+        Cell c = cells[i / BOARD_SIZE][i % BOARD_SIZE];
+        out[i >> 2] |= (uint8_t)((c & 3) << ((i & 3) * 2));
+    }
+}
+
+static void unpack_board(const uint8_t *in, Cell cells[BOARD_SIZE][BOARD_SIZE])
+{
+    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+        cells[i / BOARD_SIZE][i % BOARD_SIZE] = (Cell)((in[i >> 2] >> ((i & 3) * 2)) & 3);
+    }
+}
+
+/* 把一手直接摆到棋盘上。回放严格照记录来，不再走 place_stone 的规则判断 */
+static void apply_move(Cell cells[BOARD_SIZE][BOARD_SIZE], const Move *m)
+{
+    if (!within_board(m->row, m->col)) return;
+    cells[m->row][m->col] = (m->player == 1) ? CELL_BLACK : CELL_WHITE;
+}
+
+void replay_build(Replay *rp, const GameState *game)
+{
+    if (!rp) return;
+    memset(rp, 0, sizeof(*rp));
+    if (!game) return;
+
+    rp->total = game->moves_count;
+    rp->winner = game->winner;
+    rp->undo_count = game->undo_count;
+    memcpy(rp->moves, game->moves, sizeof(Move) * (size_t)rp->total);
+
+    Cell cells[BOARD_SIZE][BOARD_SIZE];
+    memset(cells, 0, sizeof(cells));
+    pack_board(cells, rp->keys[0]);
+    rp->key_count = 1;
+    for (int i = 0; i < rp->total; i++) {
+        apply_move(cells, &rp->moves[i]);
+        if ((i + 1) % REPLAY_KEYFRAME_INTERVAL == 0 && rp->key_count < REPLAY_MAX_KEYFRAMES) {
+            pack_board(cells, rp->keys[rp->key_count++]);
+        }
+    }
+}
+
+void replay_seek(const Replay *rp, int n, GameState *out)
+{
+    if (!rp || !out) return;
+    if (n < 0) n = 0;
+    if (n > rp->total) n = rp->total;
+
+    int k = n / REPLAY_KEYFRAME_INTERVAL;
+    if (k >= rp->key_count) k = rp->key_count - 1;
+
+    init_game(out);
+    unpack_board(rp->keys[k], out->cells);
+    for (int i = k * REPLAY_KEYFRAME_INTERVAL; i < n; i++) apply_move(out->cells, &rp->moves[i]);
+
+    memcpy(out->moves, rp->moves, sizeof(Move) * (size_t)n);
+    out->moves_count = n;
+    out->undo_count = rp->undo_count;
+    /* 下一手该谁：有下一手就照记录，否则按手数轮换 */
+    out->current_player = (n < rp->total) ? rp->moves[n].player : ((n % 2 == 0) ? 1 : 2);
+    out->finished = (n == rp->total);
+    out->winner = out->finished ? rp->winner : 0;
+}
+
+/* ========== 播放时钟 ========== */
+
+static const double SPEEDS[REPLAY_SPEED_COUNT] = {
+    0.1, 0.25, 0.5, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1000
+};
+
+double replay_speed(int speed)
+{
+    if (speed < 0) speed = 0;
+    if (speed >= REPLAY_SPEED_COUNT) speed = REPLAY_SPEED_COUNT - 1;
+    return SPEEDS[speed];
+}
+
+/* 当前档位下每手多少毫秒 */
+static double interval_ms(const ReplayClock *c)
+{
+    return REPLAY_BASE_INTERVAL_MS / replay_speed(c->speed);
+}
+
+void replay_clock_init(ReplayClock *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->speed = REPLAY_SPEED_DEFAULT;
+}
+
+void replay_clock_play(ReplayClock *c, int move, double now_ms)
+{
+    c->playing = 1;
+    c->origin_move = move;
+    c->origin_ms = now_ms;
+}
+
+void replay_clock_pause(ReplayClock *c)
+{
+    c->playing = 0;
+}
+
+void replay_clock_shift(ReplayClock *c, int delta, int move, double now_ms)
+{
+    int speed = c->speed + delta;
+    if (speed < 0) speed = 0;
+    if (speed >= REPLAY_SPEED_COUNT) speed = REPLAY_SPEED_COUNT - 1;
+    c->speed = speed;
+    if (c->playing) replay_clock_play(c, move, now_ms);
+}
+
+int replay_clock_move(const ReplayClock *c, int total, double now_ms)
+{
+    if (!c->playing) return -1;
+    double elapsed = now_ms - c->origin_ms;
+    if (elapsed < 0) elapsed = 0;
+    /* 加一点点余量：刚好到 replay_clock_next 给的时刻时，浮点误差不能让它还停在上一手 */
+    double steps = elapsed / interval_ms(c) + 1e-6;
+    if (steps > total) steps = total;   // 先夹住，免得转 int 溢出
+    int move = c->origin_move + (int)steps;
+    if (move < 0) move = 0;
+    if (move > total) move = total;
+    return move;
+}
+
+double replay_clock_next(const ReplayClock *c, int move)
+{
+    return c->origin_ms + (move + 1 - c->origin_move) * interval_ms(c);
+}
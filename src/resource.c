@@ -0,0 +1,147 @@
+/*
+ * resource.c
+ * 字体、图片的一次性加载和进程级缓存（见 resource.h）。
+ */
+
+#include "resource.h"
+#include "perf.h"
+#include <stdio.h>
+
+static const char *FONT_PATHS[RES_FONT_COUNT] = {
+    "C:\\\\Windows\\\\Fonts\\\\simsun.ttc",   /* 注意双反斜杠 */
+    "C:\\\\Windows\\\\Fonts\\\\simsun.ttc",
+};
+static const int FONT_SIZES[RES_FONT_COUNT] = {
+    RES_MENU_FONT_SIZE,
+    RES_SMALL_FONT_SIZE,
+};
+
+/*
+ * SDL2 自带的图片加载接口 SDL_LoadBMP() 只支持 BMP，
+ * 所以背景图用的是 image/yinghua.jpg 转出来的 image/menu_bg.bmp。
+ */
+static const char *IMAGE_PATHS[RES_IMAGE_COUNT] = {
+    "image/menu_bg.bmp",
+};
+
+static TTF_Font     *g_fonts[RES_FONT_COUNT];
+static int           g_font_px[RES_FONT_COUNT];   // 当前字号（像素）
+static SDL_Surface  *g_images[RES_IMAGE_COUNT];
+static SDL_Texture  *g_textures[RES_IMAGE_COUNT];
+static SDL_Renderer *g_tex_ren = NULL;     // g_textures 属于哪个 renderer
+
+static SDL_Thread *g_loader = NULL;
+static int         g_ttf_ok = 0;
+
+/* 后台线程：打开字体、解码图片。只写 g_fonts / g_images，主线程等它结束后才读 */
+static int loader_main(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < RES_FONT_COUNT && g_ttf_ok; i++) {
+        g_fonts[i] = TTF_OpenFont(FONT_PATHS[i], FONT_SIZES[i]);
+        g_font_px[i] = FONT_SIZES[i];
+        if (!g_fonts[i]) fprintf(stderr, "TTF_OpenFont(%s) error: %s\n", FONT_PATHS[i], TTF_GetError());
+    }
+    for (int i = 0; i < RES_IMAGE_COUNT; i++) {
+        g_images[i] = SDL_LoadBMP(IMAGE_PATHS[i]);
+        /* 这一步失败不致命：只是没背景图而已 */
+        if (!g_images[i]) fprintf(stderr, "SDL_LoadBMP(%s) error: %s\n", IMAGE_PATHS[i], SDL_GetError());
+    }
+    return 0;
+}
+
+/* 等后台加载结束（只在主线程里调用） */
+static void wait_loaded(void)
+{
+    if (g_loader) {
+        SDL_WaitThread(g_loader, NULL);
+        g_loader = NULL;
+    }
+}
+
+int res_init(void)
+{
+    if (!TTF_WasInit() && TTF_Init() != 0) {
+        fprintf(stderr, "TTF_Init error: %s\n", TTF_GetError());
+    } else {
+        g_ttf_ok = 1;
+    }
+    g_loader = SDL_CreateThread(loader_main, "res_loader", NULL);
+    if (!g_loader) loader_main(NULL);   /* 开不了线程就当场加载 */
+    return g_ttf_ok;
+}
+
+void res_shutdown(void)
+{
+    wait_loaded();
+    res_release_textures();
+    for (int i = 0; i < RES_FONT_COUNT; i++) {
+        if (g_fonts[i]) TTF_CloseFont(g_fonts[i]);
+        g_fonts[i] = NULL;
+        g_font_px[i] = 0;
+    }
+    for (int i = 0; i < RES_IMAGE_COUNT; i++) {
+        if (g_images[i]) SDL_FreeSurface(g_images[i]);
+        g_images[i] = NULL;
+    }
+    if (g_ttf_ok && TTF_WasInit()) TTF_Quit();
+    g_ttf_ok = 0;
+}
+
+TTF_Font *res_font(ResFont id)
+{
+    if (id < 0 || id >= RES_FONT_COUNT) return NULL;
+    wait_loaded();
+    return g_fonts[id];
+}
+
+int res_font_size(ResFont id)
+{
+    if (id < 0 || id >= RES_FONT_COUNT) return 0;
+    wait_loaded();
+    return g_font_px[id] ? g_font_px[id] : FONT_SIZES[id];
+}
+
+void res_set_font_scale(float scale)
+{
+    wait_loaded();
+    for (int i = 0; i < RES_FONT_COUNT; i++) {
+        int px = (int)(FONT_SIZES[i] * scale + 0.5f);
+        if (px < 6) px = 6;
+        if (!g_fonts[i] || px == g_font_px[i]) continue;
+        if (TTF_SetFontSize(g_fonts[i], px) == 0) {
+            g_font_px[i] = px;
+        } else {
+            fprintf(stderr, "TTF_SetFontSize error: %s\n", TTF_GetError());
+        }
+    }
+}
+
+SDL_Texture *res_texture(SDL_Renderer *ren, ResImage id)
+{
+    if (!ren || id < 0 || id >= RES_IMAGE_COUNT) return NULL;
+    if (ren != g_tex_ren) {
+        res_release_textures();
+        g_tex_ren = ren;
+    }
+    if (g_textures[id]) return g_textures[id];
+
+    wait_loaded();
+    if (!g_images[id]) return NULL;
+    g_textures[id] = SDL_CreateTextureFromSurface(ren, g_images[id]);
+    if (!g_textures[id]) {
+        fprintf(stderr, "SDL_CreateTextureFromSurface error: %s\n", SDL_GetError());
+    } else {
+        perf_count_upload();
+    }
+    return g_textures[id];
+}
+
+void res_release_textures(void)
+{
+    for (int i = 0; i < RES_IMAGE_COUNT; i++) {
+        if (g_textures[i]) SDL_DestroyTexture(g_textures[i]);
+        g_textures[i] = NULL;
+    }
+    g_tex_ren = NULL;
+}
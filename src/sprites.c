@@ -0,0 +1,163 @@
+/*
+ * sprites.c
+ * 棋子贴图的光栅化和缓存（见 sprites.h）。
+ *
+ * 抗锯齿：每个像素分成 4×4 个子采样点，落在圆内的比例就是这个像素的不透明度。
+ * 立体感：以左上方一点为“光源”，越靠近它颜色越亮，边缘稍暗。
+ */
+
+#include "sprites.h"
+#include "perf.h"
+#include <math.h>
+#include <stdlib.h>
+
+/* 每种棋子最多缓存几个不同半径（窗口缩放时半径会变） */
+#define SPRITE_SIZES 4
+
+#define SUBSAMPLES 4
+
+typedef struct {
+    int          radius;   // 0 = 空位
+    SDL_Texture *tex;
+} SpriteSlot;
+
+static SpriteSlot    g_sprites[SPRITE_KIND_COUNT][SPRITE_SIZES];
+static int           g_next[SPRITE_KIND_COUNT];   // 满了以后轮流覆盖
+static SDL_Renderer *g_ren = NULL;
+
+/* 三种棋子的颜色：底色、高光色、边缘色 */
+typedef struct {
+    float base[3];
+    float light[3];
+    float rim[3];
+    int   shaded;          // 0 = 纯色（红点）
+} StoneStyle;
+
+static const StoneStyle STYLES[SPRITE_KIND_COUNT] = {
+    { {20, 20, 20},    {110, 110, 110}, {0, 0, 0},       1 },
+    { {230, 230, 230}, {255, 255, 255}, {180, 180, 175}, 1 },
+    { {200, 30, 30},   {200, 30, 30},   {200, 30, 30},   0 },
+};
+
+static float clamp01(float v)
+{
+    return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+void sprite_rasterize(SpriteKind kind, int radius, Uint32 *pixels)
+{
+    int size = 2 * radius + 1;
+    const StoneStyle *st = &STYLES[kind];
+    /* 圆心在中间像素的中心；半径多给半个像素，边缘刚好落在格子上 */
+    float c = radius + 0.5f;
+    float rr = radius + 0.5f;
+    /* 光源在左上方 */
+    float lx = c - rr * 0.35f, ly = c - rr * 0.4f;
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int inside = 0;
+            for (int sy = 0; sy < SUBSAMPLES; sy++) {
+                for (int sx = 0; sx < SUBSAMPLES; sx++) {
+                    float px = x + (sx + 0.5f) / SUBSAMPLES - c;
+                    float py = y + (sy + 0.5f) / SUBSAMPLES - c;
+                    if (px * px + py * py <= rr * rr) inside++;
+                }
+            }
+            float alpha = (float)inside / (SUBSAMPLES * SUBSAMPLES);
+
+            float col[3];
+            float px = x + 0.5f, py = y + 0.5f;
+            if (st->shaded) {
+                float dl = sqrtf((px - lx) * (px - lx) + (py - ly) * (py - ly)) / (rr * 1.3f);
+                float hl = clamp01(1.0f - dl);
+                hl *= hl;
+                float de = sqrtf((px - c) * (px - c) + (py - c) * (py - c)) / rr;
+                float rim = clamp01((de - 0.75f) / 0.25f) * 0.6f;
+                for (int k = 0; k < 3; k++) {
+                    float v = st->base[k] + (st->light[k] - st->base[k]) * hl;
+                    col[k] = v + (st->rim[k] - v) * rim;
+                }
+            } else {
+                for (int k = 0; k < 3; k++) col[k] = st->base[k];
+            }
+
+            Uint32 a = (Uint32)(alpha * 255.0f + 0.5f);
+            Uint32 r = (Uint32)col[0], g = (Uint32)col[1], b = (Uint32)col[2];
+            pixels[y * size + x] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
+
+/* 画一张 (2r+1) 见方的 ARGB 贴图 */
+static SDL_Texture *rasterize(SDL_Renderer *ren, SpriteKind kind, int radius)
+{
+    int size = 2 * radius + 1;
+    Uint32 *pixels = (Uint32 *)malloc((size_t)size * (size_t)size * sizeof(Uint32));
+    if (!pixels) return NULL;
+    sprite_rasterize(kind, radius, pixels);
+
+    SDL_Texture *tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+    if (tex) {
+        SDL_UpdateTexture(tex, NULL, pixels, size * (int)sizeof(Uint32));
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    }
+    free(pixels);
+    return tex;
+}
+
+SDL_Texture *sprite_get(SDL_Renderer *ren, SpriteKind kind, int radius)
+{
+    if (!ren || kind < 0 || kind >= SPRITE_KIND_COUNT || radius <= 0) return NULL;
+    if (ren != g_ren) {
+        sprites_release();
+        g_ren = ren;
+    }
+
+    SpriteSlot *slots = g_sprites[kind];
+    for (int i = 0; i < SPRITE_SIZES; i++) {
+        if (slots[i].radius == radius) return slots[i].tex;
+    }
+
+    SDL_Texture *tex = rasterize(ren, kind, radius);
+    if (!tex) return NULL;
+    perf_count_upload();
+    SpriteSlot *s = &slots[g_next[kind]];
+    g_next[kind] = (g_next[kind] + 1) % SPRITE_SIZES;
+    if (s->tex) SDL_DestroyTexture(s->tex);
+    s->radius = radius;
+    s->tex = tex;
+    return tex;
+}
+
+void sprite_draw(SDL_Renderer *ren, SpriteKind kind, int cx, int cy, int radius)
+{
+    SDL_Texture *tex = sprite_get(ren, kind, radius);
+    if (tex) {
+        SDL_Rect dst = {cx - radius, cy - radius, 2 * radius + 1, 2 * radius + 1};
+        SDL_RenderCopy(ren, tex, NULL, &dst);
+        perf_count_draw(1);
+        return;
+    }
+    /* 退路：逐行画实心圆（以前的画法） */
+    const StoneStyle *st = &STYLES[kind];
+    SDL_SetRenderDrawColor(ren, (Uint8)st->base[0], (Uint8)st->base[1], (Uint8)st->base[2], 255);
+    for (int dy = -radius; dy <= radius; dy++) {
+        int dx_max = (int)sqrt((double)radius * radius - dy * dy);
+        SDL_RenderDrawLine(ren, cx - dx_max, cy + dy, cx + dx_max, cy + dy);
+    }
+    perf_count_draw(2 * radius + 1);
+}
+
+void sprites_release(void)
+{
+    for (int k = 0; k < SPRITE_KIND_COUNT; k++) {
+        for (int i = 0; i < SPRITE_SIZES; i++) {
+            if (g_sprites[k][i].tex) SDL_DestroyTexture(g_sprites[k][i].tex);
+            g_sprites[k][i].tex = NULL;
+            g_sprites[k][i].radius = 0;
+        }
+        g_next[k] = 0;
+    }
+    g_ren = NULL;
+}
@@ -0,0 +1,552 @@
+/*
+ * stats.c
+ * 累计战绩统计文件 liu/data/stats.bin 的读写（格式见 stats.h）。
+ */
+
+#include "stats.h"
+#include "fileio.h"
+#include "store.h"
+#include "dedup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static const char *STATS_FILE = "liu/data/stats.bin";
+static const char *STATS_TMP  = "liu/data/stats.bin.tmp";   // 整个重写时先写它，再原子替换
+static const char STATS_MAGIC[4] = {'S', 'I', 'X', 'S'};
+static const uint8_t STATS_VERSION = 1;
+
+#define HEADER_SIZE 8
+#define BUCKET_SIZE 48
+#define DAYS_OFFSET (HEADER_SIZE + STATS_MODES * BUCKET_SIZE)
+
+/* ========== 桶的编解码（小端，和机器无关） ========== */
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put64(uint8_t *p, uint64_t v)
+{
+    put32(p, (uint32_t)v);
+    put32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+    return (uint64_t)get32(p) | ((uint64_t)get32(p + 4) << 32);
+}
+
+static void encode_bucket(uint8_t *p, const StatDay *d)
+{
+    memset(p, 0, BUCKET_SIZE);
+    put32(p, (uint32_t)d->day);
+    put32(p + 4, (uint32_t)d->mode);
+    put32(p + 8, (uint32_t)d->t.games);
+    put32(p + 12, (uint32_t)d->t.black_wins);
+    put32(p + 16, (uint32_t)d->t.white_wins);
+    put32(p + 20, (uint32_t)d->t.draws);
+    put32(p + 24, (uint32_t)d->t.timed);
+    put64(p + 32, (uint64_t)d->t.total_moves);
+    put64(p + 40, (uint64_t)d->t.total_seconds);
+}
+
+static void decode_bucket(const uint8_t *p, StatDay *d)
+{
+    d->day = (int)get32(p);
+    d->mode = (int)get32(p + 4);
+    d->t.games = (int)get32(p + 8);
+    d->t.black_wins = (int)get32(p + 12);
+    d->t.white_wins = (int)get32(p + 16);
+    d->t.draws = (int)get32(p + 20);
+    d->t.timed = (int)get32(p + 24);
+    d->t.total_moves = (long long)get64(p + 32);
+    d->t.total_seconds = (long long)get64(p + 40);
+}
+
+/* 把一盘加进一组统计 */
+static void count_game(StatTotals *t, int winner, int moves, int seconds)
+{
+    t->games++;
+    if (winner == 1) t->black_wins++;
+    else if (winner == 2) t->white_wins++;
+    else t->draws++;
+    t->total_moves += moves;
+    if (seconds > 0) {
+        t->timed++;
+        t->total_seconds += seconds;
+    }
+}
+
+static void merge_totals(StatTotals *dst, const StatTotals *src)
+{
+    dst->games += src->games;
+    dst->black_wins += src->black_wins;
+    dst->white_wins += src->white_wins;
+    dst->draws += src->draws;
+    dst->timed += src->timed;
+    dst->total_moves += src->total_moves;
+    dst->total_seconds += src->total_seconds;
+}
+
+/* "YYYY-mm-dd ..." -> yyyymmdd；格式不对返回 0 */
+static int day_of(const char *timestr)
+{
+    int y, m, d;
+    if (!timestr || sscanf(timestr, "%4d-%2d-%2d", &y, &m, &d) != 3) return 0;
+    return y * 10000 + m * 100 + d;
+}
+
+static int clamp_mode(int mode)
+{
+    return (mode >= 0 && mode < STATS_MODES) ? mode : 0;
+}
+
+/* 读第 i 个桶（文件里的下标，累计桶是 0..STATS_MODES-1） */
+static int read_bucket(FILE *fp, long i, StatDay *d)
+{
+    uint8_t b[BUCKET_SIZE];
+    if (fseek(fp, HEADER_SIZE + i * BUCKET_SIZE, SEEK_SET) != 0) return 0;
+    if (fread(b, 1, BUCKET_SIZE, fp) != BUCKET_SIZE) return 0;
+    decode_bucket(b, d);
+    return 1;
+}
+
+static int write_bucket(FILE *fp, long i, const StatDay *d)
+{
+    uint8_t b[BUCKET_SIZE];
+    encode_bucket(b, d);
+    if (fseek(fp, HEADER_SIZE + i * BUCKET_SIZE, SEEK_SET) != 0) return 0;
+    return fwrite(b, 1, BUCKET_SIZE, fp) == BUCKET_SIZE;
+}
+
+/* 打开统计文件；不存在或文件头不对时新建一个空的（文件头 + 全 0 的累计桶） */
+static FILE *open_stats(void)
+{
+    FILE *fp = fopen(STATS_FILE, "r+b");
+    if (fp) {
+        uint8_t h[HEADER_SIZE];
+        if (fread(h, 1, HEADER_SIZE, fp) == HEADER_SIZE &&
+            memcmp(h, STATS_MAGIC, 4) == 0 && h[4] == STATS_VERSION) {
+            return fp;
+        }
+        fclose(fp);
+    }
+    fp = fopen(STATS_FILE, "w+b");
+    if (!fp) return NULL;
+    uint8_t h[HEADER_SIZE] = {0};
+    memcpy(h, STATS_MAGIC, 4);
+    h[4] = STATS_VERSION;
+    int ok = fwrite(h, 1, HEADER_SIZE, fp) == HEADER_SIZE;
+    for (int m = 0; ok && m < STATS_MODES; m++) {
+        StatDay d;
+        memset(&d, 0, sizeof(d));
+        d.mode = m;
+        ok = write_bucket(fp, m, &d);
+    }
+    if (!ok) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+/* 文件里一共有几个桶（含累计桶） */
+static long bucket_count(FILE *fp)
+{
+    if (fseek(fp, 0, SEEK_END) != 0) return 0;
+    long size = ftell(fp);
+    if (size < DAYS_OFFSET) return 0;
+    return (size - HEADER_SIZE) / BUCKET_SIZE;
+}
+
+/* ========== 记一盘 ========== */
+
+typedef struct {
+    int mode, day, winner, moves, seconds;
+} AddArgs;
+
+static int add_locked(void *arg)
+{
+    const AddArgs *a = (const AddArgs *)arg;
+    FILE *fp = open_stats();
+    if (!fp) return 0;
+
+    /* 累计桶：位置固定 */
+    StatDay d;
+    int ok = read_bucket(fp, a->mode, &d);
+    if (ok) {
+        count_game(&d.t, a->winner, a->moves, a->seconds);
+        ok = write_bucket(fp, a->mode, &d);
+    }
+
+    /* 按天的桶：当天的最多 STATS_MODES 个，都在末尾，往回找几个就够了 */
+    long n = bucket_count(fp);
+    long at = n;
+    for (long i = n - 1; ok && i >= STATS_MODES && i >= n - STATS_MODES; i--) {
+        StatDay e;
+        if (!read_bucket(fp, i, &e)) break;
+        if (e.day == a->day && e.mode == a->mode) {
+            d = e;
+            at = i;
+            break;
+        }
+        if (e.day < a->day) break;   // 更早的日子，后面不会有今天的了
+    }
+    if (ok) {
+        if (at == n) {
+            memset(&d, 0, sizeof(d));
+            d.day = a->day;
+            d.mode = a->mode;
+        }
+        count_game(&d.t, a->winner, a->moves, a->seconds);
+        ok = write_bucket(fp, at, &d);
+    }
+    if (fclose(fp) != 0) ok = 0;
+    return ok;
+}
+
+int stats_add(int mode, const char *timestr, int winner, int moves, int seconds)
+{
+    AddArgs a;
+    a.mode = clamp_mode(mode);
+    a.day = day_of(timestr);
+    a.winner = winner;
+    a.moves = moves;
+    a.seconds = seconds;
+    return store_locked(add_locked, &a);
+}
+
+/* ========== 读 ========== */
+
+typedef struct {
+    int mode;
+    StatTotals *out;
+} TotalsArgs;
+
+static int totals_locked(void *arg)
+{
+    TotalsArgs *a = (TotalsArgs *)arg;
+    FILE *fp = fopen(STATS_FILE, "rb");
+    if (!fp) return 1;    // 还没有统计文件：全是 0
+    uint8_t h[HEADER_SIZE];
+    int ok = fread(h, 1, HEADER_SIZE, fp) == HEADER_SIZE && memcmp(h, STATS_MAGIC, 4) == 0;
+    for (int m = 0; ok && m < STATS_MODES; m++) {
+        if (a->mode >= 0 && m != a->mode) continue;
+        StatDay d;
+        if (read_bucket(fp, m, &d)) merge_totals(a->out, &d.t);
+    }
+    fclose(fp);
+    return 1;
+}
+
+int stats_totals(int mode, StatTotals *out)
+{
+    if (!out) return 0;
+    memset(out, 0, sizeof(*out));
+    if (mode >= STATS_MODES) return 1;
+    TotalsArgs a;
+    a.mode = mode;
+    a.out = out;
+    return store_locked(totals_locked, &a);
+}
+
+typedef struct {
+    StatDay *days;
+    int count;
+} DaysArgs;
+
+static int days_locked(void *arg)
+{
+    DaysArgs *a = (DaysArgs *)arg;
+    FILE *fp = fopen(STATS_FILE, "rb");
+    if (!fp) return 1;
+    long n = bucket_count(fp) - STATS_MODES;
+    if (n <= 0) {
+        fclose(fp);
+        return 1;
+    }
+    a->days = (StatDay *)malloc((size_t)n * sizeof(StatDay));
+    if (!a->days) {
+        fclose(fp);
+        return 0;
+    }
+    for (long i = 0; i < n; i++) {
+        if (!read_bucket(fp, STATS_MODES + i, &a->days[a->count])) break;
+        a->count++;
+    }
+    fclose(fp);
+    return 1;
+}
+
+int stats_load_days(StatDay **out)
+{
+    if (!out) return -1;
+    DaysArgs a;
+    a.days = NULL;
+    a.count = 0;
+    if (!store_locked(days_locked, &a)) {
+        free(a.days);
+        *out = NULL;
+        return -1;
+    }
+    *out = a.days;
+    return a.count;
+}
+
+/* ========== 从存档重建 ========== */
+
+typedef struct {
+    StatDay totals[STATS_MODES];
+    StatDay *days;
+    int count, cap;
+} Rebuild;
+
+static int rebuild_add(Rebuild *r, const GameRecord *rec, int refs)
+{
+    int mode = clamp_mode(rec->mode);
+    int day = day_of(rec->time);
+    StatDay *d = NULL;
+    /* 存档基本按时间顺序，同一天的桶几乎总在最后几个里 */
+    for (int i = r->count - 1; i >= 0 && i >= r->count - STATS_MODES * 2; i--) {
+        if (r->days[i].day == day && r->days[i].mode == mode) {
+            d = &r->days[i];
+            break;
+        }
+    }
+    if (!d) {
+        if (r->count == r->cap) {
+            int ncap = r->cap ? r->cap * 2 : 64;
+            StatDay *p = (StatDay *)realloc(r->days, (size_t)ncap * sizeof(StatDay));
+            if (!p) return 0;
+            r->days = p;
+            r->cap = ncap;
+        }
+        d = &r->days[r->count++];
+        memset(d, 0, sizeof(*d));
+        d->day = day;
+        d->mode = mode;
+    }
+    for (int k = 0; k < refs; k++) {
+        count_game(&r->totals[mode].t, rec->game.winner, rec->game.moves_count, rec->dur);
+        count_game(&d->t, rec->game.winner, rec->game.moves_count, rec->dur);
+    }
+    return 1;
+}
+
+static int cmp_day(const void *a, const void *b)
+{
+    const StatDay *x = (const StatDay *)a;
+    const StatDay *y = (const StatDay *)b;
+    if (x->day != y->day) return x->day < y->day ? -1 : 1;
+    return x->mode - y->mode;
+}
+
+/* 整个重写统计文件（重建、批量导入）：写到临时文件再一步换掉，写到一半断电也不会丢掉累计战绩 */
+static int write_all_locked(void *arg)
+{
+    const Rebuild *r = (const Rebuild *)arg;
+    FILE *fp = fopen(STATS_TMP, "wb");
+    if (!fp) return 0;
+    uint8_t h[HEADER_SIZE] = {0};
+    memcpy(h, STATS_MAGIC, 4);
+    h[4] = STATS_VERSION;
+    int ok = fwrite(h, 1, HEADER_SIZE, fp) == HEADER_SIZE;
+    uint8_t b[BUCKET_SIZE];
+    for (int m = 0; ok && m < STATS_MODES; m++) {
+        encode_bucket(b, &r->totals[m]);
+        ok = fwrite(b, 1, BUCKET_SIZE, fp) == BUCKET_SIZE;
+    }
+    for (int i = 0; ok && i < r->count; i++) {
+        encode_bucket(b, &r->days[i]);
+        ok = fwrite(b, 1, BUCKET_SIZE, fp) == BUCKET_SIZE;
+    }
+    if (ok && !store_sync_file(fp)) ok = 0;
+    if (fclose(fp) != 0) ok = 0;
+    if (ok) ok = store_replace_file(STATS_TMP, STATS_FILE);
+    if (!ok) remove(STATS_TMP);
+    return ok;
+}
+
+/* 排序，顺序不严格时同一天可能分成了两个桶，排序后合并 */
+static void sort_days(Rebuild *r)
+{
+    qsort(r->days, (size_t)r->count, sizeof(StatDay), cmp_day);
+    int w = 0;
+    for (int i = 0; i < r->count; i++) {
+        if (w > 0 && r->days[w - 1].day == r->days[i].day && r->days[w - 1].mode == r->days[i].mode) {
+            merge_totals(&r->days[w - 1].t, &r->days[i].t);
+        } else {
+            r->days[w++] = r->days[i];
+        }
+    }
+    r->count = w;
+}
+
+int stats_rebuild(void)
+{
+    Rebuild r;
+    memset(&r, 0, sizeof(r));
+    for (int m = 0; m < STATS_MODES; m++) r.totals[m].mode = m;
+
+    /* 引用计数一次拷出来（一次加锁），不是每条记录都去锁一次、读一次 manifest */
+    DedupRef *refs = NULL;
+    int nrefs = store_refcount_snapshot(&refs);
+    if (nrefs < 0) return -1;
+
+    SegmentInfo *segs = NULL;
+    int nseg = store_snapshot(&segs);
+    if (nseg < 0) {
+        free(refs);
+        return -1;
+    }
+
+    int games = 0, ok = 1;
+    GameRecord rec;
+    for (int s = 0; ok && s < nseg; s++) {
+        size_t len = 0;
+        char *text = store_snapshot_text(&segs[s], &len);
+        if (!text) continue;
+        char *p = text, *end = text + len;
+        while (ok && p < end) {
+            char *nl = memchr(p, '\n', (size_t)(end - p));
+            size_t n = nl ? (size_t)(nl - p) : (size_t)(end - p);
+            if (n > 0) {
+                char saved = p[n];
+                p[n] = '\0';
+                if (record_from_json(p, &rec)) {
+                    /* 一盘棋按它的引用计数算、只算一次：老版本留下的重复行和去重后的那一行
+                     * 哈希相同，第一次碰到就把引用全算上并清零，后面同样的行不再算。
+                     * 没有 "h" 字段、或者哈希表里没有的，一行算一盘 */
+                    uint64_t hash = dedup_line_hash(p, n);
+                    DedupRef *e = hash ? dedup_find(refs, nrefs, hash) : NULL;
+                    int k = e ? e->refs : 1;
+                    if (e) e->refs = 0;
+                    if (k > 0) {
+                        ok = rebuild_add(&r, &rec, k);
+                        games += k;
+                    }
+                }
+                p[n] = saved;
+            }
+            p += n + 1;
+        }
+        free(text);
+    }
+    free(segs);
+    free(refs);
+
+    if (ok) {
+        sort_days(&r);
+        ok = store_locked(write_all_locked, &r);
+    }
+    free(r.days);
+    return ok ? games : -1;
+}
+
+/* ========== 批量导入 ========== */
+
+/* 把现有的统计文件整个读进 r（没有文件就是全 0） */
+static int load_all(Rebuild *r)
+{
+    FILE *fp = fopen(STATS_FILE, "rb");
+    if (!fp) return 1;
+    uint8_t h[HEADER_SIZE];
+    if (fread(h, 1, HEADER_SIZE, fp) != HEADER_SIZE || memcmp(h, STATS_MAGIC, 4) != 0 || h[4] != STATS_VERSION) {
+        fclose(fp);
+        return 1;   // 文件头不对：和 open_stats 一样当成空文件，从头记
+    }
+    int ok = 1;
+    for (int m = 0; ok && m < STATS_MODES; m++) ok = read_bucket(fp, m, &r->totals[m]);
+    long n = bucket_count(fp) - STATS_MODES;
+    if (ok && n > 0) {
+        r->days = (StatDay *)malloc((size_t)n * sizeof(StatDay));
+        if (!r->days) ok = 0;
+        r->cap = (int)n;
+        for (long i = 0; ok && i < n; i++) {
+            if (!read_bucket(fp, STATS_MODES + i, &r->days[r->count])) break;
+            r->count++;
+        }
+    }
+    fclose(fp);
+    return ok;
+}
+
+int stats_add_lines_locked(const char *lines, size_t len)
+{
+    Rebuild r;
+    memset(&r, 0, sizeof(r));
+    for (int m = 0; m < STATS_MODES; m++) r.totals[m].mode = m;
+    if (!load_all(&r)) {
+        free(r.days);
+        return 0;
+    }
+
+    /* 导入的记录日期不一定在最后，按天的桶不能像 stats_add 那样只往末尾追加：
+     * 整个读进来、加上这一批、排好序再整个写回（文件很小，一天一个模式才 48 字节） */
+    char *buf = NULL;
+    size_t cap = 0;
+    int ok = 1;
+    GameRecord rec;
+    for (size_t p = 0; ok && p < len; ) {
+        size_t q = p;
+        while (q < len && lines[q] != '\n') q++;
+        size_t n = q - p;
+        if (n > 0) {
+            if (n + 1 > cap) {
+                char *nb = (char *)realloc(buf, n + 1);
+                if (!nb) {
+                    ok = 0;
+                    break;
+                }
+                buf = nb;
+                cap = n + 1;
+            }
+            memcpy(buf, lines + p, n);
+            buf[n] = '\0';
+            if (record_from_json(buf, &rec)) ok = rebuild_add(&r, &rec, 1);
+        }
+        p = q + 1;
+    }
+    free(buf);
+
+    if (ok) {
+        sort_days(&r);
+        ok = write_all_locked(&r);
+    }
+    free(r.days);
+    return ok;
+}
+
+/* ========== 小工具 ========== */
+
+double stats_avg_moves(const StatTotals *t)
+{
+    return (t && t->games > 0) ? (double)t->total_moves / t->games : 0.0;
+}
+
+double stats_avg_seconds(const StatTotals *t)
+{
+    return (t && t->timed > 0) ? (double)t->total_seconds / t->timed : 0.0;
+}
+
+const char *stats_mode_name(int mode)
+{
+    switch (mode) {
+    case 1:  return "双人";
+    case 2:  return "人机-简单";
+    case 3:  return "人机-中级";
+    case 4:  return "人机-困难";
+    default: return "未知";
+    }
+}
@@ -0,0 +1,1089 @@
+/*
+ * store.c
+ *
+ * 分段记录存储的实现。
+ * manifest 很小（一段一行），每次操作时在锁里读一份；所有“按编号找记录”的操作
+ * 都先在 manifest 里定位到段，再只打开那一个段，这样耗时只和段大小有关，
+ * 跟历史记录总量无关。
+ */
+
+#include "store.h"
+#include "lzblock.h"
+#include "dedup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/* 文件路径 */
+static const char *DATA_DIR      = "liu/data";
+static const char *MANIFEST_FILE = "liu/data/manifest.json";
+static const char *MANIFEST_TMP  = "liu/data/manifest.tmp";
+/* 老版本的单文件记录：第一次打开时会被收编成 0 号段 */
+static const char *LEGACY_FILE   = "liu/data/records.json";
+/* 多进程互斥用的锁文件（内容无所谓，只用来加锁） */
+static const char *LOCK_FILE     = "liu/data/store.lock";
+
+/* manifest 的内存副本 */
+static SegmentInfo *g_segs = NULL;
+static int g_seg_count = 0;
+static int g_seg_cap = 0;
+
+/* 锁文件句柄：进程内只开一次，一直开着 */
+static int g_lock_fd = -1;
+
+/* 进程内的互斥：文件锁只管进程之间，同一进程的多个线程（比如回放列表的预取线程）
+ * 还要靠它排队，manifest 缓存 g_segs 也由它保护 */
+#ifdef _WIN32
+static SRWLOCK g_mutex = SRWLOCK_INIT;
+#else
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* 确保 data 目录存在（如果不存在则创建）；- stat() : 来自 <sys/stat.h>，检查文件或目录是否存在 */
+void store_ensure_dir(void)
+{
+    struct stat st;
+    // 先检查并创建 liu 目录
+    if (stat("liu", &st) != 0) {
+        #ifdef _WIN32
+        mkdir("liu");
+        #else
+        mkdir("liu", 0755);
+        #endif
+    }
+    // 再检查并创建 liu/data 目录
+    if (stat(DATA_DIR, &st) != 0) {
+        #ifdef _WIN32
+        mkdir("liu\\data");  // Windows 使用反斜杠，但也可以使用正斜杠
+        #else
+        mkdir(DATA_DIR, 0755);
+        #endif
+    }
+}
+
+/* ========== 多进程互斥 ==========
+ * 好几个对局/服务器进程可能同时往同一个目录写记录。
+ * 所有会读写 manifest 的操作都先拿 store.lock 上的排他锁（Windows 用 LockFileEx，
+ * 其他系统用 fcntl 记录锁），锁只在这一次操作期间持有，通常不到一毫秒。
+ * 拿不到锁（比如文件系统不支持）时照常执行，退化成以前的单进程行为。
+ * 进程内的互斥锁总是先拿；返回值只表示文件锁有没有拿到，要原样交给 unlock_store。
+ */
+static int lock_store(void)
+{
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&g_mutex);
+#else
+    pthread_mutex_lock(&g_mutex);
+#endif
+    if (g_lock_fd < 0) {
+        store_ensure_dir();
+        g_lock_fd = open(LOCK_FILE, O_RDWR | O_CREAT | O_BINARY, 0644);
+        if (g_lock_fd < 0) return 0;
+    }
+#ifdef _WIN32
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    HANDLE h = (HANDLE)_get_osfhandle(g_lock_fd);
+    return LockFileEx(h, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &ov) ? 1 : 0;
+#else
+    struct flock fl;
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = F_WRLCK;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = 0;
+    fl.l_len = 1;
+    while (fcntl(g_lock_fd, F_SETLKW, &fl) != 0) {
+        if (errno != EINTR) return 0;
+    }
+    return 1;
+#endif
+}
+
+static void unlock_store(int file_locked)
+{
+    if (file_locked && g_lock_fd >= 0) {
+#ifdef _WIN32
+        OVERLAPPED ov;
+        memset(&ov, 0, sizeof(ov));
+        HANDLE h = (HANDLE)_get_osfhandle(g_lock_fd);
+        UnlockFileEx(h, 0, 1, 0, &ov);
+#else
+        struct flock fl;
+        memset(&fl, 0, sizeof(fl));
+        fl.l_type = F_UNLCK;
+        fl.l_whence = SEEK_SET;
+        fl.l_start = 0;
+        fl.l_len = 1;
+        fcntl(g_lock_fd, F_SETLK, &fl);
+#endif
+    }
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&g_mutex);
+#else
+    pthread_mutex_unlock(&g_mutex);
+#endif
+}
+
+/* 段文件名：liu/data/seg_00012.json */
+static void seg_path(int id, char *buf, size_t cap)
+{
+    snprintf(buf, cap, "%s/seg_%05d.json", DATA_DIR, id);
+}
+
+/* 压缩归档文件名：liu/data/seg_00012.lzb */
+static void lzb_path(int id, char *buf, size_t cap)
+{
+    snprintf(buf, cap, "%s/seg_%05d.lzb", DATA_DIR, id);
+}
+
+/* 段索引文件名：liu/data/seg_00012.idx */
+static void idx_path(int id, char *buf, size_t cap)
+{
+    snprintf(buf, cap, "%s/seg_%05d.idx", DATA_DIR, id);
+}
+
+/* 从一行记录里抠出 "time":"..." 的值（抠不到就留空串） */
+static void line_time(const char *line, char *out)
+{
+    out[0] = '\0';
+    const char *t = strstr(line, "\"time\":\"");
+    if (!t) return;
+    t += 8;
+    int n = 0;
+    while (t[n] && t[n] != '"' && n < 19) {
+        out[n] = t[n];
+        n++;
+    }
+    out[n] = '\0';
+}
+
+/* 往 manifest 数组末尾加一个空段 */
+static SegmentInfo *push_segment(int id)
+{
+    if (g_seg_count >= g_seg_cap) {
+        int cap = g_seg_cap ? g_seg_cap * 2 : 8;
+        SegmentInfo *p = (SegmentInfo *)realloc(g_segs, (size_t)cap * sizeof(SegmentInfo));
+        if (!p) return NULL;
+        g_segs = p;
+        g_seg_cap = cap;
+    }
+    SegmentInfo *s = &g_segs[g_seg_count++];
+    memset(s, 0, sizeof(*s));
+    s->id = id;
+    return s;
+}
+
+int store_sync_file(FILE *fp)
+{
+    if (fflush(fp) != 0) return 0;
+#ifdef _WIN32
+    return _commit(_fileno(fp)) == 0;
+#else
+    return fsync(fileno(fp)) == 0;
+#endif
+}
+
+int store_replace_file(const char *tmp, const char *dst)
+{
+#ifdef _WIN32
+    if (!MoveFileExA(tmp, dst, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        fprintf(stderr, "MoveFileEx %s failed: %lu\n", dst, (unsigned long)GetLastError());
+        return 0;
+    }
+#else
+    if (rename(tmp, dst) != 0) {
+        perror(dst);
+        return 0;
+    }
+#endif
+    return 1;
+}
+
+/* 把 manifest 写回磁盘：先写临时文件、刷到盘上，再一步替换掉旧的，
+ * 任何时候断电磁盘上都有一份完整的 manifest */
+static int save_manifest(void)
+{
+    store_ensure_dir();
+    FILE *fp = fopen(MANIFEST_TMP, "w");
+    if (!fp) {
+        perror("fopen manifest.tmp");
+        return 0;
+    }
+    for (int i = 0; i < g_seg_count; i++) {
+        const SegmentInfo *s = &g_segs[i];
+        fprintf(fp, "{\"seg\":%d,\"count\":%d,\"bytes\":%ld,\"closed\":%d,\"z\":%d,\"first\":\"%s\",\"last\":\"%s\"}\n",
+                s->id, s->count, s->bytes, s->closed, s->compressed, s->first_time, s->last_time);
+    }
+    store_sync_file(fp);
+    fclose(fp);
+    return store_replace_file(MANIFEST_TMP, MANIFEST_FILE);
+}
+
+/* 扫一遍段文件，重新统计条数、字节数和时间范围（只在收编旧文件/重写段时用） */
+static void rescan_segment(SegmentInfo *s)
+{
+    char path[64];
+    seg_path(s->id, path, sizeof(path));
+
+    s->count = 0;
+    s->bytes = 0;
+    s->first_time[0] = '\0';
+    s->last_time[0] = '\0';
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return;
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    while ((read = getline(&line, &len, fp)) != -1) {
+        s->bytes += (long)read;
+        if (read <= 1) continue; /* 空行不算记录 */
+        s->count++;
+        char t[20];
+        line_time(line, t);
+        if (s->first_time[0] == '\0') strcpy(s->first_time, t);
+        strcpy(s->last_time, t);
+    }
+    if (line) free(line);
+    fclose(fp);
+}
+
+/* 给封存段生成行偏移索引：第 i 项 = 第 i 条记录在段文件里的字节偏移 */
+static int build_index(const SegmentInfo *s)
+{
+    char path[64], ipath[64];
+    seg_path(s->id, path, sizeof(path));
+    idx_path(s->id, ipath, sizeof(ipath));
+
+    FILE *in = fopen(path, "rb");
+    if (!in) return 0;
+    FILE *out = fopen(ipath, "wb");
+    if (!out) {
+        fclose(in);
+        return 0;
+    }
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    uint32_t off = 0;
+    while ((read = getline(&line, &len, in)) != -1) {
+        if (read > 1) {
+            fwrite(&off, sizeof(off), 1, out);
+        }
+        off += (uint32_t)read;
+    }
+    if (line) free(line);
+    fclose(in);
+    fclose(out);
+    return 1;
+}
+
+/* 把一份 manifest 文件读进 g_segs（追加在后面） */
+static void parse_manifest(FILE *fp)
+{
+    char *line = NULL;
+    size_t len = 0;
+    while (getline(&line, &len, fp) != -1) {
+        if (!strchr(line, '}')) continue;   // 写了一半的行（只可能出现在 manifest.tmp 里）
+        int id = 0;
+        const char *p = strstr(line, "\"seg\":");
+        if (!p || sscanf(p + 6, "%d", &id) != 1) continue;
+
+        SegmentInfo *s = push_segment(id);
+        if (!s) break;
+        p = strstr(line, "\"count\":");
+        if (p) sscanf(p + 8, "%d", &s->count);
+        p = strstr(line, "\"bytes\":");
+        if (p) sscanf(p + 8, "%ld", &s->bytes);
+        p = strstr(line, "\"closed\":");
+        if (p) sscanf(p + 9, "%d", &s->closed);
+        p = strstr(line, "\"z\":");
+        if (p) sscanf(p + 4, "%d", &s->compressed);
+        p = strstr(line, "\"first\":\"");
+        if (p) sscanf(p + 9, "%19[^\"]", s->first_time);
+        p = strstr(line, "\"last\":\"");
+        if (p) sscanf(p + 8, "%19[^\"]", s->last_time);
+    }
+    if (line) free(line);
+}
+
+/* 按压缩段解压出来的文本重新统计条数、字节数和时间范围（字节数记的是原始大小，和封存前一样） */
+static void rescan_text(SegmentInfo *s, const char *text, size_t n)
+{
+    s->count = 0;
+    s->bytes = (long)n;
+    s->first_time[0] = '\0';
+    s->last_time[0] = '\0';
+    for (size_t i = 0; i < n; ) {
+        size_t j = i;
+        while (j < n && text[j] != '\n') j++;
+        if (j - i > 0) {
+            s->count++;
+            char t[20];
+            line_time(text + i, t);
+            if (s->first_time[0] == '\0') strcpy(s->first_time, t);
+            strcpy(s->last_time, t);
+        }
+        i = j + 1;
+    }
+}
+
+/* 段号升序 */
+static int cmp_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* 把 data 目录里所有段文件（seg_*.json / seg_*.lzb）的编号收集起来，升序、去重。
+ * 返回 malloc 的数组，个数写到 *out_n */
+static int *list_segment_ids(int *out_n)
+{
+    *out_n = 0;
+    DIR *dir = opendir(DATA_DIR);
+    if (!dir) return NULL;
+    int *ids = NULL;
+    int n = 0, cap = 0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        int id = 0;
+        char ext[8] = {0};
+        if (sscanf(de->d_name, "seg_%d.%7s", &id, ext) != 2 || id < 0) continue;
+        if (strcmp(ext, "json") != 0 && strcmp(ext, "lzb") != 0) continue;
+        if (n >= cap) {
+            cap = cap ? cap * 2 : 16;
+            int *p = (int *)realloc(ids, (size_t)cap * sizeof(int));
+            if (!p) break;
+            ids = p;
+        }
+        ids[n++] = id;
+    }
+    closedir(dir);
+    if (n > 1) qsort(ids, (size_t)n, sizeof(int), cmp_int);
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (m == 0 || ids[m - 1] != ids[i]) ids[m++] = ids[i];
+    }
+    *out_n = m;
+    return ids;
+}
+
+/* manifest.json 没了（比如以前的版本在删旧文件和改名之间断了电）：
+ * 先看剩下的 manifest.tmp —— 它列的段和磁盘上的一个不差，就直接用它；
+ * 否则（没有、写了一半、和文件对不上）按段文件重新统计：
+ * 有 .lzb 的是压缩封存段；有 .idx 的明文段是封存段；最后一段明文段是活动段。
+ * 重建完马上写回 manifest.json。返回找到的段数 */
+static int rebuild_manifest(void)
+{
+    int n = 0;
+    int *ids = list_segment_ids(&n);
+    if (n == 0) {
+        free(ids);
+        remove(MANIFEST_TMP);
+        return 0;
+    }
+
+    FILE *fp = fopen(MANIFEST_TMP, "r");
+    if (fp) {
+        parse_manifest(fp);
+        fclose(fp);
+        int same = (g_seg_count == n);
+        for (int i = 0; same && i < n; i++) {
+            if (g_segs[i].id != ids[i]) same = 0;
+        }
+        if (same) {
+            free(ids);
+            save_manifest();
+            return g_seg_count;
+        }
+        g_seg_count = 0;
+    }
+
+    struct stat st;
+    char path[64];
+    for (int i = 0; i < n; i++) {
+        SegmentInfo *s = push_segment(ids[i]);
+        if (!s) break;
+        lzb_path(s->id, path, sizeof(path));
+        if (stat(path, &st) == 0) {
+            size_t len = 0;
+            char *text = lzb_read_all(path, &len);
+            if (text) {
+                rescan_text(s, text, len);
+                free(text);
+                s->closed = 1;
+                s->compressed = 1;
+                continue;
+            }
+            /* 归档坏了：还有明文就退回明文，没有就只好跳过（文件留着，不删） */
+            seg_path(s->id, path, sizeof(path));
+            if (stat(path, &st) != 0) {
+                fprintf(stderr, "警告：段 %d 的归档读不出来，重建 manifest 时跳过\n", s->id);
+                g_seg_count--;
+                continue;
+            }
+        }
+        rescan_segment(s);
+        idx_path(s->id, path, sizeof(path));
+        if (stat(path, &st) == 0) {
+            s->closed = 1;
+        } else if (i < n - 1) {
+            s->closed = build_index(s);   // 不是最后一段，肯定已经封存过了，索引补一份
+        }
+    }
+    free(ids);
+    fprintf(stderr, "manifest.json 不见了，已按 %d 个段文件重建\n", g_seg_count);
+    save_manifest();
+    return g_seg_count;
+}
+
+/* 读 manifest；manifest 没了就按段文件重建；一个段都没有但有老的 records.json 时，
+ * 把它收编成 0 号段。
+ * 每次操作都在锁里重读一遍（manifest 只有一段一行，很小），
+ * 这样别的进程刚追加/删除的条数马上就能看到，不会拿旧条数覆盖回去。 */
+static void load_manifest(void)
+{
+    g_seg_count = 0;
+
+    FILE *fp = fopen(MANIFEST_FILE, "r");
+    if (fp) {
+        parse_manifest(fp);
+        fclose(fp);
+        return;
+    }
+    if (rebuild_manifest() > 0) return;
+
+    /* 没有 manifest、也没有段文件：看看是不是老版本留下的单文件 */
+    struct stat st;
+    if (stat(LEGACY_FILE, &st) == 0 && st.st_size > 0) {
+        char path[64];
+        seg_path(0, path, sizeof(path));
+        if (rename(LEGACY_FILE, path) == 0) {
+            SegmentInfo *s = push_segment(0);
+            if (s) {
+                rescan_segment(s);
+                save_manifest();
+            }
+        }
+    }
+}
+
+/* 活动段（最后一段）；还没有任何段时新建 0 号段 */
+static SegmentInfo *active_segment(void)
+{
+    if (g_seg_count > 0 && !g_segs[g_seg_count - 1].closed) {
+        return &g_segs[g_seg_count - 1];
+    }
+    int id = (g_seg_count > 0) ? g_segs[g_seg_count - 1].id + 1 : 0;
+    return push_segment(id);
+}
+
+/* 封存活动段：优先压成块归档（冷存储），压缩失败就退回“明文 + 行偏移索引”；
+ * 标记 closed 之后，下一次追加会自动开新段 */
+static void close_segment(SegmentInfo *s)
+{
+    char path[64], zpath[64], ipath[64];
+    seg_path(s->id, path, sizeof(path));
+    lzb_path(s->id, zpath, sizeof(zpath));
+    idx_path(s->id, ipath, sizeof(ipath));
+
+    if (lzb_write_segment(path, zpath)) {
+        remove(path);
+        remove(ipath);
+        s->compressed = 1;
+        s->closed = 1;
+    } else if (build_index(s)) {
+        s->compressed = 0;
+        s->closed = 1;
+    }
+}
+
+/* 把整个段读成一段文本（压缩段会先解压），返回 malloc 的缓冲区 */
+static char *load_segment_text(const SegmentInfo *s, size_t *out_len)
+{
+    char path[64];
+    if (s->compressed) {
+        lzb_path(s->id, path, sizeof(path));
+        return lzb_read_all(path, out_len);
+    }
+
+    seg_path(s->id, path, sizeof(path));
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    fseek(fp, 0, SEEK_END);
+    long sz = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char *buf = (sz >= 0) ? (char *)malloc((size_t)sz + 1) : NULL;
+    if (!buf) {
+        fclose(fp);
+        return NULL;
+    }
+    size_t got = fread(buf, 1, (size_t)sz, fp);
+    fclose(fp);
+    buf[got] = '\0';
+    *out_len = got;
+    return buf;
+}
+
+/* 全局编号 -> (段下标, 段内编号)；找不到返回 0 */
+static int locate(int index, int *seg, int *local)
+{
+    if (index < 0) return 0;
+    for (int i = 0; i < g_seg_count; i++) {
+        if (index < g_segs[i].count) {
+            *seg = i;
+            *local = index;
+            return 1;
+        }
+        index -= g_segs[i].count;
+    }
+    return 0;
+}
+
+/* 把若干整行追加到段文件末尾。
+ * 记录都已经在内存里序列化好了，这里用 O_APPEND 一次 write 写完：
+ * 就算有不守规矩、没拿锁的写入者，也不会把两条记录搅成半行。 */
+static int write_to_segment(const SegmentInfo *s, const char *line, size_t len)
+{
+    char path[64];
+    seg_path(s->id, path, sizeof(path));
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_BINARY, 0644);
+    if (fd < 0) {
+        // 输出错误信息到控制台，方便调试
+        fprintf(stderr, "错误：无法打开文件 %s 进行写入\n", path);
+        perror("open segment");
+        return 0;
+    }
+    long wrote = (long)write(fd, line, (unsigned)len);
+    close(fd);
+    return wrote == (long)len;
+}
+
+/* 把哈希日志同步到最新。日志丢了（或者是从没有去重的版本升级上来）而存档不空时，
+ * 扫一遍所有段，把带 "h" 字段的记录重新登记一遍（每行算一次引用） */
+static void sync_hashes(void)
+{
+    if (dedup_sync()) return;
+
+    int total = 0;
+    for (int i = 0; i < g_seg_count; i++) total += g_segs[i].count;
+    dedup_reset(1);
+    if (total == 0) return;
+
+    for (int i = 0; i < g_seg_count; i++) {
+        size_t n = 0;
+        char *text = load_segment_text(&g_segs[i], &n);
+        if (!text) continue;
+        for (size_t p = 0; p < n; ) {
+            size_t q = p;
+            while (q < n && text[q] != '\n') q++;
+            uint64_t h = (q > p) ? dedup_line_hash(text + p, q - p) : 0;
+            if (h) dedup_add(h, 1);
+            p = q + 1;
+        }
+        free(text);
+    }
+}
+
+/* 追加一行到活动段；写满就封存（调用者已持有锁） */
+static int append_locked(const char *line, size_t len, const char *timestr)
+{
+    load_manifest();
+    sync_hashes();
+
+    /* 同一盘棋已经存过：只记一次引用，不新增一行 */
+    uint64_t h = dedup_line_hash(line, len);
+    if (h && dedup_refs(h) > 0) return dedup_add(h, 1);
+
+    SegmentInfo *s = active_segment();
+    if (!s) return 0;
+    if (!write_to_segment(s, line, len)) return 0;
+
+    s->count++;
+    s->bytes += (long)len;
+    if (timestr) {
+        if (s->first_time[0] == '\0') snprintf(s->first_time, sizeof(s->first_time), "%s", timestr);
+        snprintf(s->last_time, sizeof(s->last_time), "%s", timestr);
+    }
+    if (h) dedup_add(h, 1);
+
+    if (s->count >= SEGMENT_MAX_RECORDS || s->bytes >= SEGMENT_MAX_BYTES) {
+        close_segment(s);
+    }
+    return save_manifest();
+}
+
+/* 批量追加：一次拿锁、按段切开、每段一次 write，最后只写一次 manifest（导入工具用） */
+/* 一批里出现过的哈希（开放寻址，0 表示空位）：同一批里重复的棋只写第一行 */
+typedef struct {
+    uint64_t *keys;
+    size_t    mask;
+} HashSet;
+
+static int hashset_init(HashSet *hs, size_t items)
+{
+    size_t cap = 16;
+    while (cap < items * 2) cap <<= 1;
+    hs->keys = (uint64_t *)calloc(cap, sizeof(uint64_t));
+    hs->mask = cap - 1;
+    return hs->keys != NULL;
+}
+
+/* 加进集合；原来没有返回 1，已经有了返回 0 */
+static int hashset_add(HashSet *hs, uint64_t h)
+{
+    size_t i = (size_t)(h ^ (h >> 29)) & hs->mask;
+    while (hs->keys[i] != 0) {
+        if (hs->keys[i] == h) return 0;
+        i = (i + 1) & hs->mask;
+    }
+    hs->keys[i] = h;
+    return 1;
+}
+
+/* 给 lines[0..n) 里每一行带的哈希加一次引用（这些行已经写进段文件了） */
+static void add_line_refs(const char *lines, size_t n)
+{
+    for (size_t p = 0; p < n; ) {
+        size_t q = p;
+        while (q < n && lines[q] != '\n') q++;
+        size_t len = (q < n ? q + 1 : q) - p;
+        uint64_t h = dedup_line_hash(lines + p, len);
+        if (h) dedup_add(h, 1);
+        p += len;
+    }
+}
+
+/* 批量追加（调用者已持有锁）。和 append_locked 一样，新棋的引用要等它那一行真的写进段文件
+ * 以后才记：先记引用再写，写失败（磁盘满）时哈希日志里已经有它了，以后再存同样的棋会被当成
+ * 重复丢掉，这盘棋就再也存不进来了 */
+static int append_batch_locked(const char *all, size_t total)
+{
+    load_manifest();
+    sync_hashes();
+
+    /* 先去重：存档里已有的只加引用；同一批里前面出现过的，等全部写完再加引用；
+     * 剩下的拼成新的一批 */
+    size_t nlines = 0;
+    for (size_t p = 0; p < total; p++) {
+        if (all[p] == '\n') nlines++;
+    }
+    char *lines = (char *)malloc(total ? total : 1);
+    uint64_t *later = (uint64_t *)malloc((nlines + 1) * sizeof(uint64_t));
+    HashSet seen;
+    seen.keys = NULL;
+    if (!lines || !later || !hashset_init(&seen, nlines + 1)) {
+        free(lines);
+        free(later);
+        free(seen.keys);
+        return 0;
+    }
+    size_t n = 0, nlater = 0;
+    for (size_t p = 0; p < total; ) {
+        size_t q = p;
+        while (q < total && all[q] != '\n') q++;
+        size_t len = (q < total ? q + 1 : q) - p;
+        uint64_t h = dedup_line_hash(all + p, len);
+        if (h && dedup_refs(h) > 0) {
+            dedup_add(h, 1);            // 存档里本来就有这盘棋
+        } else if (h && !hashset_add(&seen, h)) {
+            later[nlater++] = h;        // 这一批前面已经有一样的一行
+        } else {
+            memcpy(lines + n, all + p, len);
+            n += len;
+        }
+        p += len;
+    }
+    free(seen.keys);
+
+    int ok = 1;
+    size_t i = 0;
+    while (ok && i < n) {
+        SegmentInfo *s = active_segment();
+        if (!s) {
+            ok = 0;
+            break;
+        }
+
+        /* 先量出这一段能放下多少行，写成功了才把条数、时间、引用记上 */
+        size_t start = i;
+        int count = s->count;
+        long bytes = s->bytes;
+        while (i < n && count < SEGMENT_MAX_RECORDS && bytes < SEGMENT_MAX_BYTES) {
+            size_t j = i;
+            while (j < n && lines[j] != '\n') j++;
+            size_t len = (j < n ? j + 1 : j) - i;
+            if (len > 1) count++;
+            bytes += (long)len;
+            i += len;
+        }
+        if (i > start && !write_to_segment(s, lines + start, i - start)) {
+            ok = 0;
+            break;
+        }
+        for (size_t k = start; k < i; ) {
+            size_t j = k;
+            while (j < i && lines[j] != '\n') j++;
+            if (j > k) {
+                char t[20];
+                line_time(lines + k, t);
+                if (s->first_time[0] == '\0') strcpy(s->first_time, t);
+                strcpy(s->last_time, t);
+            }
+            k = j + 1;
+        }
+        s->count = count;
+        s->bytes = bytes;
+        add_line_refs(lines + start, i - start);
+
+        if (s->count >= SEGMENT_MAX_RECORDS || s->bytes >= SEGMENT_MAX_BYTES) {
+            close_segment(s);
+        }
+    }
+    if (ok) {
+        for (size_t k = 0; k < nlater; k++) dedup_add(later[k], 1);
+    }
+    free(lines);
+    free(later);
+    /* 写失败时前面已经写进去的段也要记进 manifest，不然条数和文件对不上 */
+    if (!save_manifest()) ok = 0;
+    return ok;
+}
+
+/* 记录总数 = 各段条数之和 */
+static int count_locked(void)
+{
+    load_manifest();
+    int total = 0;
+    for (int i = 0; i < g_seg_count; i++) {
+        total += g_segs[i].count;
+    }
+    return total;
+}
+
+/* 读第 index 条：压缩段只解压一个块；明文封存段查 .idx 直接 fseek；
+ * 活动段顺序数行（活动段有大小上限）。调用前 manifest 要已经读好 */
+static char *read_at(int index)
+{
+    int si, local;
+    if (!locate(index, &si, &local)) return NULL;
+    const SegmentInfo *s = &g_segs[si];
+
+    char path[64];
+    if (s->compressed) {
+        lzb_path(s->id, path, sizeof(path));
+        return lzb_read_record(path, local);
+    }
+
+    seg_path(s->id, path, sizeof(path));
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    int found = 0;
+
+    uint32_t off = 0;
+    int have_off = 0;
+    if (s->closed) {
+        char ipath[64];
+        idx_path(s->id, ipath, sizeof(ipath));
+        FILE *ip = fopen(ipath, "rb");
+        if (ip) {
+            if (fseek(ip, (long)local * (long)sizeof(uint32_t), SEEK_SET) == 0 &&
+                fread(&off, sizeof(off), 1, ip) == 1) {
+                have_off = 1;
+            }
+            fclose(ip);
+        }
+    }
+
+    if (have_off) {
+        if (fseek(fp, (long)off, SEEK_SET) == 0 && getline(&line, &len, fp) != -1) {
+            found = 1;
+        }
+    } else {
+        /* 没索引（活动段或索引丢了）：逐行数过去 */
+        int cur = 0;
+        while ((read = getline(&line, &len, fp)) != -1) {
+            if (read <= 1) continue;
+            if (cur == local) {
+                found = 1;
+                break;
+            }
+            cur++;
+        }
+    }
+    fclose(fp);
+
+    if (!found) {
+        if (line) free(line);
+        return NULL;
+    }
+    return line;
+}
+
+static char *read_locked(int index)
+{
+    load_manifest();
+    return read_at(index);
+}
+
+/* 连续读 n 条：manifest 只读一次，锁也只拿一次 */
+static int read_range_locked(int first, int n, char **out)
+{
+    load_manifest();
+    int got = 0;
+    for (int i = 0; i < n; i++) {
+        out[i] = read_at(first + i);
+        if (out[i]) got++;
+    }
+    return got;
+}
+
+/* 删除第 index 条：只重写所在段（压缩段先解压成明文，删完再重新封存）；
+ * 段删空了（且不是活动段）就连文件带 manifest 项一起去掉 */
+static int delete_locked(int index)
+{
+    load_manifest();
+    int si, local;
+    if (!locate(index, &si, &local)) return 0;
+    SegmentInfo *s = &g_segs[si];
+
+    size_t n = 0;
+    char *text = load_segment_text(s, &n);
+    if (!text) return 0;
+
+    /* 临时文件放在同目录，避免跨盘 rename 的坑 */
+    const char *tmp = "liu/data/segment.tmp";
+    FILE *out = fopen(tmp, "wb");
+    if (!out) {
+        free(text);
+        return 0;
+    }
+
+    int cur = 0;
+    int removed = 0;
+    uint64_t removed_hash = 0;
+    for (size_t i = 0; i < n; ) {
+        size_t j = i;
+        while (j < n && text[j] != '\n') j++;
+        size_t len = (j < n ? j + 1 : j) - i;
+        if (len > 1) {
+            if (cur == local) {
+                removed = 1;
+                removed_hash = dedup_line_hash(text + i, len);
+            } else {
+                fwrite(text + i, 1, len, out);
+            }
+            cur++;
+        }
+        i += len;
+    }
+    free(text);
+    /* 先刷到盘上再替换：写坏了（磁盘满）就不动原来的段 */
+    int written = store_sync_file(out);
+    if (fclose(out) != 0) written = 0;
+
+    if (!removed || !written) {
+        remove(tmp);
+        return 0;
+    }
+
+    char path[64], zpath[64], ipath[64];
+    seg_path(s->id, path, sizeof(path));
+    lzb_path(s->id, zpath, sizeof(zpath));
+    idx_path(s->id, ipath, sizeof(ipath));
+    /* 一步替换（不能先删旧的再改名：中间断电整个段就没了）；段原来是压缩的也没关系，
+     * 替换完之前 manifest 还标着 z=1，读的仍是旧归档 */
+    if (!store_replace_file(tmp, path)) {
+        remove(tmp);
+        return 0;
+    }
+    /* 现在段是明文了，旧的归档/索引都作废 */
+    remove(zpath);
+    remove(ipath);
+    s->compressed = 0;
+
+    /* 这盘棋从存档里没了，引用全部清掉，以后再存同样的棋会重新写一行 */
+    if (removed_hash) {
+        sync_hashes();
+        dedup_add(removed_hash, -dedup_refs(removed_hash));
+    }
+
+    rescan_segment(s);
+    if (s->count == 0 && s->closed) {
+        remove(path);
+        memmove(&g_segs[si], &g_segs[si + 1], (size_t)(g_seg_count - si - 1) * sizeof(SegmentInfo));
+        g_seg_count--;
+    } else if (s->closed) {
+        close_segment(s);
+    }
+    return save_manifest();
+}
+
+/* 清空：段文件、索引、manifest 全删 */
+static int clear_locked(void)
+{
+    load_manifest();
+    char path[64];
+    for (int i = 0; i < g_seg_count; i++) {
+        seg_path(g_segs[i].id, path, sizeof(path));
+        remove(path);
+        idx_path(g_segs[i].id, path, sizeof(path));
+        remove(path);
+        lzb_path(g_segs[i].id, path, sizeof(path));
+        remove(path);
+    }
+    g_seg_count = 0;
+    remove(LEGACY_FILE);
+    dedup_reset(0);
+    return save_manifest();
+}
+
+/* ========== 对外接口：每个操作都在锁里完成 ========== */
+
+int store_append_line(const char *line, size_t len, const char *timestr)
+{
+    if (!line || len == 0) return 0;
+    store_ensure_dir();
+    int locked = lock_store();
+    int ok = append_locked(line, len, timestr);
+    unlock_store(locked);
+    return ok;
+}
+
+int store_append_batch(const char *lines, size_t len, int (*then)(void *), void *arg)
+{
+    if (!lines || len == 0) return 1;
+    store_ensure_dir();
+    int locked = lock_store();
+    int ok = append_batch_locked(lines, len);
+    if (ok && then) ok = then(arg);
+    unlock_store(locked);
+    return ok;
+}
+
+int store_count(void)
+{
+    int locked = lock_store();
+    int n = count_locked();
+    unlock_store(locked);
+    return n;
+}
+
+char *store_read_line(int index)
+{
+    int locked = lock_store();
+    char *line = read_locked(index);
+    unlock_store(locked);
+    return line;
+}
+
+int store_read_lines(int first, int n, char **out)
+{
+    if (!out || n <= 0) return 0;
+    int locked = lock_store();
+    int got = read_range_locked(first, n, out);
+    unlock_store(locked);
+    return got;
+}
+
+int store_refcount_snapshot(DedupRef **out)
+{
+    if (!out) return -1;
+    int locked = lock_store();
+    load_manifest();
+    sync_hashes();
+    int n = dedup_export(out);
+    unlock_store(locked);
+    return n;
+}
+
+int store_delete(int index)
+{
+    int locked = lock_store();
+    int ok = delete_locked(index);
+    unlock_store(locked);
+    return ok;
+}
+
+int store_clear(void)
+{
+    store_ensure_dir();
+    int locked = lock_store();
+    int ok = clear_locked();
+    unlock_store(locked);
+    return ok;
+}
+
+int store_locked(int (*fn)(void *), void *arg)
+{
+    if (!fn) return 0;
+    store_ensure_dir();
+    int locked = lock_store();
+    int ok = fn(arg);
+    unlock_store(locked);
+    return ok;
+}
+
+int store_segment_count(void)
+{
+    int locked = lock_store();
+    load_manifest();
+    int n = g_seg_count;
+    unlock_store(locked);
+    return n;
+}
+
+char *store_segment_text(int i, size_t *out_len)
+{
+    int locked = lock_store();
+    load_manifest();
+    char *text = NULL;
+    if (i >= 0 && i < g_seg_count) {
+        text = load_segment_text(&g_segs[i], out_len);
+    }
+    unlock_store(locked);
+    return text;
+}
+
+int store_snapshot(SegmentInfo **out)
+{
+    int locked = lock_store();
+    load_manifest();
+    int n = g_seg_count;
+    *out = (SegmentInfo *)malloc(sizeof(SegmentInfo) * (size_t)(n > 0 ? n : 1));
+    if (*out) {
+        if (n > 0) memcpy(*out, g_segs, sizeof(SegmentInfo) * (size_t)n);
+    } else {
+        n = -1;
+    }
+    unlock_store(locked);
+    return n;
+}
+
+char *store_snapshot_text(const SegmentInfo *s, size_t *out_len)
+{
+    if (!s || !out_len) return NULL;
+    return load_segment_text(s, out_len);
+}
@@ -0,0 +1,169 @@
+/*
+ * textcache.c
+ * 文字纹理缓存：固定槽位 + LRU（和 playlist.c 的页缓存一个思路），外加字节预算。
+ * 只在绘制线程里用，不加锁。
+ */
+
+#include "textcache.h"
+#include "perf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    SDL_Texture *tex;          // NULL = 空位
+    TTF_Font    *font;
+    int          size;
+    Uint32       color;        // RGBA 打包，比较方便
+    Uint32       hash;         // 字符串的哈希，先比它再比字符串
+    char        *text;
+    int          w, h;
+    size_t       bytes;
+    unsigned     last_used;
+} TextSlot;
+
+static TextSlot      g_slots[TEXTCACHE_SLOTS];
+static SDL_Renderer *g_ren = NULL;       // 缓存里的纹理都属于这个 renderer
+static size_t        g_bytes = 0;
+static unsigned      g_tick = 0;
+static unsigned      g_hits = 0;
+static unsigned      g_misses = 0;
+static SDL_Texture  *g_oversize = NULL;  // 放不进缓存的那一个，下次再有放不进的时候销毁
+
+/* FNV-1a */
+static Uint32 text_hash(const char *s)
+{
+    Uint32 h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static Uint32 pack_color(SDL_Color c)
+{
+    return ((Uint32)c.r << 24) | ((Uint32)c.g << 16) | ((Uint32)c.b << 8) | (Uint32)c.a;
+}
+
+static void drop_slot(TextSlot *s)
+{
+    if (!s->tex) return;
+    SDL_DestroyTexture(s->tex);
+    free(s->text);
+    g_bytes -= s->bytes;
+    memset(s, 0, sizeof(*s));
+}
+
+/* 淘汰最久没用的一条，没有可淘汰的返回 0 */
+static int evict_one(void)
+{
+    TextSlot *victim = NULL;
+    for (int i = 0; i < TEXTCACHE_SLOTS; i++) {
+        if (!g_slots[i].tex) continue;
+        if (!victim || g_slots[i].last_used < victim->last_used) victim = &g_slots[i];
+    }
+    if (!victim) return 0;
+    drop_slot(victim);
+    return 1;
+}
+
+/* 找一个空位；满了就按 LRU 腾一个 */
+static TextSlot *free_slot(void)
+{
+    for (int i = 0; i < TEXTCACHE_SLOTS; i++) {
+        if (!g_slots[i].tex) return &g_slots[i];
+    }
+    if (!evict_one()) return NULL;
+    return free_slot();
+}
+
+SDL_Texture *textcache_get(SDL_Renderer *ren, TTF_Font *font, int size,
+                           const char *utf8, SDL_Color color, int *w, int *h)
+{
+    if (!ren || !font || !utf8 || !utf8[0]) return NULL;
+    if (ren != g_ren) {
+        /* 换了 renderer：旧纹理不能再用 */
+        textcache_clear();
+        g_ren = ren;
+    }
+
+    Uint32 hash = text_hash(utf8);
+    Uint32 col = pack_color(color);
+    for (int i = 0; i < TEXTCACHE_SLOTS; i++) {
+        TextSlot *s = &g_slots[i];
+        if (s->tex && s->hash == hash && s->font == font && s->size == size &&
+            s->color == col && strcmp(s->text, utf8) == 0) {
+            s->last_used = ++g_tick;
+            g_hits++;
+            if (w) *w = s->w;
+            if (h) *h = s->h;
+            return s->tex;
+        }
+    }
+
+    g_misses++;
+    SDL_Surface *surf = TTF_RenderUTF8_Blended(font, utf8, color);
+    if (!surf) {
+        fprintf(stderr, "TTF_RenderUTF8_Blended error: %s\n", TTF_GetError());
+        return NULL;
+    }
+    SDL_Texture *tex = SDL_CreateTextureFromSurface(ren, surf);
+    int tw = surf->w, th = surf->h;
+    SDL_FreeSurface(surf);
+    if (!tex) return NULL;
+    perf_count_upload();
+
+    size_t bytes = (size_t)tw * (size_t)th * 4;
+    /* 比整个预算还大的先判掉：不然会先把缓存里的东西全淘汰光，最后还是放不进去 */
+    TextSlot *s = NULL;
+    char *copy = NULL;
+    if (bytes <= TEXTCACHE_BUDGET) {
+        while (g_bytes + bytes > TEXTCACHE_BUDGET && evict_one()) {
+        }
+        s = free_slot();
+        copy = (char *)malloc(strlen(utf8) + 1);
+    }
+    if (!s || !copy) {
+        /* 放不进缓存（单个纹理比预算还大等）：这一次照样返回，交给下一次调用时销毁 */
+        free(copy);
+        if (g_oversize) SDL_DestroyTexture(g_oversize);
+        g_oversize = tex;
+        if (w) *w = tw;
+        if (h) *h = th;
+        return tex;
+    }
+    strcpy(copy, utf8);
+    s->tex = tex;
+    s->font = font;
+    s->size = size;
+    s->color = col;
+    s->hash = hash;
+    s->text = copy;
+    s->w = tw;
+    s->h = th;
+    s->bytes = bytes;
+    s->last_used = ++g_tick;
+    g_bytes += bytes;
+    if (w) *w = tw;
+    if (h) *h = th;
+    return tex;
+}
+
+void textcache_clear(void)
+{
+    for (int i = 0; i < TEXTCACHE_SLOTS; i++) drop_slot(&g_slots[i]);
+    if (g_oversize) {
+        SDL_DestroyTexture(g_oversize);
+        g_oversize = NULL;
+    }
+    g_bytes = 0;
+    g_ren = NULL;
+}
+
+void textcache_stats(unsigned *hits, unsigned *misses, size_t *bytes)
+{
+    if (hits) *hits = g_hits;
+    if (misses) *misses = g_misses;
+    if (bytes) *bytes = g_bytes;
+}